@@ -0,0 +1,161 @@
+/**
+  ******************************************************************************
+  * @file    lora_rs.c
+  * @author  LoRaPlat Team
+  * @brief   Reed-Solomon 编解码实现
+  *          解码：校验子 -> Berlekamp-Massey -> Chien 搜索 -> Forney 求错误值。
+  ******************************************************************************
+  */
+
+#include "lora_rs.h"
+#include <string.h>
+
+#define RS_PRIM_POLY    0x1D    // x^8 + x^4 + x^3 + x^2 + 1 (去掉 x^8)
+#define RS_ALPHA        0x02
+
+// ============================================================
+//                    1. GF(256) 运算
+// ============================================================
+
+static uint8_t _GF_Mul(uint8_t a, uint8_t b) {
+    uint8_t r = 0;
+    while (b) {
+        if (b & 1) r ^= a;
+        a = (a & 0x80) ? (uint8_t)((a << 1) ^ RS_PRIM_POLY) : (uint8_t)(a << 1);
+        b >>= 1;
+    }
+    return r;
+}
+
+static uint8_t _GF_Pow(uint8_t a, uint16_t e) {
+    uint8_t r = 1;
+    while (e) {
+        if (e & 1) r = _GF_Mul(r, a);
+        a = _GF_Mul(a, a);
+        e >>= 1;
+    }
+    return r;
+}
+
+// a^254 = a^-1 (a != 0)
+static uint8_t _GF_Inv(uint8_t a) {
+    return _GF_Pow(a, 254);
+}
+
+// Horner 法求多项式值 (p[0] 为最高次项)
+static uint8_t _GF_PolyEvalHi(const uint8_t *p, uint8_t len, uint8_t x) {
+    uint8_t y = 0;
+    for (uint8_t i = 0; i < len; i++) y = _GF_Mul(y, x) ^ p[i];
+    return y;
+}
+
+// 求多项式值 (p[0] 为常数项)
+static uint8_t _GF_PolyEvalLo(const uint8_t *p, uint8_t len, uint8_t x) {
+    uint8_t y = 0;
+    for (uint8_t i = len; i-- > 0; ) y = _GF_Mul(y, x) ^ p[i];
+    return y;
+}
+
+// ============================================================
+//                    2. 编码
+// ============================================================
+
+void LoRa_RS_Encode(const uint8_t *data, uint8_t k, uint8_t *parity, uint8_t nparity) {
+    uint8_t gen[LORA_RS_MAX_PARITY + 1];
+
+    // g(x) = (x - a^0)(x - a^1)...(x - a^(nparity-1))，gen[0] 为最高次项 (恒为 1)
+    memset(gen, 0, sizeof(gen));
+    gen[0] = 1;
+    for (uint8_t i = 0; i < nparity; i++) {
+        uint8_t root = _GF_Pow(RS_ALPHA, i);
+        for (uint8_t j = i + 1; j > 0; j--) gen[j] ^= _GF_Mul(gen[j - 1], root);
+    }
+
+    // 余式 = data(x) * x^nparity mod g(x) (移位寄存器除法)
+    memset(parity, 0, nparity);
+    for (uint8_t i = 0; i < k; i++) {
+        uint8_t fb = data[i] ^ parity[0];
+        memmove(parity, parity + 1, nparity - 1);
+        parity[nparity - 1] = 0;
+        if (fb) {
+            for (uint8_t j = 0; j < nparity; j++) parity[j] ^= _GF_Mul(gen[j + 1], fb);
+        }
+    }
+}
+
+// ============================================================
+//                    3. 解码
+// ============================================================
+
+int LoRa_RS_Decode(uint8_t *cw, uint8_t n, uint8_t nparity) {
+    uint8_t synd[LORA_RS_MAX_PARITY];
+    uint8_t lambda[LORA_RS_MAX_PARITY + 1], prev[LORA_RS_MAX_PARITY + 1], tmp[LORA_RS_MAX_PARITY + 1];
+    uint8_t omega[LORA_RS_MAX_PARITY];
+    uint8_t pos[LORA_RS_MAX_PARITY / 2], val[LORA_RS_MAX_PARITY / 2];
+    uint8_t nerr = 0;
+    uint8_t any = 0;
+
+    if (nparity == 0 || nparity > LORA_RS_MAX_PARITY || n <= nparity) return -1;
+
+    // 1. 校验子 S_j = cw(a^j)
+    for (uint8_t j = 0; j < nparity; j++) {
+        synd[j] = _GF_PolyEvalHi(cw, n, _GF_Pow(RS_ALPHA, j));
+        any |= synd[j];
+    }
+    if (!any) return 0;
+
+    // 2. Berlekamp-Massey 求错误定位多项式 lambda(x) (lambda[0] 为常数项)
+    memset(lambda, 0, sizeof(lambda));
+    memset(prev, 0, sizeof(prev));
+    lambda[0] = prev[0] = 1;
+    uint8_t L = 0, m = 1, b = 1;
+    for (uint8_t r = 0; r < nparity; r++) {
+        uint8_t d = synd[r];
+        for (uint8_t i = 1; i <= L; i++) d ^= _GF_Mul(lambda[i], synd[r - i]);
+        if (d == 0) {
+            m++;
+            continue;
+        }
+        uint8_t coef = _GF_Mul(d, _GF_Inv(b));
+        memcpy(tmp, lambda, sizeof(tmp));
+        for (uint8_t i = m; i <= nparity; i++) lambda[i] ^= _GF_Mul(coef, prev[i - m]);
+        if (2 * L <= r) {
+            L = r + 1 - L;
+            memcpy(prev, tmp, sizeof(prev));
+            b = d;
+            m = 1;
+        } else {
+            m++;
+        }
+    }
+    if (L == 0 || L > nparity / 2) return -1;
+
+    // 3. Chien 搜索：位置 p 对应 X = a^(n-1-p)，根为 X^-1
+    for (uint8_t p = 0; p < n; p++) {
+        uint8_t x_inv = _GF_Pow(RS_ALPHA, (uint16_t)(255 - (n - 1 - p)) % 255);
+        if (_GF_PolyEvalLo(lambda, L + 1, x_inv) == 0) {
+            if (nerr >= L) return -1;
+            pos[nerr++] = p;
+        }
+    }
+    if (nerr != L) return -1;
+
+    // 4. Forney：omega(x) = S(x) * lambda(x) mod x^nparity，Y = X * omega(X^-1) / lambda'(X^-1)
+    for (uint8_t i = 0; i < nparity; i++) {
+        uint8_t o = 0;
+        for (uint8_t j = 0; j <= i && j <= L; j++) o ^= _GF_Mul(lambda[j], synd[i - j]);
+        omega[i] = o;
+    }
+    for (uint8_t e = 0; e < nerr; e++) {
+        uint8_t x     = _GF_Pow(RS_ALPHA, (uint16_t)(n - 1 - pos[e]));
+        uint8_t x_inv = _GF_Inv(x);
+        uint8_t deriv = 0;
+        // 特征 2 下导数只保留奇次项：lambda'(x) = sum lambda[2i+1] x^(2i)
+        for (uint8_t i = 1; i <= L; i += 2) deriv ^= _GF_Mul(lambda[i], _GF_Pow(x_inv, i - 1));
+        if (deriv == 0) return -1;
+        val[e] = _GF_Mul(_GF_Mul(x, _GF_PolyEvalLo(omega, nparity, x_inv)), _GF_Inv(deriv));
+    }
+
+    for (uint8_t e = 0; e < nerr; e++) cw[pos[e]] ^= val[e];
+    return nerr;
+}
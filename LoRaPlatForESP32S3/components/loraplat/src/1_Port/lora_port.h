@@ -50,6 +50,14 @@ void LoRa_Port_SetRST(bool level);
  */
 bool LoRa_Port_GetAUX(void);
 
+/**
+ * @brief  [新增] 获取最近一次 AUX 下降沿 (忙 -> 闲) 的时刻
+ * @return OSAL Tick (ms)。有 AUX 边沿中断的平台在中断中记录；
+ *         否则在调用时轮询电平检测 (精度取决于调用周期)。从未出现过下降沿时返回 0。
+ * @note   协议栈据此得到帧真正发射完毕 / 接收输出完毕的时刻，用于收发切换计时。
+ */
+uint32_t LoRa_Port_GetAuxIdleTick(void);
+
 // ============================================================
 //                    3. 发送接口 (TX)
 // ============================================================
@@ -66,21 +74,69 @@ bool LoRa_Port_IsTxBusy(void);
  * @param  len:  数据长度
  * @return 实际发送长度 (0表示硬件忙，发送失败)
  * @note   内部具有原子性保护，防止覆写缓冲区
+ *         [变更] 等价于 AcquireTxBuffer + 复制 + CommitTx
  */
 uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len);
 
+/**
+ * @brief  [新增] 借出发送 DMA 缓冲区 (零拷贝发送)
+ * @param  capacity: 输出缓冲区可写入的最大长度
+ * @return 缓冲区指针 (NULL=硬件忙或缓冲区已借出)
+ * @note   调用方直接把帧写入该缓冲区，再调用 LoRa_Port_CommitTx 启动发送；
+ *         借出期间 TransmitData 与再次 Acquire 均失败。
+ */
+uint8_t *LoRa_Port_AcquireTxBuffer(uint16_t *capacity);
+
+/**
+ * @brief  [新增] 发送已写入借出缓冲区的前 len 字节 (启动 DMA) 并归还缓冲区
+ * @param  len: 帧长度 (0=放弃本次发送，仅归还)
+ * @return 实际发送长度 (0=未发送)
+ */
+uint16_t LoRa_Port_CommitTx(uint16_t len);
+
 // ============================================================
 //                    4. 接收接口 (RX)
 // ============================================================
 
+/**
+ * @brief  [新增] 接收缓冲区中的一段连续可读数据
+ */
+typedef struct {
+    const uint8_t *data;
+    uint16_t       len;
+} LoRa_PortSpan_t;
+
 /**
  * @brief  从 DMA 循环缓冲区读取数据
  * @param  buf: 目标缓冲区
  * @param  max_len: 最大读取长度
  * @return 实际读取到的字节数
+ * @note   [变更] 等价于 PeekRx + 复制 + ConsumeRx
  */
 uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len);
 
+/**
+ * @brief  [新增] 原地查看已收到、尚未消费的数据 (零拷贝接收)
+ * @param  span: 输出至多两段 (DMA 环形缓冲区回绕时分为两段)，
+ *               按到达顺序排列；不足两段时其余段 len=0
+ * @return 可读字节总数
+ * @note   数据仍属于 Port，调用方只读；在 LoRa_Port_ConsumeRx 之前保持有效。
+ */
+uint16_t LoRa_Port_PeekRx(LoRa_PortSpan_t span[2]);
+
+/**
+ * @brief  [新增] 消费 (丢弃) 最早到达的 len 字节，归还给 DMA 继续写入
+ */
+void LoRa_Port_ConsumeRx(uint16_t len);
+
+/**
+ * @brief  [新增] 检查并清除接收溢出标志
+ * @return true = 上层消费不及时，接收缓冲区中未读的数据被覆盖 (已全部丢弃)
+ * @note   此后收到的字节与之前缓存的半帧不连续，上层应重新同步解析器。
+ *         接收暂存区由上层消费驱动 (不会被覆盖) 的平台恒返回 false。
+ */
+bool LoRa_Port_CheckAndClearRxOverrun(void);
+
 /**
  * @brief  清空接收缓冲区 (丢弃旧数据)
  * @note   通常在发送 AT 指令前调用，确保收到的是最新的响应
@@ -123,4 +179,11 @@ void LoRa_Port_NotifyHwEvent(void);
  */
 bool LoRa_Port_CheckAndClearHwEvent(void);
 
+/**
+ * @brief  [ISR调用] [新增] AUX 引脚边沿中断
+ * @note   在 AUX 的 EXTI/GPIO 中断中调用：记录下降沿时刻 (供 LoRa_Port_GetAuxIdleTick)，
+ *         并挂起硬件事件。没有 AUX 中断的平台无需调用。
+ */
+void LoRa_Port_OnAuxEdge(void);
+
 
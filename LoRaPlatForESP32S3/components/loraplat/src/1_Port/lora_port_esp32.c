@@ -24,6 +24,19 @@ static const char *TAG = "LoRa_Port";
 // [新增] 硬件事件挂起标志 (模拟中断标志)
 static volatile bool s_HwEventPending = false;
 
+// [新增] AUX 下降沿检测 (轮询)
+static bool     s_AuxLast = false;
+static uint32_t s_AuxIdleTick = 0;
+
+// [新增] 借出给上层直接封包的发送暂存区 (IDF 驱动没有可借出的 DMA 缓冲，Commit 时写入驱动 TX RingBuffer)
+static uint8_t  s_TxStage[LORA_PORT_DMA_TX_SIZE];
+static bool     s_TxLent = false;
+
+// [新增] 接收暂存区：IDF 驱动的 RX RingBuffer 不能原地访问，PeekRx 时读出到这里供上层原地解析
+static uint8_t  s_RxStage[LORA_PORT_DMA_RX_SIZE];
+static uint16_t s_RxHead = 0;
+static uint16_t s_RxTail = 0;
+
 // -----------------------------------------------------------------------------
 // 1. 初始化与配置
 // -----------------------------------------------------------------------------
@@ -92,6 +105,14 @@ bool LoRa_Port_GetAUX(void) {
     return gpio_get_level((gpio_num_t)LORA_PIN_AUX) == 1;
 }
 
+uint32_t LoRa_Port_GetAuxIdleTick(void) {
+    // 无 AUX 边沿中断：调用时轮询电平检测下降沿
+    bool aux = LoRa_Port_GetAUX();
+    if (s_AuxLast && !aux) s_AuxIdleTick = OSAL_GetTick();
+    s_AuxLast = aux;
+    return s_AuxIdleTick;
+}
+
 void LoRa_Port_SyncAuxState(void) {
     // ESP32 驱动自动管理，无需手动同步硬件状态
     // 可以在此清空 UART FIFO 以确保干净
@@ -111,7 +132,7 @@ bool LoRa_Port_IsTxBusy(void) {
 }
 
 uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
-    if (len == 0) return 0;
+    if (len == 0 || s_TxLent) return 0;
     
     // 写入 ESP32 的 TX RingBuffer，驱动会自动通过中断/DMA 发送
     int txBytes = uart_write_bytes(LORA_UART_PORT_NUM, (const char*)data, len);
@@ -124,11 +145,26 @@ uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
     return 0;
 }
 
+uint8_t *LoRa_Port_AcquireTxBuffer(uint16_t *capacity) {
+    if (s_TxLent) return NULL;
+    s_TxLent = true;
+    if (capacity) *capacity = sizeof(s_TxStage);
+    return s_TxStage;
+}
+
+uint16_t LoRa_Port_CommitTx(uint16_t len) {
+    if (!s_TxLent) return 0;
+    s_TxLent = false;
+    if (len == 0 || len > sizeof(s_TxStage)) return 0;
+    return LoRa_Port_TransmitData(s_TxStage, len);
+}
+
 // -----------------------------------------------------------------------------
 // 4. 接收接口 (RX)
 // -----------------------------------------------------------------------------
 
-uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
+// 从驱动 RX RingBuffer 读取 (不经过暂存区)
+static uint16_t _ReadDriver(uint8_t *buf, uint16_t max_len) {
     // 非阻塞读取：查看当前缓冲区有多少数据
     size_t available = 0;
     uart_get_buffered_data_len(LORA_UART_PORT_NUM, &available);
@@ -149,10 +185,54 @@ uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
     return 0;
 }
 
+uint16_t LoRa_Port_PeekRx(LoRa_PortSpan_t span[2]) {
+    if (s_RxHead > 0) {
+        memmove(s_RxStage, &s_RxStage[s_RxHead], s_RxTail - s_RxHead);
+        s_RxTail -= s_RxHead;
+        s_RxHead = 0;
+    }
+    if (s_RxTail < sizeof(s_RxStage)) {
+        s_RxTail += _ReadDriver(&s_RxStage[s_RxTail], (uint16_t)(sizeof(s_RxStage) - s_RxTail));
+    }
+    span[0].data = &s_RxStage[s_RxHead];
+    span[0].len = s_RxTail - s_RxHead;
+    span[1].data = s_RxStage;
+    span[1].len = 0;
+    return span[0].len;
+}
+
+void LoRa_Port_ConsumeRx(uint16_t len) {
+    if (len > s_RxTail - s_RxHead) len = s_RxTail - s_RxHead;
+    s_RxHead += len;
+    if (s_RxHead == s_RxTail) {
+        s_RxHead = 0;
+        s_RxTail = 0;
+    }
+}
+
+uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
+    // [新增] 先交付 PeekRx 已读出到暂存区、尚未消费的数据
+    if (s_RxTail > s_RxHead) {
+        uint16_t cnt = s_RxTail - s_RxHead;
+        if (cnt > max_len) cnt = max_len;
+        memcpy(buf, &s_RxStage[s_RxHead], cnt);
+        LoRa_Port_ConsumeRx(cnt);
+        return cnt;
+    }
+    return _ReadDriver(buf, max_len);
+}
+
 void LoRa_Port_ClearRxBuffer(void) {
+    s_RxHead = 0;
+    s_RxTail = 0;
     uart_flush_input(LORA_UART_PORT_NUM);
 }
 
+// [新增] 暂存区只在上层消费后才从驱动读入新数据，不会被覆盖
+bool LoRa_Port_CheckAndClearRxOverrun(void) {
+    return false;
+}
+
 // -----------------------------------------------------------------------------
 // 5. 其他能力
 // -----------------------------------------------------------------------------
@@ -170,6 +250,11 @@ void LoRa_Port_NotifyHwEvent(void) {
     s_HwEventPending = true;
 }
 
+void LoRa_Port_OnAuxEdge(void) {
+    LoRa_Port_GetAuxIdleTick();
+    s_HwEventPending = true;
+}
+
 bool LoRa_Port_CheckAndClearHwEvent(void) {
     // 简单原子操作 (ESP32 是双核，但在单任务轮询架构下，这里主要是防止重入)
     // 严格来说应该用自旋锁，但 bool 读写通常是原子的，且这里只是标志位
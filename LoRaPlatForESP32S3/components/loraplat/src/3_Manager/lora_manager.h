@@ -63,6 +63,12 @@ void LoRa_Manager_Init(const LoRa_Config_t *cfg, const LoRa_Manager_Callback_t *
  */
 void LoRa_Manager_RegisterCipher(const LoRa_Cipher_t *cipher);
 
+/**
+ * @brief  [新增] 指定发往某对端的帧 (含 ACK) 是否以 FEC 帧发送
+ * @note   与对端协商表一起保存，重新初始化后需重新设置。
+ */
+void LoRa_Manager_SetLinkFec(uint16_t peer_id, bool enable);
+
 /**
  * @brief  主循环 (需周期性调用)
  */
@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    lora_manager_compress.c
+  * @author  LoRaPlat Team
+  * @brief   LoRa 负载压缩实现 (LZSS)
+  ******************************************************************************
+  */
+
+#include "lora_manager_compress.h"
+
+#define COMP_OFFSET_BITS    8
+#define COMP_LENGTH_BITS    4
+#define COMP_WINDOW         (1u << COMP_OFFSET_BITS)
+#define COMP_MIN_MATCH      2
+#define COMP_MAX_MATCH      (COMP_MIN_MATCH + (1u << COMP_LENGTH_BITS) - 1)
+#define COMP_LITERAL_BITS   (1 + 8)
+#define COMP_BACKREF_BITS   (1 + COMP_OFFSET_BITS + COMP_LENGTH_BITS)
+
+// ============================================================
+//                    1. 位流读写
+// ============================================================
+
+typedef struct {
+    uint8_t  *buf;
+    uint16_t  max;
+    uint16_t  pos;      // 当前字节
+    uint8_t   bit;      // 当前字节已用位数
+    bool      overflow;
+} BitWriter_t;
+
+typedef struct {
+    const uint8_t *buf;
+    uint32_t       bits_left;
+    uint16_t       pos;
+    uint8_t        bit;
+} BitReader_t;
+
+static void _Comp_Put(BitWriter_t *w, uint16_t value, uint8_t nbits) {
+    while (nbits > 0) {
+        if (w->bit == 0) {
+            if (w->pos >= w->max) { w->overflow = true; return; }
+            w->buf[w->pos] = 0;
+        }
+        nbits--;
+        if (value & (1u << nbits)) w->buf[w->pos] |= (uint8_t)(0x80 >> w->bit);
+        if (++w->bit == 8) { w->bit = 0; w->pos++; }
+    }
+}
+
+static uint16_t _Comp_Get(BitReader_t *r, uint8_t nbits) {
+    uint16_t value = 0;
+    r->bits_left -= nbits;
+    while (nbits-- > 0) {
+        value = (uint16_t)((value << 1) | ((r->buf[r->pos] >> (7 - r->bit)) & 1));
+        if (++r->bit == 8) { r->bit = 0; r->pos++; }
+    }
+    return value;
+}
+
+// ============================================================
+//                    2. 压缩 / 解压
+// ============================================================
+
+uint16_t LoRa_Manager_Compress_Encode(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t out_max) {
+    BitWriter_t w = { out, out_max, 0, 0, false };
+    if (len < 2) return 0;
+    // 结果必须比原文短，否则不值得
+    if (w.max >= len) w.max = len - 1;
+
+    uint16_t i = 0;
+    while (i < len) {
+        uint16_t best_len = 0, best_off = 0;
+        uint16_t start = (i > COMP_WINDOW) ? (uint16_t)(i - COMP_WINDOW) : 0;
+        uint16_t limit = len - i;
+        if (limit > COMP_MAX_MATCH) limit = COMP_MAX_MATCH;
+
+        // 从近到远搜索最长匹配 (允许与当前位置重叠，即游程)
+        for (uint16_t j = i; j-- > start && best_len < limit; ) {
+            uint16_t k = 0;
+            while (k < limit && in[j + k] == in[i + k]) k++;
+            if (k > best_len) { best_len = k; best_off = i - j; }
+        }
+
+        if (best_len >= COMP_MIN_MATCH) {
+            _Comp_Put(&w, 0, 1);
+            _Comp_Put(&w, best_off - 1, COMP_OFFSET_BITS);
+            _Comp_Put(&w, best_len - COMP_MIN_MATCH, COMP_LENGTH_BITS);
+            i += best_len;
+        } else {
+            _Comp_Put(&w, 1, 1);
+            _Comp_Put(&w, in[i], 8);
+            i++;
+        }
+        if (w.overflow) return 0;
+    }
+    return (uint16_t)(w.pos + (w.bit ? 1 : 0));
+}
+
+uint16_t LoRa_Manager_Compress_Decode(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t out_max) {
+    BitReader_t r = { in, (uint32_t)len * 8, 0, 0 };
+    uint16_t n = 0;
+
+    while (r.bits_left >= COMP_LITERAL_BITS) {
+        if (_Comp_Get(&r, 1)) {
+            if (n >= out_max) return 0;
+            out[n++] = (uint8_t)_Comp_Get(&r, 8);
+            continue;
+        }
+        if (r.bits_left < COMP_BACKREF_BITS - 1) return 0;
+        uint16_t off = _Comp_Get(&r, COMP_OFFSET_BITS) + 1;
+        uint16_t cnt = _Comp_Get(&r, COMP_LENGTH_BITS) + COMP_MIN_MATCH;
+        if (off > n || n + cnt > out_max) return 0;
+        for (uint16_t k = 0; k < cnt; k++, n++) out[n] = out[n - off];
+    }
+    // 剩余的只能是不足一个字节的补位
+    if (r.bits_left >= 8) return 0;
+    return n;
+}
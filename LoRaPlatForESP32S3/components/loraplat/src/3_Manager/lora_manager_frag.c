@@ -0,0 +1,225 @@
+/**
+  ******************************************************************************
+  * @file    lora_manager_frag.c
+  * @author  LoRaPlat Team
+  * @brief   LoRa 分片与重组实现
+  ******************************************************************************
+  */
+
+#include "lora_manager_frag.h"
+#include "lora_port.h"
+#include "lora_osal.h"
+#include <string.h>
+
+#define FRAG_MAX_COUNT      ((LORA_FRAG_MAX_MSG_LEN + LORA_FRAG_CHUNK_LEN - 1) / LORA_FRAG_CHUNK_LEN)
+#define FRAG_BITMAP_WORDS   ((FRAG_MAX_COUNT + 31) / 32)
+#define FRAG_IDX_UNKNOWN    0xFF
+
+#if (FRAG_MAX_COUNT > 128)
+#error "LORA_FRAG_MAX_MSG_LEN exceeds 128 fragments"
+#endif
+#if (LORA_FRAG_HDR_LEN + LORA_FRAG_CHUNK_LEN > LORA_MAX_PAYLOAD_LEN)
+#error "LORA_FRAG_CHUNK_LEN too large"
+#endif
+
+// ============================================================
+//                    1. 内部数据结构
+// ============================================================
+
+// 发送上下文 (同一时刻只发送一条分片消息)
+typedef struct {
+    uint8_t        buf[LORA_FRAG_MAX_MSG_LEN];
+    uint16_t       len;
+    uint16_t       target_id;
+    LoRa_SendOpt_t opt;
+    LoRa_MsgID_t   msg_id;
+    uint8_t        tag;
+    uint8_t        count;       // 分片总数
+    uint8_t        next;        // 下一个待送入窗口的分片
+    uint8_t        done;        // 已出结果的分片数
+    bool           failed;
+    bool           active;
+} FragTx_t;
+
+// 重组缓冲区 (按源分配)
+typedef struct {
+    bool     valid;
+    bool     has_tag;           // false=仅预留，尚未收到分片
+    uint16_t src_id;
+    uint8_t  tag;
+    uint8_t  last_idx;          // 最后一片的序号 (FRAG_IDX_UNKNOWN=未收到)
+    uint16_t last_len;
+    uint32_t deadline;
+    uint32_t bitmap[FRAG_BITMAP_WORDS];
+    uint8_t  buf[LORA_FRAG_MAX_MSG_LEN];
+} FragRx_t;
+
+static FragTx_t s_FragTx;
+static FragRx_t s_FragRx[LORA_FRAG_RX_SLOTS];
+static uint8_t  s_FragTag = 0;
+
+// ============================================================
+//                    2. 发送
+// ============================================================
+
+void LoRa_Manager_Frag_Init(void) {
+    memset(&s_FragTx, 0, sizeof(s_FragTx));
+    memset(s_FragRx, 0, sizeof(s_FragRx));
+    // 随机起始标签，避免重启后与对端残留的重组缓冲区混淆
+    s_FragTag = (uint8_t)LoRa_Port_GetEntropy32();
+}
+
+bool LoRa_Manager_Frag_TxStart(const uint8_t *data, uint16_t len, uint16_t target_id,
+                               LoRa_SendOpt_t opt, LoRa_MsgID_t msg_id) {
+    if (s_FragTx.active || len == 0 || len > LORA_FRAG_MAX_MSG_LEN) return false;
+
+    memcpy(s_FragTx.buf, data, len);
+    s_FragTx.len = len;
+    s_FragTx.target_id = target_id;
+    s_FragTx.opt = opt;
+    s_FragTx.msg_id = msg_id;
+    s_FragTx.tag = s_FragTag++;
+    s_FragTx.count = (uint8_t)((len + LORA_FRAG_CHUNK_LEN - 1) / LORA_FRAG_CHUNK_LEN);
+    s_FragTx.next = 0;
+    s_FragTx.done = 0;
+    s_FragTx.failed = false;
+    s_FragTx.active = true;
+
+    LORA_LOG("[FRAG] TX Start (ID:%d, Len:%d, Frags:%d)\r\n", msg_id, len, s_FragTx.count);
+    return true;
+}
+
+uint16_t LoRa_Manager_Frag_TxPeek(uint8_t *out, uint16_t *target_id, LoRa_SendOpt_t *opt, LoRa_MsgID_t *msg_id) {
+    if (!s_FragTx.active || s_FragTx.failed || s_FragTx.next >= s_FragTx.count) return 0;
+
+    uint8_t  idx = s_FragTx.next;
+    uint16_t off = (uint16_t)idx * LORA_FRAG_CHUNK_LEN;
+    uint16_t n   = s_FragTx.len - off;
+    if (n > LORA_FRAG_CHUNK_LEN) n = LORA_FRAG_CHUNK_LEN;
+
+    if (out) {
+        out[0] = s_FragTx.tag;
+        out[1] = idx | ((idx == s_FragTx.count - 1) ? LORA_FRAG_LAST_MASK : 0);
+        memcpy(&out[LORA_FRAG_HDR_LEN], &s_FragTx.buf[off], n);
+    }
+
+    *target_id = s_FragTx.target_id;
+    *opt = s_FragTx.opt;
+    *msg_id = s_FragTx.msg_id;
+    return LORA_FRAG_HDR_LEN + n;
+}
+
+void LoRa_Manager_Frag_TxAdvance(void) {
+    if (s_FragTx.active && s_FragTx.next < s_FragTx.count) s_FragTx.next++;
+}
+
+LoRa_FragTxResult_t LoRa_Manager_Frag_OnTxResult(LoRa_MsgID_t msg_id, bool success) {
+    if (!s_FragTx.active || msg_id != s_FragTx.msg_id) return LORA_FRAG_TX_NONE;
+
+    s_FragTx.done++;
+    if (!success && !s_FragTx.failed) {
+        LORA_LOG("[FRAG] TX Fail (ID:%d, %d/%d sent)\r\n", msg_id, s_FragTx.next, s_FragTx.count);
+        s_FragTx.failed = true;
+    }
+
+    // 已送入窗口的分片全部出结果，且 (全部分片已发出 或 已失败不再发送)
+    if (s_FragTx.done < s_FragTx.next) return LORA_FRAG_TX_PENDING;
+    if (!s_FragTx.failed && s_FragTx.next < s_FragTx.count) return LORA_FRAG_TX_PENDING;
+
+    s_FragTx.active = false;
+    return s_FragTx.failed ? LORA_FRAG_TX_DONE_FAIL : LORA_FRAG_TX_DONE_OK;
+}
+
+bool LoRa_Manager_Frag_TxIsBusy(void) {
+    return s_FragTx.active;
+}
+
+// ============================================================
+//                    3. 接收 (重组)
+// ============================================================
+
+static FragRx_t* _Frag_RxFind(uint16_t src_id) {
+    uint32_t now = OSAL_GetTick();
+
+    for (int i = 0; i < LORA_FRAG_RX_SLOTS; i++) {
+        FragRx_t *r = &s_FragRx[i];
+        if (!r->valid) continue;
+        if ((int32_t)(r->deadline - now) <= 0) {
+            LORA_LOG("[FRAG] RX Timeout (Src %d)\r\n", r->src_id);
+            r->valid = false;
+            continue;
+        }
+        if (r->src_id == src_id) return r;
+    }
+    return NULL;
+}
+
+bool LoRa_Manager_Frag_RxReserve(uint16_t src_id) {
+    FragRx_t *r = _Frag_RxFind(src_id);
+    if (r) return true;
+
+    for (int i = 0; i < LORA_FRAG_RX_SLOTS; i++) {
+        r = &s_FragRx[i];
+        if (r->valid) continue;
+        r->valid = true;
+        r->has_tag = false;
+        r->src_id = src_id;
+        r->deadline = OSAL_GetTick() + LORA_FRAG_RX_TIMEOUT_MS;
+        return true;
+    }
+    LORA_LOG("[FRAG] RX Busy, Defer (Src %d)\r\n", src_id);
+    return false;
+}
+
+void LoRa_Manager_Frag_RxUnreserve(uint16_t src_id) {
+    FragRx_t *r = _Frag_RxFind(src_id);
+    if (r && !r->has_tag) r->valid = false;
+}
+
+bool LoRa_Manager_Frag_RxInput(uint16_t src_id, const uint8_t *payload, uint16_t len,
+                               uint8_t **out, uint16_t *out_len) {
+    if (len < LORA_FRAG_HDR_LEN) return false;
+    if (!LoRa_Manager_Frag_RxReserve(src_id)) return false;
+    FragRx_t *r = _Frag_RxFind(src_id);
+
+    uint8_t  tag  = payload[0];
+    uint8_t  idx  = payload[1] & ~LORA_FRAG_LAST_MASK;
+    bool     last = (payload[1] & LORA_FRAG_LAST_MASK) != 0;
+    uint16_t n    = len - LORA_FRAG_HDR_LEN;
+    uint16_t off  = (uint16_t)idx * LORA_FRAG_CHUNK_LEN;
+
+    // 非最后一片必须是整片 (接收方据此计算偏移)
+    if (idx >= FRAG_MAX_COUNT || n > LORA_FRAG_CHUNK_LEN || (!last && n != LORA_FRAG_CHUNK_LEN) ||
+        off + n > LORA_FRAG_MAX_MSG_LEN) {
+        LORA_LOG("[FRAG] RX Drop Invalid (Src %d, Idx %d)\r\n", src_id, idx);
+        return false;
+    }
+
+    // 新消息 (标签变化)：丢弃该源未完成的旧消息
+    if (!r->has_tag || r->tag != tag) {
+        r->has_tag = true;
+        r->tag = tag;
+        r->last_idx = FRAG_IDX_UNKNOWN;
+        memset(r->bitmap, 0, sizeof(r->bitmap));
+    }
+
+    memcpy(&r->buf[off], &payload[LORA_FRAG_HDR_LEN], n);
+    r->bitmap[idx / 32] |= (1UL << (idx % 32));
+    if (last) {
+        r->last_idx = idx;
+        r->last_len = n;
+    }
+    r->deadline = OSAL_GetTick() + LORA_FRAG_RX_TIMEOUT_MS;
+
+    // 收齐检查
+    if (r->last_idx == FRAG_IDX_UNKNOWN) return false;
+    for (uint8_t i = 0; i <= r->last_idx; i++) {
+        if (!(r->bitmap[i / 32] & (1UL << (i % 32)))) return false;
+    }
+
+    r->valid = false;
+    *out = r->buf;
+    *out_len = (uint16_t)r->last_idx * LORA_FRAG_CHUNK_LEN + r->last_len;
+    LORA_LOG("[FRAG] RX Done (Src %d, Len %d)\r\n", src_id, *out_len);
+    return true;
+}
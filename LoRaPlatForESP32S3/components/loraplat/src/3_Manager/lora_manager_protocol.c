@@ -2,26 +2,275 @@
   ******************************************************************************
   * @file    lora_manager_protocol.c
   * @author  LoRaPlat Team
-  * @brief   LoRa 协议封包解包实现 (V3.9.5 - 16-bit Seq Support)
+  * @brief   LoRa 协议封包解包实现 (V3.9.7 - FEC Frame)
   ******************************************************************************
   */
 
 #include "lora_manager_protocol.h"
 #include "lora_crc16.h"
+#include "lora_rs.h"
 #include "lora_osal.h"
 #include <string.h>
 
+#if (LORA_FEC_PARITY_LEN % 2) || (LORA_FEC_PARITY_LEN > LORA_RS_MAX_PARITY) || (LORA_FEC_BLOCK_LEN + LORA_FEC_PARITY_LEN > 255)
+#error "LORA_FEC_PARITY_LEN must be even and <= 16, and a codeword (block + parity) must fit in 255 bytes"
+#endif
+
+// ============================================================
+//                    0. 对端格式协商 (V1/V2)
+// ============================================================
+
+typedef struct {
+    uint16_t id;
+    uint32_t last_seen;
+    bool     v2;
+    bool     fec_rx;     // [新增] 对端最近发来的帧是 FEC 帧
+    bool     fec_set;    // [新增] 手动指定使用 FEC
+    bool     hcs;        // [新增] 对端支持接收带帧头校验的 V2 帧
+    bool     ext;        // [新增] 对端支持接收聚合帧、压缩负载与捎带确认
+    bool     valid;
+} ProtoPeer_t;
+
+static ProtoPeer_t s_ProtoPeers[LORA_ARQ_PEER_MAX];
+
+void LoRa_Manager_Protocol_Init(void) {
+    memset(s_ProtoPeers, 0, sizeof(s_ProtoPeers));
+}
+
+static ProtoPeer_t *_Protocol_PeerFind(uint16_t id) {
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (s_ProtoPeers[i].valid && s_ProtoPeers[i].id == id) return &s_ProtoPeers[i];
+    }
+    return NULL;
+}
+
+// LRU 淘汰 (优先保留手动指定过 FEC 的条目)
+static ProtoPeer_t *_Protocol_PeerAlloc(uint16_t id) {
+    uint32_t now = OSAL_GetTick();
+    ProtoPeer_t *victim = NULL;
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        ProtoPeer_t *p = &s_ProtoPeers[i];
+        if (!p->valid) { victim = p; break; }
+        if (!victim || (victim->fec_set && !p->fec_set) ||
+            (victim->fec_set == p->fec_set && (now - p->last_seen) > (now - victim->last_seen))) {
+            victim = p;
+        }
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->valid = true;
+    victim->id = id;
+    victim->last_seen = now;
+    return victim;
+}
+
+void LoRa_Manager_Protocol_LearnPeer(const LoRa_Packet_t *packet) {
+    bool v2 = false, v2_known = false;
+    bool hcs = false, hcs_known = false;
+    bool ext = false, ext_known = false;
+    uint8_t cap = (packet->IsAckPacket && packet->PayloadLen > 0) ? packet->Payload[0] : 0;
+
+    if (packet->Format == LORA_FRAME_FMT_V2) {
+        ext = ext_known = true;
+    } else if (packet->IsAckPacket) {
+        // [新增] 旧版节点的 V1 ACK 不带能力字节，据此降级
+        ext = (cap & LORA_PROTOCOL_CAP_EXT) != 0;
+        ext_known = true;
+    }
+#if LORA_FRAME_V2_ENABLE
+    if (packet->Format == LORA_FRAME_FMT_V2) {
+        v2 = true;
+        v2_known = true;
+        // [新增] 不带帧头校验的 V2 帧不能说明对端不支持 (可能只是关闭了 NACK)
+        hcs = hcs_known = packet->HdrCheck;
+    } else if (packet->IsAckPacket) {
+        // V1 数据帧不携带能力信息，V1 ACK 带能力字节
+        v2 = (cap & LORA_PROTOCOL_CAP_V2) != 0;
+        v2_known = true;
+        hcs = (cap & LORA_PROTOCOL_CAP_HCS) != 0;
+        hcs_known = true;
+    }
+#endif
+
+    ProtoPeer_t *p = _Protocol_PeerFind(packet->SourceID);
+    if (!p) {
+        // 未记录的对端默认 V1、不用 FEC、不用扩展负载，不为其占用条目
+        if (!v2 && !ext && !packet->UseFec) return;
+        p = _Protocol_PeerAlloc(packet->SourceID);
+    }
+
+    if (v2_known && p->v2 != v2) {
+        LORA_LOG("[PROTO] Peer %d -> V%d\r\n", p->id, v2 ? 2 : 1);
+        p->v2 = v2;
+    }
+    if (hcs_known) p->hcs = hcs;
+    if (ext_known) p->ext = ext;
+    if (p->fec_rx != packet->UseFec) {
+        LORA_LOG("[PROTO] Peer %d FEC %s\r\n", p->id, packet->UseFec ? "On" : "Off");
+        p->fec_rx = packet->UseFec;
+    }
+    p->last_seen = OSAL_GetTick();
+}
+
+uint8_t LoRa_Manager_Protocol_SelectFormat(uint16_t target_id) {
+#if LORA_FRAME_V2_ENABLE
+    // 广播/组播的接收方不确定，始终用 V1
+    const ProtoPeer_t *p = _Protocol_PeerFind(target_id);
+    if (p && p->v2 && target_id != LORA_ID_BROADCAST) return LORA_FRAME_FMT_V2;
+#else
+    (void)target_id;
+#endif
+    return LORA_FRAME_FMT_V1;
+}
+
+void LoRa_Manager_Protocol_SetLinkFec(uint16_t peer_id, bool enable) {
+    ProtoPeer_t *p = _Protocol_PeerFind(peer_id);
+    if (!p) {
+        if (!enable) return;
+        p = _Protocol_PeerAlloc(peer_id);
+    }
+    p->fec_set = enable;
+}
+
+bool LoRa_Manager_Protocol_LinkFec(uint16_t target_id) {
+#if LORA_FEC_ENABLE
+    const ProtoPeer_t *p = _Protocol_PeerFind(target_id);
+    return p && (p->fec_set || p->fec_rx);
+#else
+    (void)target_id;
+    return false;
+#endif
+}
+
+bool LoRa_Manager_Protocol_LinkHdrCheck(uint16_t target_id) {
+#if LORA_NACK_ENABLE && LORA_FRAME_V2_ENABLE
+    const ProtoPeer_t *p = _Protocol_PeerFind(target_id);
+    return p && p->v2 && p->hcs && target_id != LORA_ID_BROADCAST;
+#else
+    (void)target_id;
+    return false;
+#endif
+}
+
+bool LoRa_Manager_Protocol_LinkExt(uint16_t target_id) {
+    // 广播/组播的接收方可能含旧版节点，始终不用
+    const ProtoPeer_t *p = _Protocol_PeerFind(target_id);
+    return p && p->ext && target_id != LORA_ID_BROADCAST;
+}
+
 // ============================================================
 //                    1. 封包实现 (Pack)
 // ============================================================
 
-uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet, 
-                                    uint8_t *buffer, 
-                                    uint16_t buffer_size,
-                                    uint8_t tmode,
-                                    uint8_t channel)
+static uint8_t _Protocol_Ctrl(const LoRa_Packet_t *packet) {
+    uint8_t ctrl = 0;
+    if (packet->IsAckPacket) ctrl |= LORA_CTRL_MASK_TYPE;
+    if (packet->NeedAck)     ctrl |= LORA_CTRL_MASK_NEED_ACK;
+    if (packet->HasCrc)      ctrl |= LORA_CTRL_MASK_HAS_CRC;
+    if (packet->IsFragment)  ctrl |= LORA_CTRL_MASK_FRAG;
+    if (packet->IsAggregate) ctrl |= LORA_CTRL_MASK_AGG;
+    if (packet->IsCompressed) ctrl |= LORA_CTRL_MASK_COMP;
+    if (packet->IsBlockAck)  ctrl |= LORA_CTRL_MASK_BLOCK;
+    if (packet->HasPiggyAck) ctrl |= LORA_CTRL_MASK_PIGGY;
+    return ctrl;
+}
+
+// [新增] 帧中负载区长度 (捎带确认前缀 + 负载)
+static uint16_t _Protocol_BodyLen(const LoRa_Packet_t *packet) {
+    uint16_t len = packet->PayloadLen;
+    if (packet->HasPiggyAck) len += LORA_PROTOCOL_PIGGY_HDR_LEN + packet->PiggyAckLen;
+    return len;
+}
+
+// [新增] 写入负载区，返回写入字节数
+static uint16_t _Protocol_PutBody(const LoRa_Packet_t *packet, uint8_t *dst) {
+    uint16_t n = 0;
+    if (packet->HasPiggyAck) {
+        dst[n++] = (uint8_t)(packet->PiggyAckSeq & 0xFF);
+        dst[n++] = (uint8_t)(packet->PiggyAckSeq >> 8);
+        dst[n++] = packet->PiggyAckLen;
+        memcpy(&dst[n], packet->PiggyAckMap, packet->PiggyAckLen);
+        n += packet->PiggyAckLen;
+    }
+    if (packet->PayloadLen > 0) memcpy(&dst[n], packet->Payload, packet->PayloadLen);
+    return n + packet->PayloadLen;
+}
+
+// V2 短地址：ID 放得进 1 字节 (0xFF 保留给广播)
+static bool _Protocol_IsShortId(uint16_t id) {
+    return (id < 0xFF) || (id == LORA_ID_BROADCAST);
+}
+
+// V2 中 ACK 帧与确认帧只带序号低 8 位 (窗口远小于 128，接收方可无歧义地扩展)
+static bool _Protocol_IsSeqShort(uint8_t ctrl) {
+    return (ctrl & (LORA_CTRL_MASK_TYPE | LORA_CTRL_MASK_NEED_ACK)) != 0;
+}
+
+// V2 帧头长度 (不含负载与 CRC，[变更] 含帧头校验)
+static uint16_t _Protocol_V2HeaderLen(uint8_t head, uint8_t ctrl) {
+    return 3 + (_Protocol_IsSeqShort(ctrl) ? 1 : 2) + ((head & LORA_PROTOCOL_V2_SHORT_ADDR) ? 2 : 4) +
+           ((head & LORA_PROTOCOL_V2_HDR_CHECK) ? 1 : 0);
+}
+
+// [新增] 帧头校验：Head 到 Source 的 CRC16 低字节
+static uint8_t _Protocol_HeaderCheck(const uint8_t *hdr, uint16_t len) {
+    return (uint8_t)(LoRa_CRC16_Calculate(hdr, len) & 0xFF);
+}
+
+static uint16_t _Protocol_PackV2(const LoRa_Packet_t *packet, uint8_t *buffer, uint16_t buffer_size,
+                                 uint8_t tmode, uint8_t channel)
 {
-    LORA_CHECK(packet && buffer && buffer_size > 0, 0);
+    uint8_t  ctrl = _Protocol_Ctrl(packet) | LORA_CTRL_MASK_HAS_CRC;
+    bool     short_addr = _Protocol_IsShortId(packet->TargetID) && _Protocol_IsShortId(packet->SourceID);
+    uint8_t  head = LORA_PROTOCOL_V2_HEAD | (short_addr ? LORA_PROTOCOL_V2_SHORT_ADDR : 0) |
+                    (packet->HdrCheck ? LORA_PROTOCOL_V2_HDR_CHECK : 0);
+    uint16_t start = (tmode == 1) ? 3 : 0;
+    uint16_t idx = 0;
+
+    uint16_t body_len = _Protocol_BodyLen(packet);
+    if (body_len > LORA_MAX_PAYLOAD_LEN || packet->PiggyAckLen > LORA_PROTOCOL_PIGGY_MAP_MAX) return 0;
+    if (start + _Protocol_V2HeaderLen(head, ctrl) + body_len + 2 > buffer_size) return 0;
+
+    // 定点模式前缀 (同 V1)
+    if (tmode == 1) {
+        buffer[idx++] = (uint8_t)(packet->TargetID >> 8);
+        buffer[idx++] = (uint8_t)(packet->TargetID & 0xFF);
+        buffer[idx++] = channel;
+    }
+
+    buffer[idx++] = head;
+    buffer[idx++] = (uint8_t)body_len;
+    buffer[idx++] = ctrl;
+    buffer[idx++] = (uint8_t)(packet->Sequence & 0xFF);
+    if (!_Protocol_IsSeqShort(ctrl)) buffer[idx++] = (uint8_t)(packet->Sequence >> 8);
+
+    if (short_addr) {
+        buffer[idx++] = (uint8_t)packet->TargetID;
+        buffer[idx++] = (uint8_t)packet->SourceID;
+    } else {
+        buffer[idx++] = (uint8_t)(packet->TargetID & 0xFF);
+        buffer[idx++] = (uint8_t)(packet->TargetID >> 8);
+        buffer[idx++] = (uint8_t)(packet->SourceID & 0xFF);
+        buffer[idx++] = (uint8_t)(packet->SourceID >> 8);
+    }
+    if (packet->HdrCheck) {
+        buffer[idx] = _Protocol_HeaderCheck(&buffer[start], idx - start);
+        idx++;
+    }
+
+    idx += _Protocol_PutBody(packet, &buffer[idx]);
+
+    uint16_t crc = LoRa_CRC16_Calculate(&buffer[start], idx - start);
+    buffer[idx++] = (uint8_t)(crc & 0xFF);
+    buffer[idx++] = (uint8_t)(crc >> 8);
+    return idx;
+}
+
+static uint16_t _Protocol_PackPlain(const LoRa_Packet_t *packet, uint8_t *buffer, uint16_t buffer_size,
+                                   uint8_t tmode, uint8_t channel)
+{
+    if (packet->Format == LORA_FRAME_FMT_V2) {
+        return _Protocol_PackV2(packet, buffer, buffer_size, tmode, channel);
+    }
     
     uint16_t idx = 0;
     
@@ -40,15 +289,14 @@ uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet,
     buffer[idx++] = LORA_PROTOCOL_HEAD_0;
     buffer[idx++] = LORA_PROTOCOL_HEAD_1;
     
-    // 3. 长度 (Payload Len)
+    // 3. 长度 (Payload Len，[变更] 含捎带确认前缀)
+    uint16_t body_len = _Protocol_BodyLen(packet);
+    if (body_len > LORA_MAX_PAYLOAD_LEN || packet->PiggyAckLen > LORA_PROTOCOL_PIGGY_MAP_MAX) return 0;
     if (idx + 1 > buffer_size) return 0;
-    buffer[idx++] = packet->PayloadLen;
+    buffer[idx++] = (uint8_t)body_len;
     
     // 4. 控制字 (Ctrl)
-    uint8_t ctrl = 0;
-    if (packet->IsAckPacket) ctrl |= LORA_CTRL_MASK_TYPE;
-    if (packet->NeedAck)     ctrl |= LORA_CTRL_MASK_NEED_ACK;
-    if (packet->HasCrc)      ctrl |= LORA_CTRL_MASK_HAS_CRC;
+    uint8_t ctrl = _Protocol_Ctrl(packet);
     
     if (idx + 1 > buffer_size) return 0;
     buffer[idx++] = ctrl;
@@ -66,10 +314,9 @@ uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet,
     buffer[idx++] = (uint8_t)(packet->SourceID >> 8);
     
     // 7. 负载 (Payload)
-    if (packet->PayloadLen > 0) {
-        if (idx + packet->PayloadLen > buffer_size) return 0;
-        memcpy(&buffer[idx], packet->Payload, packet->PayloadLen);
-        idx += packet->PayloadLen;
+    if (body_len > 0) {
+        if (idx + body_len > buffer_size) return 0;
+        idx += _Protocol_PutBody(packet, &buffer[idx]);
     }
     
     // 8. CRC16 (可选)
@@ -97,16 +344,189 @@ uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet,
     return idx;
 }
 
+#if LORA_FEC_ENABLE
+// [新增] 打包内层帧后以 FEC 帧包裹 (定点前缀仍在最前，由模组消耗)
+static uint16_t _Protocol_PackFec(const LoRa_Packet_t *packet, uint8_t *buffer, uint16_t buffer_size,
+                                  uint8_t tmode, uint8_t channel)
+{
+    uint16_t start = (tmode == 1) ? 3 : 0;
+    uint16_t body  = start + LORA_PROTOCOL_FEC_HDR_LEN;
+    if (body >= buffer_size) return 0;
+
+    uint16_t inner = _Protocol_PackPlain(packet, &buffer[body], buffer_size - body, 0, 0);
+    if (inner == 0 || inner > 0xFF) return 0;
+
+    uint16_t blocks = LORA_PROTOCOL_FEC_BLOCKS(inner);
+    uint16_t total  = body + inner + blocks * LORA_FEC_PARITY_LEN;
+    if (total > buffer_size) return 0;
+
+    if (tmode == 1) {
+        buffer[0] = (uint8_t)(packet->TargetID >> 8);
+        buffer[1] = (uint8_t)(packet->TargetID & 0xFF);
+        buffer[2] = channel;
+    }
+    buffer[start]     = LORA_PROTOCOL_FEC_HEAD;
+    buffer[start + 1] = (uint8_t)inner;
+    LoRa_RS_Encode(&buffer[start], 2, &buffer[start + 2], LORA_PROTOCOL_FEC_HDR_PARITY);
+
+    // 交织：码字 i 取第 i, i+D, i+2D ... 字节
+    uint8_t *frame  = &buffer[body];
+    uint8_t *parity = &buffer[body + inner];
+    uint8_t  cw[LORA_FEC_BLOCK_LEN];
+    uint8_t  par[LORA_FEC_PARITY_LEN];
+    for (uint16_t i = 0; i < blocks; i++) {
+        uint8_t k = 0;
+        for (uint16_t j = i; j < inner; j += blocks) cw[k++] = frame[j];
+        LoRa_RS_Encode(cw, k, par, LORA_FEC_PARITY_LEN);
+        for (uint16_t p = 0; p < LORA_FEC_PARITY_LEN; p++) parity[p * blocks + i] = par[p];
+    }
+    return total;
+}
+#endif
+
+uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet, 
+                                    uint8_t *buffer, 
+                                    uint16_t buffer_size,
+                                    uint8_t tmode,
+                                    uint8_t channel)
+{
+    LORA_CHECK(packet && buffer && buffer_size > 0, 0);
+
+#if LORA_FEC_ENABLE
+    if (packet->UseFec) return _Protocol_PackFec(packet, buffer, buffer_size, tmode, channel);
+#endif
+    return _Protocol_PackPlain(packet, buffer, buffer_size, tmode, channel);
+}
+
 // ============================================================
 //                    2. 解包实现 (Unpack)
 // ============================================================
 
-uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer, 
-                                      uint16_t length, 
-                                      LoRa_Packet_t *packet,
-                                      uint16_t local_id,
-                                      uint16_t group_id)
+static bool _Protocol_Accept(uint16_t target, uint16_t local_id, uint16_t group_id) {
+    return (target == local_id) || 
+           (target == 0xFFFF) || 
+           (group_id != 0 && target == group_id);
+}
+
+/**
+ * @brief [新增] 校验捎带确认前缀
+ * @return 前缀长度 (0=不带)，-1=前缀非法
+ */
+static int _Protocol_PiggyCheck(uint8_t ctrl, const uint8_t *body, uint8_t body_len) {
+    if (!(ctrl & LORA_CTRL_MASK_PIGGY)) return 0;
+    if ((ctrl & LORA_CTRL_MASK_TYPE) || body_len < LORA_PROTOCOL_PIGGY_HDR_LEN) return -1;
+    uint8_t map_len = body[2];
+    if (map_len > LORA_PROTOCOL_PIGGY_MAP_MAX || LORA_PROTOCOL_PIGGY_HDR_LEN + map_len > body_len) return -1;
+    return LORA_PROTOCOL_PIGGY_HDR_LEN + map_len;
+}
+
+// [新增] 填充负载 (剥离捎带确认前缀，prefix 由 _Protocol_PiggyCheck 给出)
+static void _Protocol_TakeBody(LoRa_Packet_t *packet, const uint8_t *body, uint8_t body_len, int prefix) {
+    packet->HasPiggyAck = (prefix > 0);
+    if (prefix > 0) {
+        packet->PiggyAckSeq = (uint16_t)body[0] | ((uint16_t)body[1] << 8);
+        packet->PiggyAckLen = body[2];
+        memcpy(packet->PiggyAckMap, &body[LORA_PROTOCOL_PIGGY_HDR_LEN], packet->PiggyAckLen);
+    }
+    packet->PayloadLen = (uint8_t)(body_len - prefix);
+    if (packet->PayloadLen > 0) memcpy(packet->Payload, &body[prefix], packet->PayloadLen);
+}
+
+/**
+ * @param crc: [新增] 流式解析器已增量算好的 CRC (NULL=在此计算)
+ */
+static uint16_t _Protocol_UnpackV2(const uint8_t *buffer, uint16_t length, LoRa_Packet_t *packet,
+                                   uint16_t local_id, uint16_t group_id, const uint16_t *crc)
 {
+    if (length < 3) return 0;
+
+    uint8_t head  = buffer[0];
+    uint8_t p_len = buffer[1];
+    uint8_t ctrl  = buffer[2];
+    if (p_len > LORA_MAX_PAYLOAD_LEN) return 1; // 长度非法，不是帧头
+
+    bool     hdr_check = (head & LORA_PROTOCOL_V2_HDR_CHECK) != 0;
+    uint16_t hdr_len = _Protocol_V2HeaderLen(head, ctrl);
+    uint16_t expected_len = hdr_len + p_len + 2;
+
+    // [新增] 帧头校验：帧头一到齐即可判断，不符时不必等整帧
+    if (hdr_check) {
+        if (hdr_len > length) return 0;
+        if (_Protocol_HeaderCheck(buffer, hdr_len - 1) != buffer[hdr_len - 1]) return 1;
+    }
+    if (expected_len > length) return 0;
+
+    bool     short_seq = _Protocol_IsSeqShort(ctrl);
+    uint16_t idx = 3;
+    uint16_t seq = buffer[idx++];
+    if (!short_seq) seq |= (uint16_t)buffer[idx++] << 8;
+
+    uint16_t target, source;
+    if (head & LORA_PROTOCOL_V2_SHORT_ADDR) {
+        target = (buffer[idx] == 0xFF) ? LORA_ID_BROADCAST : buffer[idx];
+        source = buffer[idx + 1];
+        idx += 2;
+    } else {
+        target = (uint16_t)buffer[idx] | ((uint16_t)buffer[idx + 1] << 8);
+        source = (uint16_t)buffer[idx + 2] | ((uint16_t)buffer[idx + 3] << 8);
+        idx += 4;
+    }
+    if (hdr_check) idx++;
+
+    // 没有包尾，长度字段只有经 CRC 确认后才可信：失败时只丢弃帧头字节重新同步
+    uint16_t calc_crc = crc ? *crc : LoRa_CRC16_Calculate(buffer, hdr_len + p_len);
+    uint16_t recv_crc = (uint16_t)buffer[expected_len - 2] | ((uint16_t)buffer[expected_len - 1] << 8);
+    if (calc_crc != recv_crc) {
+        if (!hdr_check) return 1;
+        // [新增] 帧头校验通过：长度与地址可信，丢弃整帧，发给本机的帧上报帧头 (供回复 NACK)
+        if (target != local_id) return expected_len;
+        if (packet) {
+            memset(packet, 0, sizeof(*packet));
+            packet->CrcError = true;
+            packet->NeedAck  = (ctrl & LORA_CTRL_MASK_NEED_ACK) && !(ctrl & LORA_CTRL_MASK_TYPE);
+            packet->Format   = LORA_FRAME_FMT_V2;
+            packet->HdrCheck = true;
+            packet->SeqShort = short_seq;
+            packet->Sequence = seq;
+            packet->TargetID = target;
+            packet->SourceID = source;
+        }
+        return expected_len;
+    }
+
+    if (!_Protocol_Accept(target, local_id, group_id)) return expected_len;
+    int prefix = _Protocol_PiggyCheck(ctrl, &buffer[idx], p_len);
+    if (prefix < 0) return expected_len;
+
+    if (packet) {
+        packet->IsAckPacket = (ctrl & LORA_CTRL_MASK_TYPE);
+        packet->NeedAck     = (ctrl & LORA_CTRL_MASK_NEED_ACK);
+        packet->HasCrc      = true;
+        packet->IsFragment  = (ctrl & LORA_CTRL_MASK_FRAG);
+        packet->IsAggregate = (ctrl & LORA_CTRL_MASK_AGG);
+        packet->IsCompressed = (ctrl & LORA_CTRL_MASK_COMP);
+        packet->IsBlockAck  = (ctrl & LORA_CTRL_MASK_BLOCK);
+        packet->Format      = LORA_FRAME_FMT_V2;
+        packet->SeqShort    = short_seq;
+        packet->UseFec      = false;
+        packet->HdrCheck    = hdr_check;
+        packet->CrcError    = false;
+        packet->Sequence    = seq;
+        packet->TargetID    = target;
+        packet->SourceID    = source;
+        _Protocol_TakeBody(packet, &buffer[idx], p_len, prefix);
+    }
+    return expected_len;
+}
+
+static uint16_t _Protocol_UnpackPlain(const uint8_t *buffer, uint16_t length, LoRa_Packet_t *packet,
+                                      uint16_t local_id, uint16_t group_id, const uint16_t *crc)
+{
+    // [新增] 按首字节区分 V2 紧凑帧
+    if (length > 0 && (buffer[0] & LORA_PROTOCOL_V2_HEAD_MASK) == LORA_PROTOCOL_V2_HEAD) {
+        return _Protocol_UnpackV2(buffer, length, packet, local_id, group_id, crc);
+    }
+
     // [变更] 最小包长：Head(2) + Len(1) + Ctrl(1) + Seq(2) + Addr(4) + Tail(2) = 12字节
     if (length < 12) return 0;
     
@@ -141,7 +561,7 @@ uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer,
         // 校验范围：从 Len(buffer[2]) 开始，到 Payload 结束
         // 长度 = expected_len - Head(2) - CRC(2) - Tail(2) = expected_len - 6
         uint16_t calc_len = expected_len - 6;
-        uint16_t calc_crc = LoRa_CRC16_Calculate(&buffer[2], calc_len);
+        uint16_t calc_crc = crc ? *crc : LoRa_CRC16_Calculate(&buffer[2], calc_len);
         
         uint16_t recv_crc = (uint16_t)buffer[expected_len - 4] | 
                             ((uint16_t)buffer[expected_len - 3] << 8);
@@ -155,19 +575,27 @@ uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer,
     // TargetID 在 buffer[6], buffer[7]
     uint16_t target = (uint16_t)buffer[6] | ((uint16_t)buffer[7] << 8);
     
-    bool accept = (target == local_id) || 
-                  (target == 0xFFFF) || 
-                  (group_id != 0 && target == group_id);
-                  
-    if (!accept) {
+    if (!_Protocol_Accept(target, local_id, group_id)) {
         return expected_len; // 不是发给我的，丢弃
     }
+    if (p_len > LORA_MAX_PAYLOAD_LEN) return expected_len;
+    int prefix = _Protocol_PiggyCheck(ctrl, &buffer[10], p_len);
+    if (prefix < 0) return expected_len; // [新增] 捎带确认前缀非法，丢弃
     
     // 8. [变更] 填充输出结构体 (偏移量 +1)
     if (packet) {
         packet->IsAckPacket = (ctrl & LORA_CTRL_MASK_TYPE);
         packet->NeedAck     = (ctrl & LORA_CTRL_MASK_NEED_ACK);
         packet->HasCrc      = has_crc;
+        packet->IsFragment  = (ctrl & LORA_CTRL_MASK_FRAG);
+        packet->IsAggregate = (ctrl & LORA_CTRL_MASK_AGG);
+        packet->IsCompressed = (ctrl & LORA_CTRL_MASK_COMP);
+        packet->IsBlockAck  = (ctrl & LORA_CTRL_MASK_BLOCK);
+        packet->Format      = LORA_FRAME_FMT_V1;
+        packet->SeqShort    = false;
+        packet->UseFec      = false;
+        packet->HdrCheck    = false;
+        packet->CrcError    = false;
         
         // Seq: buffer[4], buffer[5]
         packet->Sequence    = (uint16_t)buffer[4] | ((uint16_t)buffer[5] << 8);
@@ -177,13 +605,341 @@ uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer,
         // SourceID: buffer[8], buffer[9]
         packet->SourceID    = (uint16_t)buffer[8] | ((uint16_t)buffer[9] << 8);
         
-        packet->PayloadLen  = p_len;
-        
-        // Payload: buffer[10] 开始
-        if (p_len > 0 && p_len <= LORA_MAX_PAYLOAD_LEN) {
-            memcpy(packet->Payload, &buffer[10], p_len);
-        }
+        // Payload: buffer[10] 开始 ([新增] 剥离捎带确认前缀)
+        _Protocol_TakeBody(packet, &buffer[10], p_len, prefix);
     }
     
     return expected_len;
 }
+
+/**
+ * @brief [新增] 解 FEC 帧：先纠正帧头得到内层帧长度，整帧到齐后逐码字纠错，再按普通帧解包
+ * @note  任何一步失败都只丢弃帧头字节重新同步 (内层帧若未损坏仍可被直接解出)
+ */
+static uint16_t _Protocol_UnpackFec(const uint8_t *buffer, uint16_t length, LoRa_Packet_t *packet,
+                                    uint16_t local_id, uint16_t group_id)
+{
+    static uint8_t s_FecWork[0xFF];
+    uint8_t hdr[LORA_PROTOCOL_FEC_HDR_LEN];
+
+    if (length < LORA_PROTOCOL_FEC_HDR_LEN) return 0;
+    memcpy(hdr, buffer, sizeof(hdr));
+    int fixed = LoRa_RS_Decode(hdr, sizeof(hdr), LORA_PROTOCOL_FEC_HDR_PARITY);
+    if (fixed < 0 || hdr[0] != LORA_PROTOCOL_FEC_HEAD || hdr[1] == 0) return 1;
+
+    uint16_t inner  = hdr[1];
+    uint16_t blocks = LORA_PROTOCOL_FEC_BLOCKS(inner);
+    uint16_t total  = LORA_PROTOCOL_FEC_HDR_LEN + inner + blocks * LORA_FEC_PARITY_LEN;
+    if (total > length) return 0;
+
+    const uint8_t *parity = &buffer[LORA_PROTOCOL_FEC_HDR_LEN + inner];
+    uint8_t cw[LORA_FEC_BLOCK_LEN + LORA_FEC_PARITY_LEN];
+    memcpy(s_FecWork, &buffer[LORA_PROTOCOL_FEC_HDR_LEN], inner);
+
+    for (uint16_t i = 0; i < blocks; i++) {
+        uint8_t k = 0;
+        for (uint16_t j = i; j < inner; j += blocks) cw[k++] = s_FecWork[j];
+        for (uint16_t p = 0; p < LORA_FEC_PARITY_LEN; p++) cw[k + p] = parity[p * blocks + i];
+
+        int n = LoRa_RS_Decode(cw, k + LORA_FEC_PARITY_LEN, LORA_FEC_PARITY_LEN);
+        if (n < 0) {
+            LORA_LOG("[PROTO] FEC Uncorrectable (Block %d)\r\n", i);
+            return 1;
+        }
+        fixed += n;
+        k = 0;
+        for (uint16_t j = i; j < inner; j += blocks) s_FecWork[j] = cw[k++];
+    }
+    if (fixed > 0) LORA_LOG("[PROTO] FEC Fixed %d Bytes\r\n", fixed);
+
+    // 内层帧必须恰好占满 Len，否则视为误纠
+    uint16_t used = _Protocol_UnpackPlain(s_FecWork, inner, packet, local_id, group_id, NULL);
+    if (used != inner) return 1;
+    if (packet) packet->UseFec = true;
+    return total;
+}
+
+static uint16_t _Protocol_UnpackAny(const uint8_t *buffer, uint16_t length, LoRa_Packet_t *packet,
+                                    uint16_t local_id, uint16_t group_id, const uint16_t *crc)
+{
+    // [新增] 按首字节区分 FEC 帧 (内层帧纠错后才能校验 CRC)
+    if (length > 0 && buffer[0] == LORA_PROTOCOL_FEC_HEAD) {
+        return _Protocol_UnpackFec(buffer, length, packet, local_id, group_id);
+    }
+    return _Protocol_UnpackPlain(buffer, length, packet, local_id, group_id, crc);
+}
+
+uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer, 
+                                      uint16_t length, 
+                                      LoRa_Packet_t *packet,
+                                      uint16_t local_id,
+                                      uint16_t group_id)
+{
+    return _Protocol_UnpackAny(buffer, length, packet, local_id, group_id, NULL);
+}
+
+// ============================================================
+//                    [新增] 流式解析 (Parser)
+// ============================================================
+
+#define PARSE_MORE  0   // 继续等待字节
+#define PARSE_BAD   1   // 不是帧：丢弃首字节重新同步
+#define PARSE_DONE  2   // 整帧到齐
+
+// 复位候选帧状态 (保留丢弃计数)
+static void _Parser_Clear(LoRa_Protocol_Parser_t *p) {
+    p->fill = 0;
+    p->scan = 0;
+    p->need = 0;
+    p->crc = 0;
+    p->crc_start = 0;
+    p->crc_end = 0;
+}
+
+void LoRa_Manager_Protocol_ParserReset(LoRa_Protocol_Parser_t *parser) {
+    if (!parser) return;
+    _Parser_Clear(parser);
+    parser->skipped = 0;
+}
+
+#define _PARSER_ONES    0x01010101u
+#define _PARSER_HIGHS   0x80808080u
+
+// 可能是帧头的字节：V1 'C'、V2 0xA8~0xAB、FEC 0xAC (字扫描放宽到 0xA8~0xAF，由此逐字节确认)
+static bool _Parser_IsHead(uint8_t b) {
+    return b == LORA_PROTOCOL_HEAD_0 || (b >= LORA_PROTOCOL_V2_HEAD && b <= LORA_PROTOCOL_FEC_HEAD);
+}
+
+/**
+ * @brief [新增] 找到第一个可能是帧头的字节
+ * @note  一次比较 4 字节 (SWAR)：字中含 'C' 或 0xA8~0xAF 时才逐字节确认，
+ *        噪声中的大段无关字节因此整字跳过。
+ * @return 该字节的下标 (n=没有)
+ */
+static uint16_t _Parser_ScanHead(const uint8_t *data, uint16_t n) {
+    uint16_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        uint32_t w;
+        memcpy(&w, &data[i], 4);
+        uint32_t c = w ^ (_PARSER_ONES * LORA_PROTOCOL_HEAD_0);        // 'C' 处为 0
+        uint32_t a = (w & (_PARSER_ONES * 0xF8)) ^ (_PARSER_ONES * 0xA8); // 0xA8~0xAF 处为 0
+        if (((c - _PARSER_ONES) & ~c & _PARSER_HIGHS) || ((a - _PARSER_ONES) & ~a & _PARSER_HIGHS)) break;
+    }
+    for (; i < n; i++) {
+        if (_Parser_IsHead(data[i])) return i;
+    }
+    return n;
+}
+
+// 确定 CRC 覆盖区间，并补算区间内已经推进过的字节 (至多几个帧头字节)
+static void _Parser_CrcRange(LoRa_Protocol_Parser_t *p, uint16_t start, uint16_t end, uint16_t upto) {
+    p->crc_start = start;
+    p->crc_end = end;
+    p->crc = 0;
+    for (uint16_t j = start; j <= upto && j < end; j++) p->crc = LoRa_CRC16_Update(p->crc, p->buf[j]);
+}
+
+// 丢弃前 n 个字节，余下的字节从头重新推进
+static void _Parser_Consume(LoRa_Protocol_Parser_t *p, uint16_t n) {
+    uint16_t rest = p->fill - n;
+    if (rest > 0) memmove(p->buf, &p->buf[n], rest);
+    _Parser_Clear(p);
+    p->fill = rest;
+}
+
+// [新增] 候选帧被否定：丢弃到下一个可能的帧头为止 (一次扫描，而不是逐字节重新推进)
+static void _Parser_Resync(LoRa_Protocol_Parser_t *p) {
+    uint16_t n = 1 + _Parser_ScanHead(&p->buf[1], p->fill - 1);
+    p->skipped += n;
+    _Parser_Consume(p, n);
+}
+
+// 推进第 i 个字节 (i == 已推进字节数)
+static uint8_t _Parser_Step(LoRa_Protocol_Parser_t *p, uint16_t i) {
+    const uint8_t *b = p->buf;
+    uint8_t head = b[0];
+
+    if (i >= p->crc_start && i < p->crc_end) p->crc = LoRa_CRC16_Update(p->crc, b[i]);
+
+    if (p->need == 0) {
+        if (head == LORA_PROTOCOL_FEC_HEAD) {
+            if (i + 1 < LORA_PROTOCOL_FEC_HDR_LEN) return PARSE_MORE;
+            uint8_t hdr[LORA_PROTOCOL_FEC_HDR_LEN];
+            memcpy(hdr, b, sizeof(hdr));
+            if (LoRa_RS_Decode(hdr, sizeof(hdr), LORA_PROTOCOL_FEC_HDR_PARITY) < 0 ||
+                hdr[0] != LORA_PROTOCOL_FEC_HEAD || hdr[1] == 0) return PARSE_BAD;
+            p->need = LORA_PROTOCOL_FEC_HDR_LEN + hdr[1] + LORA_PROTOCOL_FEC_BLOCKS(hdr[1]) * LORA_FEC_PARITY_LEN;
+        } else if ((head & LORA_PROTOCOL_V2_HEAD_MASK) == LORA_PROTOCOL_V2_HEAD) {
+            if (i < 2) return PARSE_MORE;
+            if (b[1] > LORA_MAX_PAYLOAD_LEN) return PARSE_BAD;
+            uint16_t body_end = _Protocol_V2HeaderLen(head, b[2]) + b[1];
+            p->need = body_end + 2;
+            _Parser_CrcRange(p, 0, body_end, i);
+        } else if (head == LORA_PROTOCOL_HEAD_0) {
+            if (i >= 1 && b[1] != LORA_PROTOCOL_HEAD_1) return PARSE_BAD;
+            if (i < 3) return PARSE_MORE;
+            bool has_crc = (b[3] & LORA_CTRL_MASK_HAS_CRC) != 0;
+            p->need = 10 + b[2] + (has_crc ? 2 : 0) + 2;
+            if (has_crc) _Parser_CrcRange(p, 2, p->need - 4, i);
+        } else {
+            return PARSE_BAD;
+        }
+        if (p->need > sizeof(p->buf)) return PARSE_BAD;
+    }
+
+    // V2 帧头校验：帧头一到齐即可判断，不符时不必等整帧
+    if ((head & LORA_PROTOCOL_V2_HEAD_MASK) == LORA_PROTOCOL_V2_HEAD && (head & LORA_PROTOCOL_V2_HDR_CHECK) &&
+        i + 1 == _Protocol_V2HeaderLen(head, b[2]) && _Protocol_HeaderCheck(b, i) != b[i]) {
+        return PARSE_BAD;
+    }
+    return (i + 1 == p->need) ? PARSE_DONE : PARSE_MORE;
+}
+
+void LoRa_Manager_Protocol_ParserResync(LoRa_Protocol_Parser_t *parser) {
+    if (!parser || parser->fill == 0) return;
+    _Parser_Resync(parser);
+}
+
+uint16_t LoRa_Manager_Protocol_ParserFeed(LoRa_Protocol_Parser_t *parser,
+                                          const uint8_t *data,
+                                          uint16_t length,
+                                          LoRa_Packet_t *packet,
+                                          uint16_t local_id,
+                                          uint16_t group_id,
+                                          bool *done)
+{
+    uint16_t used = 0;
+    *done = false;
+    if (!parser) return 0;
+
+    for (;;) {
+        while (parser->scan < parser->fill) {
+            uint8_t r = _Parser_Step(parser, parser->scan++);
+            if (r == PARSE_MORE) continue;
+            if (r == PARSE_DONE) {
+                const uint16_t *crc = (parser->crc_end > 0) ? &parser->crc : NULL;
+                uint16_t frame_len = parser->need;
+                if (_Protocol_UnpackAny(parser->buf, frame_len, packet, local_id, group_id, crc) == frame_len) {
+                    _Parser_Consume(parser, frame_len);
+                    *done = true;
+                    return used;
+                }
+            }
+            _Parser_Resync(parser);
+        }
+        if (!data || used >= length) return used;
+        if (parser->fill == 0) {
+            // [新增] 帧间/噪声：整段跳过不可能是帧头的字节
+            uint16_t n = _Parser_ScanHead(&data[used], length - used);
+            parser->skipped += n;
+            used += n;
+            if (used >= length) return used;
+        }
+        parser->buf[parser->fill++] = data[used++];
+    }
+}
+
+// ============================================================
+//                    3. 帧边界预览 (PeekFrame)
+// ============================================================
+
+static uint16_t _Protocol_PeekPlain(const uint8_t *buffer, uint16_t length, uint8_t tmode, LoRa_FrameInfo_t *info)
+{
+    uint16_t off = (tmode == 1) ? 3 : 0;
+
+    // [新增] V2 紧凑帧
+    if (buffer && length >= off + 3 && (buffer[off] & LORA_PROTOCOL_V2_HEAD_MASK) == LORA_PROTOCOL_V2_HEAD) {
+        uint8_t  head      = buffer[off];
+        uint8_t  ctrl      = buffer[off + 2];
+        uint16_t hdr_len   = _Protocol_V2HeaderLen(head, ctrl);
+        uint16_t frame_len = off + hdr_len + buffer[off + 1] + 2;
+        if (frame_len > length) return 0;
+
+        if (info) {
+            const uint8_t *p = &buffer[off + 3];
+            info->FrameLen = frame_len;
+            info->Ctrl     = ctrl;
+            info->SeqShort = _Protocol_IsSeqShort(ctrl);
+            info->Sequence = *p++;
+            if (!info->SeqShort) info->Sequence |= (uint16_t)(*p++) << 8;
+            if (head & LORA_PROTOCOL_V2_SHORT_ADDR) {
+                info->TargetID = (*p == 0xFF) ? LORA_ID_BROADCAST : *p;
+            } else {
+                info->TargetID = (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+            }
+        }
+        return frame_len;
+    }
+
+    // 前缀 + 基础头 (10) + 包尾 (2)
+    if (!buffer || length < off + 12) return 0;
+    if (buffer[off] != LORA_PROTOCOL_HEAD_0 || buffer[off + 1] != LORA_PROTOCOL_HEAD_1) return 0;
+
+    uint8_t  ctrl      = buffer[off + 3];
+    uint16_t frame_len = off + 10 + buffer[off + 2] + ((ctrl & LORA_CTRL_MASK_HAS_CRC) ? 2 : 0) + 2;
+    if (frame_len > length) return 0;
+
+    if (info) {
+        info->FrameLen = frame_len;
+        info->Ctrl     = ctrl;
+        info->SeqShort = false;
+        info->Sequence = (uint16_t)buffer[off + 4] | ((uint16_t)buffer[off + 5] << 8);
+        info->TargetID = (uint16_t)buffer[off + 6] | ((uint16_t)buffer[off + 7] << 8);
+    }
+    return frame_len;
+}
+
+uint16_t LoRa_Manager_Protocol_PeekFrame(const uint8_t *buffer,
+                                         uint16_t length,
+                                         uint8_t tmode,
+                                         LoRa_FrameInfo_t *info)
+{
+    uint16_t off = (tmode == 1) ? 3 : 0;
+
+    // [新增] FEC 帧：内层帧紧跟在 FEC 帧头之后，帧头信息取自内层帧
+    if (buffer && length >= off + LORA_PROTOCOL_FEC_HDR_LEN && buffer[off] == LORA_PROTOCOL_FEC_HEAD) {
+        uint16_t inner     = buffer[off + 1];
+        uint16_t frame_len = off + LORA_PROTOCOL_FEC_HDR_LEN + inner + LORA_PROTOCOL_FEC_BLOCKS(inner) * LORA_FEC_PARITY_LEN;
+        if (frame_len > length) return 0;
+        if (_Protocol_PeekPlain(&buffer[off + LORA_PROTOCOL_FEC_HDR_LEN], inner, 0, info) != inner) return 0;
+        if (info) info->FrameLen = frame_len;
+        return frame_len;
+    }
+    return _Protocol_PeekPlain(buffer, length, tmode, info);
+}
+
+// ============================================================
+//                    4. 空中时间估算
+// ============================================================
+
+// 空速 -> 扩频因子 / 带宽 (kHz)
+static const struct {
+    uint8_t  sf;
+    uint16_t bw_khz;
+} s_AirRateParam[] = {
+    { 12, 125 },    // LORA_RATE_0K3
+    { 11, 250 },    // LORA_RATE_1K2
+    { 11, 500 },    // LORA_RATE_2K4
+    { 10, 500 },    // LORA_RATE_4K8
+    {  9, 500 },    // LORA_RATE_9K6
+    {  7, 500 },    // LORA_RATE_19K2
+};
+
+uint32_t LoRa_Manager_Protocol_AirTimeUs(uint8_t air_rate, uint16_t air_len)
+{
+    if (air_rate >= sizeof(s_AirRateParam) / sizeof(s_AirRateParam[0])) air_rate = LORA_RATE_19K2;
+
+    uint32_t sf    = s_AirRateParam[air_rate].sf;
+    uint32_t t_sym = ((uint32_t)1000 << sf) / s_AirRateParam[air_rate].bw_khz;  // 符号时间 (us)
+    uint32_t de    = (t_sym > 16000) ? 1 : 0;                                 // 低速率优化
+
+    // 负载符号数 = 8 + ceil((8*PL - 4*SF + 28 + 16) / (4*(SF - 2*DE))) * (CR + 4)
+    int32_t  num   = 8 * (int32_t)air_len - 4 * (int32_t)sf + 44;
+    uint32_t den   = 4 * (sf - 2 * de);
+    uint32_t n_sym = 8;
+    if (num > 0) n_sym += (((uint32_t)num + den - 1) / den) * 5;
+
+    // 前导码 8 + 4.25 个符号
+    return (49 * t_sym) / 4 + n_sym * t_sym;
+}
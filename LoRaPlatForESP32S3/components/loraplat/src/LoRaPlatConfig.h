@@ -53,9 +53,13 @@
  * @brief  Port 层 DMA 接收缓冲区大小 (Bytes)
  * @note   这是硬件层的原始接收缓冲。必须大于最大的预期单次突发数据包长度。
  *         建议值：512 或 1024。
- * @used_in lora_port_stm32f10x.c (s_DmaRxBuf)
+ *         [变更] Manager 直接在此缓冲上原地解析，不再有软件 RX 队列 (原 MGR_RX_BUF_SIZE)，
+ *         Run 调用间隔较长时需相应增大。
+ *         [变更] 512 -> 1024：并入原 MGR_RX_BUF_SIZE 的 512 字节，最坏情况下的接收缓冲量不变。
+ *         消费不及时导致 DMA 覆盖未读数据时，未读数据整体丢弃并重新同步 (LoRa_Port_CheckAndClearRxOverrun)。
+ * @used_in lora_port_stm32f10x.c (s_DmaRxBuf), lora_port_posix.c / lora_port_esp32.c (接收暂存区)
  */
-#define LORA_PORT_DMA_RX_SIZE   512
+#define LORA_PORT_DMA_RX_SIZE   1024
 
 /**
  * @brief  Port 层 DMA 发送缓冲区大小 (Bytes)
@@ -86,25 +90,68 @@
  */
 #define LORA_ENABLE_CRC         true
 
+/**
+ * @brief  [新增] V2 紧凑帧开关
+ * @note   true:  在 ACK 中声明支持 V2，并对声明过支持的对端改用 V2 紧凑帧
+ *                (1 字节帧头、无包尾、短地址、确认帧与 ACK 用 8 位序号，
+ *                 帧头开销 14 -> 8 字节)。广播、组播及未协商的对端仍用 V1。
+ *         false: 只发送 V1 帧。
+ *         两种格式始终都能接收，新旧设备可以混合组网。
+ * @used_in lora_manager_protocol.c, lora_manager_fsm.c
+ */
+#ifndef LORA_FRAME_V2_ENABLE
+#define LORA_FRAME_V2_ENABLE    true
+#endif
+
+/**
+ * @brief  [新增] NACK 快速重传开关
+ * @note   true:  发往已协商 V2 的对端的确认帧带 1 字节帧头校验；接收方 CRC 失败但帧头校验
+ *                通过时 (源地址与序号可信)，回 NACK 让发送方立即重传，不必等待 ACK 超时。
+ *         false: 不带帧头校验，也不回 NACK (CRC 失败的帧静默丢弃)。
+ *         带帧头校验的帧始终都能接收。需要 LORA_FRAME_V2_ENABLE。
+ * @used_in lora_manager_protocol.c, lora_manager_fsm.c
+ */
+#ifndef LORA_NACK_ENABLE
+#define LORA_NACK_ENABLE        true
+#endif
+
+/**
+ * @brief  [新增] 每次 Run 最多处理的接收帧数
+ * @note   一次 Run 依次解析并处理缓冲区中所有完整的帧 (突发的多帧、同时到达的 ACK 与数据
+ *         不必等多个主循环)，达到此上限时剩余的帧留给下一次 Run (此时不休眠)，
+ *         保证单次 Run 的耗时有界。
+ * @used_in lora_manager.c
+ */
+#ifndef LORA_RX_FRAMES_PER_RUN
+#define LORA_RX_FRAMES_PER_RUN  8
+#endif
+
+/**
+ * @brief  [新增] 接收半帧的空闲重新同步时间 (ms)
+ * @note   解析器缓存着未完成的候选帧、且超过此时间没有新字节到达时，判定候选帧为噪声：
+ *         丢弃其帧头并重新扫描已缓存的字节。避免一个形似帧头的噪声字节 (如 0xA8~0xAB 后跟
+ *         合理的长度) 把紧随其后的真实帧扣在缓冲区里，直到后续字节凑满其声明的长度。
+ *         须大于模组串口输出一帧时的字节间隔；模组分包输出且空中速率很低时应适当调大。
+ * @used_in lora_manager_buffer.c, lora_manager.c
+ */
+#ifndef LORA_RX_IDLE_RESYNC_MS
+#define LORA_RX_IDLE_RESYNC_MS  50
+#endif
+
 /**
  * @brief  Manager 层发送队列大小 (Bytes)
- * @note   这是软件层的环形缓冲区 (RingBuffer)，用于缓存待发送的应用数据。
+ * @note   存放已封包、等待物理层发出的帧 (首发的数据帧)。
+ *         按帧记录存储：每帧占 帧长 + 2 字节长度头。
  *         若应用层发送频率高于 LoRa 空中速率，需增大此值。
  * @used_in lora_manager_buffer.c (s_TxBufArr)
  */
 #define MGR_TX_BUF_SIZE         512
 
-/**
- * @brief  Manager 层接收队列大小 (Bytes)
- * @note   这是软件层的环形缓冲区，用于缓存从 Port 层搬运上来的数据。
- * @used_in lora_manager_buffer.c (s_RxBufArr)
- */
-#define MGR_RX_BUF_SIZE         512
-
 /**
  * @brief  ACK 专用队列大小 (Bytes)
  * @note   ACK 包优先级最高，使用独立的小队列，防止被普通数据阻塞。
- *         64 字节通常足够存放 3-4 个 ACK 包。
+ *         按帧记录存储：每个 ACK 占 帧长 + 2 字节长度头 (V1 块确认约 16+2 字节，V2 更短)，
+ *         64 字节约可存放 3 个 ACK 包。
  * @used_in lora_manager_buffer.c (s_AckBufArr)
  */
 #define ACK_QUEUE_SIZE          64
@@ -123,18 +170,31 @@
 #define LORA_TX_TIMEOUT_MS      1000
 
 /**
- * @brief  ACK 回复延时 (ms)
+ * @brief  [变更] ACK 回复延时上限 (ms)
  * @note   接收方收到数据后，等待多久再回复 ACK。
- *         用于给发送方预留“收发切换”的时间 (半双工特性)。
+ *         用于给发送方预留“收发切换”的时间 (半双工特性)，并合并一批帧的确认。
+ *         现按对端自适应：从本值起步，对端按序推进时逐步缩短到 LORA_ACK_DELAY_MIN_MS，
+ *         对端重发已确认的帧 (ACK 未被收到) 时加倍；计时从 AUX 下降沿 (接收输出完毕) 开始。
+ *         发送方按实测的对端延时避让 ACK 时段、计算重传超时下限。
  *         建议值：50~200ms。
  * @used_in lora_manager_fsm.c
  */
 #define LORA_ACK_DELAY_MS       100
 
 /**
- * @brief  等待 ACK 超时时间 (ms)
- * @note   发送方发出数据后，等待 ACK 的最长耐心时间。
- *         超时后将触发重传。
+ * @brief  [新增] ACK 回复延时下限 (ms)
+ * @note   模组发射完毕 (AUX 下降沿) 到可以接收所需的切换时间，外加调度余量。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_ACK_DELAY_MIN_MS
+#define LORA_ACK_DELAY_MIN_MS   10
+#endif
+
+/**
+ * @brief  [变更] 初始重传超时 (ms)
+ * @note   尚未测得对端往返时间 (RTT) 时使用的重传超时。
+ *         测得 RTT 后改用自适应超时 RTO = SRTT + 4 x RTTVAR，
+ *         且不会低于本帧与 ACK 的空中时间之和 (低空速下大于此值)。
  * @used_in lora_manager_fsm.c
  */
 #define LORA_ACK_TIMEOUT_MS     2000
@@ -147,11 +207,23 @@
 #define LORA_MAX_RETRY          3
 
 /**
- * @brief  重传基础间隔时间 (ms)
- * @note   重传时的基础退避时间。实际间隔 = Base + (RetryCount * 500) + Random(0~500)。
+ * @brief  [新增] 自适应重传超时下限 (ms)
+ * @note   RTT 估计值很小时 (高空速短帧) 防止过早重传。
  * @used_in lora_manager_fsm.c
  */
-#define LORA_RETRY_INTERVAL_MS  1500
+#ifndef LORA_RTO_MIN_MS
+#define LORA_RTO_MIN_MS         200
+#endif
+
+/**
+ * @brief  [新增] 自适应重传超时上限 (ms)
+ * @note   每次重传超时翻倍 (指数退避)，到此值封顶。
+ *         空中时间下限高于此值时以空中时间为准。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_RTO_MAX_MS
+#define LORA_RTO_MAX_MS         16000
+#endif
 
 /**
  * @brief  接收去重表大小 (条目数)
@@ -182,6 +254,169 @@
  */
 #define LORA_BROADCAST_INTERVAL 50
 
+/**
+ * @brief  [新增] 选择重传 (Selective Repeat) 发送窗口大小 (帧)
+ * @note   允许同时在途 (已发出、等待 ACK) 的确认帧数量，每帧独立计时重传。
+ *         接收方按序号缓存乱序帧，按序交付 ([变更] 仅对声明了 LORA_PROTOCOL_CAP_EXT 或发来过 V2 帧的对端；
+ *         旧版对端的确认帧去重后立即交付)。
+ *         1: 退化为停等协议 (与旧版行为一致)。
+ *         此值为每个目标的窗口，接收乱序缓存占 (窗口-1) x 216 字节 RAM。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_ARQ_WINDOW_SIZE
+#define LORA_ARQ_WINDOW_SIZE    4
+#endif
+
+/**
+ * @brief  [新增] 发送窗口槽总数 (所有目标共享)
+ * @note   单个目标最多占用 LORA_ARQ_WINDOW_SIZE 个槽，多出的槽保证某个目标
+ *         不可达 (重传退避中) 时，发往其他目标的流量仍能进入窗口。
+ *         每个槽约占 220 字节 RAM。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_ARQ_TX_SLOTS
+#define LORA_ARQ_TX_SLOTS       (LORA_ARQ_WINDOW_SIZE + 2)
+#endif
+
+/**
+ * @brief  [新增] ARQ 对端会话表大小 (条目数)
+ * @note   发送方为每个目标维护独立会话 (序号、在途帧、退避状态)，
+ *         接收方为每个源维护接收窗口。采用 LRU 策略淘汰。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_ARQ_PEER_MAX
+#define LORA_ARQ_PEER_MAX       4
+#endif
+
+/**
+ * @brief  [新增] 乱序等待超时 (ms)
+ * @note   接收方缓存了后续帧、但缺口帧迟迟未到 (发送方已放弃重传) 时，
+ *         超过此时间跳过缺口，交付已缓存的帧。应大于发送方的完整重传周期。
+ * @used_in lora_manager_fsm.c
+ */
+#ifndef LORA_ARQ_REORDER_TIMEOUT_MS
+#define LORA_ARQ_REORDER_TIMEOUT_MS  12000
+#endif
+
+/**
+ * @brief  [新增] 分片消息最大长度 (Bytes)
+ * @note   超过 LORA_MAX_PAYLOAD_LEN 的消息由链路层自动分片发送、接收端重组。
+ *         发送端与每个重组缓冲区各占用此大小的 RAM。
+ *         上限为 128 x LORA_FRAG_CHUNK_LEN (约 25KB)。
+ * @used_in lora_manager_frag.c, lora_manager.c
+ */
+#ifndef LORA_FRAG_MAX_MSG_LEN
+#define LORA_FRAG_MAX_MSG_LEN   2048
+#endif
+
+/**
+ * @brief  [新增] 每个分片携带的消息字节数
+ * @note   分片负载 = 2 字节分片头 + 本值，加密后不得超过 LORA_MAX_PAYLOAD_LEN，
+ *         注册了会扩展长度的 Cipher 时需相应减小。收发双方必须一致。
+ * @used_in lora_manager_frag.c
+ */
+#ifndef LORA_FRAG_CHUNK_LEN
+#define LORA_FRAG_CHUNK_LEN     (LORA_MAX_PAYLOAD_LEN - 2)
+#endif
+
+/**
+ * @brief  [新增] 接收重组缓冲区数量
+ * @note   可同时重组的源的数量。缓冲区全被占用时，新源的分片不予确认
+ *         (发送方稍后重传)，而不是确认后丢弃。
+ * @used_in lora_manager_frag.c
+ */
+#ifndef LORA_FRAG_RX_SLOTS
+#define LORA_FRAG_RX_SLOTS      1
+#endif
+
+/**
+ * @brief  [新增] 重组超时 (ms)
+ * @note   超过此时间未收到新分片，丢弃未完成的消息并释放缓冲区。
+ * @used_in lora_manager_frag.c
+ */
+#ifndef LORA_FRAG_RX_TIMEOUT_MS
+#define LORA_FRAG_RX_TIMEOUT_MS 30000
+#endif
+
+/**
+ * @brief  [新增] 小消息聚合开关
+ * @note   true: 发送队列中同一目标、同一发送选项的多条消息合并为一个空中帧
+ *         (负载为多条 [1字节长度][子消息])，只占一个帧头、一次 ACK；
+ *         接收端拆分后逐条回调。单条消息仍按普通帧发送。
+ *         只对已声明支持扩展负载 (LORA_PROTOCOL_CAP_EXT 或 V2) 的单播目标聚合。
+ *         本开关只影响发送，接收端始终能拆分聚合帧。
+ * @used_in lora_manager.c
+ */
+#ifndef LORA_AGG_ENABLE
+#define LORA_AGG_ENABLE         true
+#endif
+
+/**
+ * @brief  [新增] 聚合等待上限 (ms)
+ * @note   Nagle 规则：目标已有未结束的帧时，小消息暂留队列等待与后续消息合并，
+ *         直到该目标的在途帧全部结束、可合并内容装满一帧、队列已满，
+ *         或等待超过本值。目标空闲时立即发送，不增加时延。0=不等待，
+ *         只合并队列中已积压的消息。
+ * @used_in lora_manager.c
+ */
+#ifndef LORA_AGG_HOLD_MS
+#define LORA_AGG_HOLD_MS        200
+#endif
+
+/**
+ * @brief  [新增] 负载压缩开关
+ * @note   true: 单帧消息在加密前做 LZSS 压缩 (256 字节窗口，无堆内存)，
+ *         压缩后变短才使用压缩结果并在控制字中置 LORA_CTRL_MASK_COMP，
+ *         否则按原文发送。JSON/ASCII 文本通常可压缩到 1/2 ~ 1/4。
+ *         只对已声明支持扩展负载 (LORA_PROTOCOL_CAP_EXT 或 V2) 的单播目标压缩；
+ *         分片消息不压缩。本开关只影响发送，接收端始终能解压。
+ * @used_in lora_manager.c
+ */
+#ifndef LORA_COMPRESS_ENABLE
+#define LORA_COMPRESS_ENABLE    true
+#endif
+
+/**
+ * @brief  [新增] 参与压缩的最短消息长度 (字节)
+ * @note   更短的消息压缩收益很小，直接按原文发送以节省 CPU。
+ * @used_in lora_manager.c
+ */
+#ifndef LORA_COMPRESS_MIN_LEN
+#define LORA_COMPRESS_MIN_LEN   16
+#endif
+
+/**
+ * @brief  [新增] 前向纠错 (FEC) 开关
+ * @note   true: 按消息 (LoRa_SendOpt_t.UseFec) 或按链路 (LoRa_Manager_SetLinkFec，
+ *         或对端发来 FEC 帧时自动对称使用) 以 FEC 帧发送：整帧按 LORA_FEC_BLOCK_LEN
+ *         分块，每块附加 LORA_FEC_PARITY_LEN 字节 Reed-Solomon 校验并交织排列，
+ *         少量误码 (含短突发) 可在接收端直接修复，不必整帧重传。
+ *         false: 只发送普通帧。本开关只影响发送，接收端始终能解 FEC 帧。
+ * @used_in lora_manager_protocol.c
+ */
+#ifndef LORA_FEC_ENABLE
+#define LORA_FEC_ENABLE         true
+#endif
+
+/**
+ * @brief  [新增] FEC 每个码字的校验字节数
+ * @note   每个码字可纠正本值/2 个字节错误。必须为偶数且不超过 16，收发双方必须一致。
+ * @used_in lora_manager_protocol.c
+ */
+#ifndef LORA_FEC_PARITY_LEN
+#define LORA_FEC_PARITY_LEN     8
+#endif
+
+/**
+ * @brief  [新增] FEC 每个码字承载的最大帧字节数
+ * @note   越小纠错能力越强、开销越大：满负载帧 (214 字节) 按 64 分为 4 块，
+ *         共 32 字节校验，最多纠正 16 个 (每块 4 个) 字节错误。收发双方必须一致。
+ * @used_in lora_manager_protocol.c
+ */
+#ifndef LORA_FEC_BLOCK_LEN
+#define LORA_FEC_BLOCK_LEN      64
+#endif
+
 /**
  * @brief  去重记录有效期 (ms)
  * @note   超过此时间的去重记录将被视为过期，可以被新包覆盖。
@@ -255,6 +490,7 @@ typedef uint16_t LoRa_MsgID_t;
 /** @brief 发送选项结构体 */
 typedef struct {
     bool NeedAck; /*!< true=需要ACK(可靠), false=不需要(不可靠) */
+    bool UseFec;  /*!< [新增] true=以 FEC 帧发送 (可纠正少量误码，需 LORA_FEC_ENABLE) */
 } LoRa_SendOpt_t;
 
 /** @brief 空中速率枚举 */
@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file    lora_bench_counter.h
+  * @author  LoRaPlat Team
+  * @brief   微基准测试的周期计数器挂钩 (Cycle Counter Hook)
+  *          同一套测试用例在不同平台上只需更换计数器实现：
+  *            - LORA_BENCH_COUNTER_DWT   : Cortex-M3/M4 DWT->CYCCNT (STM32)
+  *            - LORA_BENCH_COUNTER_ESP32 : Xtensa CCOUNT (ESP32-S3)
+  *            - 默认 (主机)              : x86 TSC，其余架构退化为 CLOCK_MONOTONIC 纳秒
+  *          也可以自行填写 LoRa_BenchCounter_t 传给 LoRa_BenchMicro_Run。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_BENCH_COUNTER_H
+#define __LORA_BENCH_COUNTER_H
+
+#include <stdint.h>
+
+/**
+ * @brief 周期计数器接口
+ * @note  Read 返回 32 位自由运行计数值，调用方只取差值，回绕无影响；
+ *        单次测量区间必须小于一次回绕 (72MHz 下约 59 秒)。
+ */
+typedef struct {
+    const char *Name;
+    void       (*Init)(void);           /*!< 使能计数器 (可为 NULL) */
+    uint32_t   (*Read)(void);           /*!< 读取当前计数 */
+    uint64_t   (*GetHz)(void);          /*!< 计数频率，用于换算纳秒 (Init 之后调用) */
+} LoRa_BenchCounter_t;
+
+// ============================================================
+//                    1. Cortex-M DWT
+// ============================================================
+#if defined(LORA_BENCH_COUNTER_DWT)
+
+#define LORA_BENCH_DEMCR        (*(volatile uint32_t *)0xE000EDFCu)
+#define LORA_BENCH_DWT_CTRL     (*(volatile uint32_t *)0xE0001000u)
+#define LORA_BENCH_DWT_CYCCNT   (*(volatile uint32_t *)0xE0001004u)
+
+extern uint32_t SystemCoreClock;
+
+static void _BenchCounter_Init(void) {
+    LORA_BENCH_DEMCR |= (1u << 24);     // TRCENA
+    LORA_BENCH_DWT_CYCCNT = 0;
+    LORA_BENCH_DWT_CTRL |= 1u;          // CYCCNTENA
+}
+static uint32_t _BenchCounter_Read(void) { return LORA_BENCH_DWT_CYCCNT; }
+static uint64_t _BenchCounter_GetHz(void) { return SystemCoreClock; }
+
+#define LORA_BENCH_COUNTER_NAME "dwt"
+
+// ============================================================
+//                    2. ESP32 CCOUNT
+// ============================================================
+#elif defined(LORA_BENCH_COUNTER_ESP32)
+
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+
+// 基准期间请关闭动态调频，否则 CCOUNT 频率会变化
+static void _BenchCounter_Init(void) { }
+static uint32_t _BenchCounter_Read(void) { return (uint32_t)esp_cpu_get_cycle_count(); }
+static uint64_t _BenchCounter_GetHz(void) { return (uint64_t)CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000ULL; }
+
+#define LORA_BENCH_COUNTER_NAME "ccount"
+
+// ============================================================
+//                    3. 主机 (POSIX)
+// ============================================================
+#else
+
+#include <time.h>
+
+static uint64_t _BenchCounter_MonoNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+
+static uint64_t s_BenchTscHz = 0;
+
+// TSC 为恒定频率计数，与单调时钟对比 50ms 标定频率
+static void _BenchCounter_Init(void) {
+    uint64_t t0 = _BenchCounter_MonoNs();
+    uint64_t c0 = __rdtsc();
+    while (_BenchCounter_MonoNs() - t0 < 50000000ULL) { }
+    uint64_t c1 = __rdtsc();
+    uint64_t t1 = _BenchCounter_MonoNs();
+    s_BenchTscHz = (c1 - c0) * 1000000000ULL / (t1 - t0);
+}
+static uint32_t _BenchCounter_Read(void) { return (uint32_t)__rdtsc(); }
+static uint64_t _BenchCounter_GetHz(void) { return s_BenchTscHz; }
+
+#define LORA_BENCH_COUNTER_NAME "tsc"
+
+#else
+
+// 无可用周期计数器：以纳秒计数，cycles 列即为 ns
+static void _BenchCounter_Init(void) { }
+static uint32_t _BenchCounter_Read(void) { return (uint32_t)_BenchCounter_MonoNs(); }
+static uint64_t _BenchCounter_GetHz(void) { return 1000000000ULL; }
+
+#define LORA_BENCH_COUNTER_NAME "monotonic-ns"
+
+#endif
+#endif
+
+/**
+ * @brief 当前平台的默认计数器 (由上面的编译开关选择)
+ */
+static const LoRa_BenchCounter_t g_LoRaBenchCounterDefault = {
+    .Name  = LORA_BENCH_COUNTER_NAME,
+    .Init  = _BenchCounter_Init,
+    .Read  = _BenchCounter_Read,
+    .GetHz = _BenchCounter_GetHz,
+};
+
+#endif // __LORA_BENCH_COUNTER_H
@@ -0,0 +1,372 @@
+/**
+  ******************************************************************************
+  * @file    lora_bench_link.c
+  * @author  LoRaPlat Team
+  * @brief   端到端链路基准测试 (基于虚拟时间仿真器)
+  *          两个仿真节点 (发送端 -> 接收端)，遍历 空速 x 负载长度 x 确认模式
+  *          x 丢包率，每个用例通过 LoRa_Service_Send 发送固定条数消息，统计：
+  *            - goodput_bps      : 接收端应用层收到的有效负载速率
+  *            - lat_p50/p99_ms   : Send -> LORA_EVENT_TX_SUCCESS_ID 时延
+  *            - retries_per_msg  : 发送端重传的数据帧数 / 消息数 (同一目标、同一序号再次发射)
+  *            - unfinished       : 用例结束时仍未出结果的消息数 (未发出或未确认)
+  *            - overhead_ratio   : 双向空中总字节 / 有效负载字节
+  *            - airtime_eff      : 理想空中时间 (已提交消息的原始负载各占一帧) / 双向实际空中时间
+  *          结果输出为 CSV (及可选 JSON Lines)，便于对比 FSM/编解码改动。
+  *          -b 改为误码率扫描：确认模式、无丢包，在各误码率下分别关闭/开启 FEC，
+  *          对比纠错开销与整帧重传的有效吞吐。
+  *          负载默认为伪随机字节 (不可压缩，结果不受负载压缩影响)；-c 改用可压缩的 ASCII 文本。
+  *
+  *          用法: lora_bench_link [-m msgs] [-w inflight] [-s seed] [-o out.csv]
+  *                                [-j out.jsonl] [-L node_lib] [-r rates] [-q] [-b] [-c]
+  ******************************************************************************
+  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "lora_sim.h"
+
+#define BENCH_SENDER        0
+#define BENCH_RECEIVER      1
+#define BENCH_MAX_MSGS      1024
+#define BENCH_CASE_LIMIT_S  3600        /*!< 单个用例的仿真时间上限 */
+
+static const uint16_t s_PayloadSizes[] = { 1, 16, 64, 128, LORA_MAX_PAYLOAD_LEN };
+static const double   s_LossRates[]    = { 0.0, 0.1, 0.3 };
+static const double   s_BitErrorRates[] = { 0.0, 1e-4, 3e-4, 1e-3, 2e-3 };
+
+// ============================================================
+//                    1. 用例状态
+// ============================================================
+
+typedef struct {
+    LoRa_MsgID_t id;
+    uint64_t     t_send_us;
+    bool         done;
+} BenchMsg_t;
+
+typedef struct {
+    BenchMsg_t msgs[BENCH_MAX_MSGS];
+    int        count;              /*!< 已入队条数 */
+    int        completed;          /*!< 已出结果条数 (成功 + 失败) */
+    int        ok;
+    int        failed;
+    uint32_t   rx_msgs;            /*!< 接收端应用层收到条数 */
+    uint64_t   rx_bytes;
+    uint64_t   t_last_us;          /*!< 最后一条消息出结果的时刻 */
+    uint64_t   t_last_rx_us;       /*!< 接收端最后一次收到数据的时刻 */
+    double     lat_ms[BENCH_MAX_MSGS];
+    int        lat_count;
+    LoRa_Sim_t *sim;
+} BenchCase_t;
+
+typedef struct {
+    int      air_rate;
+    uint16_t payload;
+    bool     confirmed;
+    double   loss;
+    bool     fec;
+    double   ber;
+    int      msgs;
+    int      ok;
+    int      failed;
+    int      unfinished;
+    uint32_t rx_msgs;
+    double   goodput_bps;
+    double   lat_p50_ms;
+    double   lat_p99_ms;
+    double   retries_per_msg;
+    double   overhead_ratio;
+    double   airtime_eff;
+    double   sim_s;
+} BenchResult_t;
+
+static BenchCase_t s_Case;
+
+// ============================================================
+//                    2. 回调
+// ============================================================
+
+static void Bench_OnRecv(void *user, int node, uint16_t src_id, const uint8_t *data, uint16_t len) {
+    (void)user; (void)src_id; (void)data;
+    if (node != BENCH_RECEIVER) return;
+    s_Case.rx_msgs++;
+    s_Case.rx_bytes += len;
+    s_Case.t_last_rx_us = LoRa_Sim_NowUs(s_Case.sim);
+}
+
+static void Bench_OnEvent(void *user, int node, LoRa_Event_t event, void *arg) {
+    (void)user;
+    if (node != BENCH_SENDER) return;
+    if (event != LORA_EVENT_TX_SUCCESS_ID && event != LORA_EVENT_TX_FAILED_ID) return;
+
+    LoRa_MsgID_t id = *(LoRa_MsgID_t *)arg;
+    for (int i = 0; i < s_Case.count; i++) {
+        BenchMsg_t *m = &s_Case.msgs[i];
+        if (m->done || m->id != id) continue;
+
+        uint64_t now = LoRa_Sim_NowUs(s_Case.sim);
+        m->done = true;
+        s_Case.completed++;
+        s_Case.t_last_us = now;
+        if (event == LORA_EVENT_TX_SUCCESS_ID) {
+            s_Case.ok++;
+            s_Case.lat_ms[s_Case.lat_count++] = (now - m->t_send_us) / 1000.0;
+        } else {
+            s_Case.failed++;
+        }
+        break;
+    }
+}
+
+// ============================================================
+//                    3. 单个用例
+// ============================================================
+
+static int _CmpDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// 最近秩百分位
+static double _Percentile(double *v, int n, double p) {
+    if (n == 0) return 0.0;
+    int rank = (int)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return v[rank - 1];
+}
+
+// 填充负载：伪随机字节 (xorshift32，按种子可复现) 或可压缩的 ASCII 文本
+static void _FillPayload(uint8_t *data, uint16_t len, uint32_t seed, bool compressible) {
+    uint32_t x = seed ? seed : 1;
+    for (uint16_t i = 0; i < len; i++) {
+        if (compressible) {
+            data[i] = (uint8_t)('A' + i % 26);
+            continue;
+        }
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        data[i] = (uint8_t)(x >> 24);
+    }
+}
+
+static bool _RunCase(const LoRa_SimConfig_t *base_cfg, int air_rate, uint16_t payload, bool confirmed,
+                     double loss, bool fec, double ber, bool compressible, int msgs, int inflight, BenchResult_t *res) {
+    LoRa_SimAppCb_t cb = { .OnRecv = Bench_OnRecv, .OnEvent = Bench_OnEvent, .user = NULL };
+    memset(&s_Case, 0, sizeof(s_Case));
+
+    LoRa_Sim_t *sim = LoRa_Sim_Create(base_cfg, &cb);
+    if (!sim) return false;
+    s_Case.sim = sim;
+
+    for (int i = 0; i < 2; i++) {
+        LoRa_SimNodeConfig_t nc;
+        LoRa_Sim_DefaultNodeConfig(&nc, (uint16_t)(i + 1));
+        nc.air_rate = (uint8_t)air_rate;
+        nc.x_m = 100.0 * i;
+        if (LoRa_Sim_AddNode(sim, &nc) < 0) {
+            LoRa_Sim_Destroy(sim);
+            return false;
+        }
+    }
+    LoRa_Sim_SetLinkLoss(sim, BENCH_SENDER, BENCH_RECEIVER, loss);
+    LoRa_Sim_SetLinkLoss(sim, BENCH_RECEIVER, BENCH_SENDER, loss);
+    LoRa_Sim_SetLinkBer(sim, BENCH_SENDER, BENCH_RECEIVER, ber);
+    LoRa_Sim_SetLinkBer(sim, BENCH_RECEIVER, BENCH_SENDER, ber);
+
+    // 让初始化残留的事件跑完，统计从干净状态开始
+    LoRa_Sim_RunFor(sim, 100);
+    LoRa_SimNodeStats_t st0[2];
+    LoRa_Sim_GetNodeStats(sim, BENCH_SENDER, &st0[0]);
+    LoRa_Sim_GetNodeStats(sim, BENCH_RECEIVER, &st0[1]);
+
+    uint8_t data[LORA_MAX_PAYLOAD_LEN];
+    _FillPayload(data, payload, base_cfg->seed, compressible);
+
+    LoRa_SendOpt_t opt = confirmed ? LORA_OPT_CONFIRMED : LORA_OPT_UNCONFIRMED;
+    opt.UseFec = fec;
+    uint64_t t_start = LoRa_Sim_NowUs(sim);
+    uint64_t t_limit = t_start + (uint64_t)BENCH_CASE_LIMIT_S * 1000000ULL;
+
+    // 闭环负载：保持最多 inflight 条消息未出结果
+    while (s_Case.completed < msgs && LoRa_Sim_NowUs(sim) < t_limit) {
+        while (s_Case.count < msgs && (s_Case.count - s_Case.completed) < inflight) {
+            LoRa_MsgID_t id = LoRa_Sim_Send(sim, BENCH_SENDER, data, payload, BENCH_RECEIVER + 1, opt);
+            if (id == 0) break; // 队列满，等待
+            BenchMsg_t *m = &s_Case.msgs[s_Case.count++];
+            m->id = id;
+            m->t_send_us = LoRa_Sim_NowUs(sim);
+            m->done = false;
+        }
+        LoRa_Sim_RunFor(sim, 5);
+    }
+    // 收尾：等待接收端最后的 ACK/输出完成
+    LoRa_Sim_RunFor(sim, 3000);
+
+    LoRa_SimNodeStats_t st[2];
+    LoRa_Sim_GetNodeStats(sim, BENCH_SENDER, &st[0]);
+    LoRa_Sim_GetNodeStats(sim, BENCH_RECEIVER, &st[1]);
+
+    // 非确认模式的 TX_SUCCESS 在串口发完即触发，结束时刻取 "最后结果" 与 "最后接收" 的较晚者
+    uint64_t t_end = (s_Case.t_last_rx_us > s_Case.t_last_us) ? s_Case.t_last_rx_us : s_Case.t_last_us;
+    if (t_end <= t_start) t_end = LoRa_Sim_NowUs(sim);
+    double elapsed_s = (t_end - t_start) / 1e6;
+    uint32_t sender_retx = st[0].frames_retx - st0[0].frames_retx;
+    uint64_t air_bytes = (st[0].bytes_tx - st0[0].bytes_tx) + (st[1].bytes_tx - st0[1].bytes_tx);
+    uint64_t air_us = (st[0].airtime_us - st0[0].airtime_us) + (st[1].airtime_us - st0[1].airtime_us);
+    double ideal_us = (double)s_Case.count * LoRa_Sim_TimeOnAirUs((uint8_t)air_rate, payload);
+
+    qsort(s_Case.lat_ms, (size_t)s_Case.lat_count, sizeof(double), _CmpDouble);
+
+    memset(res, 0, sizeof(*res));
+    res->air_rate        = air_rate;
+    res->payload         = payload;
+    res->confirmed       = confirmed;
+    res->loss            = loss;
+    res->fec             = fec;
+    res->ber             = ber;
+    res->msgs            = s_Case.count;
+    res->ok              = s_Case.ok;
+    res->failed          = s_Case.failed;
+    res->unfinished      = msgs - s_Case.completed;
+    res->rx_msgs         = s_Case.rx_msgs;
+    res->goodput_bps     = (elapsed_s > 0) ? s_Case.rx_bytes * 8.0 / elapsed_s : 0.0;
+    res->lat_p50_ms      = _Percentile(s_Case.lat_ms, s_Case.lat_count, 0.50);
+    res->lat_p99_ms      = _Percentile(s_Case.lat_ms, s_Case.lat_count, 0.99);
+    res->retries_per_msg = s_Case.count ? (double)sender_retx / s_Case.count : 0.0;
+    res->overhead_ratio  = s_Case.rx_bytes ? (double)air_bytes / s_Case.rx_bytes : 0.0;
+    res->airtime_eff     = air_us ? ideal_us / air_us : 0.0;
+    res->sim_s           = elapsed_s;
+
+    LoRa_Sim_Destroy(sim);
+    return true;
+}
+
+// ============================================================
+//                    4. 输出
+// ============================================================
+
+static const char *s_CsvHeader =
+    "air_rate,payload,mode,loss,fec,ber,msgs,ok,failed,unfinished,rx_msgs,goodput_bps,lat_p50_ms,lat_p99_ms,"
+    "retries_per_msg,overhead_ratio,airtime_eff,sim_s\n";
+
+static void _WriteCsv(FILE *fp, const BenchResult_t *r) {
+    fprintf(fp, "%d,%u,%s,%.2f,%d,%g,%d,%d,%d,%d,%u,%.1f,%.1f,%.1f,%.3f,%.3f,%.4f,%.1f\n",
+            r->air_rate, r->payload, r->confirmed ? "confirmed" : "unconfirmed", r->loss,
+            r->fec ? 1 : 0, r->ber, r->msgs, r->ok, r->failed, r->unfinished, r->rx_msgs, r->goodput_bps, r->lat_p50_ms, r->lat_p99_ms,
+            r->retries_per_msg, r->overhead_ratio, r->airtime_eff, r->sim_s);
+}
+
+static void _WriteJson(FILE *fp, const BenchResult_t *r) {
+    fprintf(fp, "{\"air_rate\":%d,\"payload\":%u,\"mode\":\"%s\",\"loss\":%.2f,\"fec\":%s,\"ber\":%g,"
+                "\"msgs\":%d,\"ok\":%d,"
+                "\"failed\":%d,\"unfinished\":%d,\"rx_msgs\":%u,\"goodput_bps\":%.1f,\"lat_p50_ms\":%.1f,\"lat_p99_ms\":%.1f,"
+                "\"retries_per_msg\":%.3f,\"overhead_ratio\":%.3f,\"airtime_eff\":%.4f,\"sim_s\":%.1f}\n",
+            r->air_rate, r->payload, r->confirmed ? "confirmed" : "unconfirmed", r->loss,
+            r->fec ? "true" : "false", r->ber,
+            r->msgs, r->ok, r->failed, r->unfinished, r->rx_msgs, r->goodput_bps, r->lat_p50_ms, r->lat_p99_ms,
+            r->retries_per_msg, r->overhead_ratio, r->airtime_eff, r->sim_s);
+}
+
+static void _Usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s [-m msgs] [-w inflight] [-s seed] [-o out.csv] [-j out.jsonl]\n"
+            "          [-L node_lib] [-r rates] [-q] [-b] [-c]\n"
+            "  -m  messages per case (default 50, max %d)\n"
+            "  -w  max messages in flight (default 4)\n"
+            "  -r  air rates to run, e.g. \"05\" (default all: 012345)\n"
+            "  -L  alternative node library (compare stack build variants)\n"
+            "  -q  quick: only 16/%d byte payloads and 0/0.1 loss (0/1e-3 BER with -b)\n"
+            "  -b  bit error rate sweep: confirmed, no loss, FEC off vs on\n"
+            "  -c  compressible ASCII payload (default: incompressible pseudo-random bytes)\n",
+            prog, BENCH_MAX_MSGS, LORA_MAX_PAYLOAD_LEN);
+}
+
+// ============================================================
+//                    5. 主函数
+// ============================================================
+
+int main(int argc, char **argv) {
+    int msgs = 50, inflight = 4;
+    const char *csv_path = NULL, *json_path = NULL, *rates = "012345";
+    bool quick = false, ber_sweep = false, compressible = false;
+    LoRa_SimConfig_t cfg;
+    int opt;
+
+    LoRa_Sim_DefaultConfig(&cfg);
+    cfg.seed = 1;
+
+    while ((opt = getopt(argc, argv, "m:w:s:o:j:L:r:qbch")) != -1) {
+        switch (opt) {
+            case 'm': msgs = atoi(optarg); break;
+            case 'w': inflight = atoi(optarg); break;
+            case 's': cfg.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': csv_path = optarg; break;
+            case 'j': json_path = optarg; break;
+            case 'L': cfg.node_lib = optarg; break;
+            case 'r': rates = optarg; break;
+            case 'q': quick = true; break;
+            case 'b': ber_sweep = true; break;
+            case 'c': compressible = true; break;
+            default:  _Usage(argv[0]); return 1;
+        }
+    }
+    if (msgs < 1 || msgs > BENCH_MAX_MSGS || inflight < 1) {
+        _Usage(argv[0]);
+        return 1;
+    }
+
+    FILE *csv = csv_path ? fopen(csv_path, "w") : stdout;
+    FILE *json = json_path ? fopen(json_path, "w") : NULL;
+    if (!csv || (json_path && !json)) {
+        fprintf(stderr, "Cannot open output file\n");
+        return 1;
+    }
+    fputs(s_CsvHeader, csv);
+
+    for (const char *rc = rates; *rc; rc++) {
+        int rate = *rc - '0';
+        if (rate < LORA_RATE_0K3 || rate > LORA_RATE_19K2) continue;
+
+        for (size_t p = 0; p < sizeof(s_PayloadSizes) / sizeof(s_PayloadSizes[0]); p++) {
+            uint16_t payload = s_PayloadSizes[p];
+            if (quick && payload != 16 && payload != LORA_MAX_PAYLOAD_LEN) continue;
+
+            // 普通扫描：确认模式 x 丢包率；误码率扫描：误码率 x FEC 开关 (确认模式、无丢包)
+            int outer = ber_sweep ? (int)(sizeof(s_BitErrorRates) / sizeof(s_BitErrorRates[0])) : 2;
+            int inner = ber_sweep ? 2 : (int)(sizeof(s_LossRates) / sizeof(s_LossRates[0]));
+            for (int o = 0; o < outer; o++) {
+                for (int i = 0; i < inner; i++) {
+                    bool   confirmed = ber_sweep ? true : (o == 0);
+                    double loss      = ber_sweep ? 0.0 : s_LossRates[i];
+                    double ber       = ber_sweep ? s_BitErrorRates[o] : 0.0;
+                    bool   fec       = ber_sweep && (i == 1);
+                    if (quick && (loss > 0.1 || (ber > 0.0 && ber != 1e-3))) continue;
+
+                    BenchResult_t r;
+                    if (!_RunCase(&cfg, rate, payload, confirmed, loss, fec, ber, compressible, msgs, inflight, &r)) {
+                        fprintf(stderr, "Case failed to start (node library missing?)\n");
+                        return 1;
+                    }
+                    _WriteCsv(csv, &r);
+                    if (json) _WriteJson(json, &r);
+                    fflush(csv);
+
+                    fprintf(stderr, "rate %d len %3u %-11s loss %.2f ber %-6g fec %d: ok %3d/%-3d unfin %3d goodput %8.1f bps  "
+                                    "p50 %7.1f ms  p99 %7.1f ms  retry %.2f  ovh %.2f\n",
+                            rate, payload, confirmed ? "confirmed" : "unconfirmed", loss, ber, fec ? 1 : 0,
+                            r.ok, r.msgs, r.unfinished, r.goodput_bps, r.lat_p50_ms, r.lat_p99_ms,
+                            r.retries_per_msg, r.overhead_ratio);
+                }
+            }
+        }
+    }
+
+    if (csv != stdout) fclose(csv);
+    if (json) fclose(json);
+    return 0;
+}
@@ -0,0 +1,361 @@
+/**
+  ******************************************************************************
+  * @file    lora_bench_micro.c
+  * @author  LoRaPlat Team
+  * @brief   热路径微基准测试套件实现
+  *          每个用例自行计时 (只计入被测调用，不计入准备工作)，
+  *          重复 Repeats 轮取最快一轮，并扣除计数器读取本身的开销。
+  ******************************************************************************
+  */
+
+#include "lora_bench_micro.h"
+#include "lora_crc16.h"
+#include "lora_ring_buffer.h"
+#include "lora_manager_protocol.h"
+#include "lora_manager_buffer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define BENCH_RING_SIZE     LORA_PORT_DMA_RX_SIZE
+#define BENCH_LOCAL_ID      0x0002
+#define BENCH_REMOTE_ID     0x0001
+#define BENCH_NOISE_LEN     256
+
+static const uint16_t s_PayloadLens[] = { 16, 64, LORA_MAX_PAYLOAD_LEN };
+static const uint16_t s_CrcLens[]     = { 16, 64, 256 };
+
+// ============================================================
+//                    1. 内部状态
+// ============================================================
+
+typedef struct {
+    const LoRa_BenchCounter_t  *counter;
+    const LoRa_BenchMicroOpt_t *opt;
+    uint32_t                    overhead;   /*!< 一次 Read-Read 的最小差值 */
+    uint64_t                    hz;
+} BenchCtx_t;
+
+/**
+ * @brief 用例函数：执行 n 次被测操作，返回计时区间内的累计周期数
+ * @param timed_regions: 输出实际计时的区间数 (用于扣除计数器开销)
+ */
+typedef uint64_t (*BenchFn_t)(BenchCtx_t *ctx, uint32_t n, uint16_t param, uint32_t *timed_regions);
+
+static volatile uint32_t s_Sink;            // 防止被测结果被优化掉
+static uint8_t           s_Data[LORA_MAX_PAYLOAD_LEN + 64];
+static uint8_t           s_Frame[LORA_MAX_PAYLOAD_LEN + 32];
+static uint8_t           s_Scratch[BENCH_RING_SIZE];
+static uint8_t           s_RingArr[BENCH_RING_SIZE];
+static LoRa_Packet_t     s_Packet;
+
+static uint32_t _ReadCounter(const BenchCtx_t *ctx) {
+    return ctx->counter->Read();
+}
+
+static void _FillPacket(uint16_t payload_len) {
+    memset(&s_Packet, 0, sizeof(s_Packet));
+    s_Packet.NeedAck    = true;
+    s_Packet.HasCrc     = true;
+    s_Packet.TargetID   = BENCH_LOCAL_ID;
+    s_Packet.SourceID   = BENCH_REMOTE_ID;
+    s_Packet.Sequence   = 0x1234;
+    s_Packet.PayloadLen = (uint8_t)payload_len;
+    for (uint16_t i = 0; i < payload_len; i++) s_Packet.Payload[i] = (uint8_t)(i * 7 + 1);
+}
+
+// ============================================================
+//                    2. 用例
+// ============================================================
+
+static uint64_t _Case_Crc16(BenchCtx_t *ctx, uint32_t n, uint16_t len, uint32_t *regions) {
+    uint32_t acc = 0;
+    uint32_t t0 = _ReadCounter(ctx);
+    for (uint32_t i = 0; i < n; i++) {
+        acc += LoRa_CRC16_Calculate(s_Data, len);
+    }
+    uint32_t dt = _ReadCounter(ctx) - t0;
+    s_Sink = acc;
+    *regions = 1;
+    return dt;
+}
+
+static uint64_t _Case_Pack(BenchCtx_t *ctx, uint32_t n, uint16_t payload_len, uint32_t *regions) {
+    _FillPacket(payload_len);
+    uint32_t acc = 0;
+    uint32_t t0 = _ReadCounter(ctx);
+    for (uint32_t i = 0; i < n; i++) {
+        acc += LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+    }
+    uint32_t dt = _ReadCounter(ctx) - t0;
+    s_Sink = acc;
+    *regions = 1;
+    return dt;
+}
+
+static uint64_t _Case_Unpack(BenchCtx_t *ctx, uint32_t n, uint16_t payload_len, uint32_t *regions) {
+    _FillPacket(payload_len);
+    uint16_t flen = LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+    LoRa_Packet_t out;
+    uint32_t acc = 0;
+    uint32_t t0 = _ReadCounter(ctx);
+    for (uint32_t i = 0; i < n; i++) {
+        acc += LoRa_Manager_Protocol_Unpack(s_Frame, flen, &out, BENCH_LOCAL_ID, 0);
+    }
+    uint32_t dt = _ReadCounter(ctx) - t0;
+    s_Sink = acc + out.PayloadLen;
+    *regions = 1;
+    return dt;
+}
+
+// 每批写满环形缓冲区后清空 (清空不计时)
+static uint64_t _Case_RingWrite(BenchCtx_t *ctx, uint32_t n, uint16_t chunk, uint32_t *regions) {
+    LoRa_RingBuffer_t rb;
+    LoRa_RingBuffer_Init(&rb, s_RingArr, BENCH_RING_SIZE);
+    uint32_t per_batch = BENCH_RING_SIZE / chunk;
+    uint64_t total = 0;
+    uint32_t acc = 0;
+    *regions = 0;
+
+    for (uint32_t done = 0; done < n; ) {
+        uint32_t k = (n - done < per_batch) ? (n - done) : per_batch;
+        LoRa_RingBuffer_Clear(&rb);
+        uint32_t t0 = _ReadCounter(ctx);
+        for (uint32_t i = 0; i < k; i++) {
+            acc += LoRa_RingBuffer_Write(&rb, s_Data, chunk);
+        }
+        total += (uint32_t)(_ReadCounter(ctx) - t0);
+        (*regions)++;
+        done += k;
+    }
+    s_Sink = acc;
+    return total;
+}
+
+// 每批先写满 (不计时) 再逐块读空
+static uint64_t _Case_RingRead(BenchCtx_t *ctx, uint32_t n, uint16_t chunk, uint32_t *regions) {
+    LoRa_RingBuffer_t rb;
+    LoRa_RingBuffer_Init(&rb, s_RingArr, BENCH_RING_SIZE);
+    uint32_t per_batch = BENCH_RING_SIZE / chunk;
+    uint64_t total = 0;
+    uint32_t acc = 0;
+    *regions = 0;
+
+    for (uint32_t done = 0; done < n; ) {
+        uint32_t k = (n - done < per_batch) ? (n - done) : per_batch;
+        // 错开起点，让一部分读取跨越回绕边界
+        LoRa_RingBuffer_Clear(&rb);
+        LoRa_RingBuffer_Write(&rb, s_Data, (uint16_t)(done % chunk));
+        LoRa_RingBuffer_Read(&rb, s_Scratch, (uint16_t)(done % chunk));
+        for (uint32_t i = 0; i < k; i++) LoRa_RingBuffer_Write(&rb, s_Data, chunk);
+
+        uint32_t t0 = _ReadCounter(ctx);
+        for (uint32_t i = 0; i < k; i++) {
+            acc += LoRa_RingBuffer_Read(&rb, s_Scratch, chunk);
+        }
+        total += (uint32_t)(_ReadCounter(ctx) - t0);
+        (*regions)++;
+        done += k;
+    }
+    s_Sink = acc;
+    return total;
+}
+
+// 每批注入若干完整帧并拉入 RX 队列 (不计时)，再逐包解析
+static uint64_t _Case_GetRxPacket(BenchCtx_t *ctx, uint32_t n, uint16_t payload_len, uint32_t *regions) {
+    _FillPacket(payload_len);
+    uint16_t flen = LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+    uint32_t per_batch = BENCH_RING_SIZE / flen;
+    LoRa_Packet_t out;
+    uint64_t total = 0;
+    uint32_t acc = 0;
+    *regions = 0;
+
+    LoRa_Manager_Buffer_Init();
+    for (uint32_t done = 0; done < n; ) {
+        uint32_t k = (n - done < per_batch) ? (n - done) : per_batch;
+        for (uint32_t i = 0; i < k; i++) {
+            ctx->opt->FeedRx(s_Frame, flen);
+        }
+
+        uint32_t t0 = _ReadCounter(ctx);
+        for (uint32_t i = 0; i < k; i++) {
+            acc += LoRa_Manager_Buffer_GetRxPacket(&out, BENCH_LOCAL_ID, 0);
+        }
+        total += (uint32_t)(_ReadCounter(ctx) - t0);
+        (*regions)++;
+        done += k;
+    }
+    LoRa_Manager_Buffer_Init();
+    s_Sink = acc;
+    return total;
+}
+
+// 一帧按串口到达的节奏分块送入 (每块后 Run 轮询一次)：计入半帧期间的轮询开销
+#define BENCH_TRICKLE_CHUNK 16
+
+static uint64_t _Case_GetRxTrickle(BenchCtx_t *ctx, uint32_t n, uint16_t payload_len, uint32_t *regions) {
+    _FillPacket(payload_len);
+    uint16_t flen = LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+    LoRa_Packet_t out;
+    uint64_t total = 0;
+    uint32_t acc = 0;
+    *regions = 0;
+
+    LoRa_Manager_Buffer_Init();
+    for (uint32_t done = 0; done < n; done++) {
+        for (uint16_t off = 0; off < flen; off += BENCH_TRICKLE_CHUNK) {
+            uint16_t len = (flen - off < BENCH_TRICKLE_CHUNK) ? (flen - off) : BENCH_TRICKLE_CHUNK;
+            ctx->opt->FeedRx(&s_Frame[off], len);
+
+            uint32_t t0 = _ReadCounter(ctx);
+            acc += LoRa_Manager_Buffer_GetRxPacket(&out, BENCH_LOCAL_ID, 0);
+            total += (uint32_t)(_ReadCounter(ctx) - t0);
+            (*regions)++;
+        }
+    }
+    LoRa_Manager_Buffer_Init();
+    s_Sink = acc;
+    return total;
+}
+
+/**
+ * @brief 噪声重同步：noise_len 字节不含帧头的串口噪声后跟一帧，测量解析器跳过噪声并取出帧的耗时
+ */
+static uint64_t _Case_RxResync(BenchCtx_t *ctx, uint32_t n, uint16_t noise_len, uint32_t *regions) {
+    _FillPacket(16);
+    uint16_t flen = LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+    LoRa_Packet_t out;
+    uint64_t total = 0;
+    uint32_t acc = 0;
+    *regions = 0;
+
+    for (uint16_t i = 0; i < noise_len; i++) {
+        uint8_t b = (uint8_t)(i * 73 + 11);
+        if (b == 'C' || (b & 0xF8) == 0xA8) b ^= 0x10;     // 噪声中不出现候选帧头
+        s_Scratch[i] = b;
+    }
+
+    LoRa_Manager_Buffer_Init();
+    for (uint32_t done = 0; done < n; done++) {
+        ctx->opt->FeedRx(s_Scratch, noise_len);
+        ctx->opt->FeedRx(s_Frame, flen);
+
+        uint32_t t0 = _ReadCounter(ctx);
+        acc += LoRa_Manager_Buffer_GetRxPacket(&out, BENCH_LOCAL_ID, 0);
+        total += (uint32_t)(_ReadCounter(ctx) - t0);
+        (*regions)++;
+    }
+    LoRa_Manager_Buffer_Init();
+    s_Sink = acc;
+    return total;
+}
+
+// ============================================================
+//                    3. 测量框架
+// ============================================================
+
+static void _Calibrate(BenchCtx_t *ctx) {
+    uint32_t best = 0xFFFFFFFFu;
+    for (int i = 0; i < 100; i++) {
+        uint32_t t0 = _ReadCounter(ctx);
+        uint32_t dt = _ReadCounter(ctx) - t0;
+        if (dt < best) best = dt;
+    }
+    ctx->overhead = best;
+}
+
+static void _Measure(BenchCtx_t *ctx, const char *name, uint16_t bytes, BenchFn_t fn, uint16_t param,
+                     LoRa_BenchMicroResult_t *res) {
+    uint32_t n = ctx->opt->Iterations;
+    uint32_t regions;
+    double best = -1.0;
+
+    fn(ctx, n / 10 + 1, param, &regions); // 预热 (指令/数据缓存、Flash 预取)
+
+    for (uint8_t r = 0; r < ctx->opt->Repeats; r++) {
+        uint64_t cyc = fn(ctx, n, param, &regions);
+        uint64_t ovh = (uint64_t)ctx->overhead * regions;
+        double c = (cyc > ovh) ? (double)(cyc - ovh) : 0.0;
+        if (best < 0 || c < best) best = c;
+    }
+
+    res->Name        = name;
+    res->Bytes       = bytes;
+    res->Ops         = n;
+    res->CyclesPerOp = best / n;
+    res->NsPerOp     = ctx->hz ? res->CyclesPerOp * 1e9 / (double)ctx->hz : 0.0;
+    res->NsPerByte   = bytes ? res->NsPerOp / bytes : 0.0;
+}
+
+// ============================================================
+//                    4. 对外接口
+// ============================================================
+
+void LoRa_BenchMicro_DefaultOpt(LoRa_BenchMicroOpt_t *opt) {
+    if (!opt) return;
+    opt->Iterations = 1000;
+    opt->Repeats    = 5;
+    opt->FeedRx     = NULL;
+}
+
+uint16_t LoRa_BenchMicro_Run(const LoRa_BenchCounter_t *counter, const LoRa_BenchMicroOpt_t *opt,
+                             LoRa_BenchMicroResult_t *results, uint16_t max_results) {
+    LoRa_BenchMicroOpt_t def;
+    BenchCtx_t ctx;
+    uint16_t cnt = 0;
+
+    if (!results || max_results == 0) return 0;
+    if (!opt) {
+        LoRa_BenchMicro_DefaultOpt(&def);
+        opt = &def;
+    }
+    if (opt->Iterations == 0 || opt->Repeats == 0) return 0;
+
+    ctx.counter = counter ? counter : &g_LoRaBenchCounterDefault;
+    ctx.opt     = opt;
+    if (ctx.counter->Init) ctx.counter->Init();
+    ctx.hz = ctx.counter->GetHz();
+    _Calibrate(&ctx);
+
+    for (uint16_t i = 0; i < sizeof(s_Data); i++) s_Data[i] = (uint8_t)(i * 31 + 5);
+
+    for (size_t i = 0; i < sizeof(s_CrcLens) / sizeof(s_CrcLens[0]) && cnt < max_results; i++) {
+        _Measure(&ctx, "crc16", s_CrcLens[i], _Case_Crc16, s_CrcLens[i], &results[cnt++]);
+    }
+
+    for (size_t i = 0; i < sizeof(s_PayloadLens) / sizeof(s_PayloadLens[0]); i++) {
+        uint16_t plen = s_PayloadLens[i];
+        _FillPacket(plen);
+        uint16_t flen = LoRa_Manager_Protocol_Pack(&s_Packet, s_Frame, sizeof(s_Frame), 0, 0);
+
+        if (cnt < max_results) _Measure(&ctx, "pack", flen, _Case_Pack, plen, &results[cnt++]);
+        if (cnt < max_results) _Measure(&ctx, "unpack", flen, _Case_Unpack, plen, &results[cnt++]);
+        if (cnt < max_results) _Measure(&ctx, "ring_write", flen, _Case_RingWrite, flen, &results[cnt++]);
+        if (cnt < max_results) _Measure(&ctx, "ring_read", flen, _Case_RingRead, flen, &results[cnt++]);
+        if (opt->FeedRx && cnt < max_results) {
+            _Measure(&ctx, "get_rx_packet", flen, _Case_GetRxPacket, plen, &results[cnt++]);
+        }
+        if (opt->FeedRx && cnt < max_results) {
+            _Measure(&ctx, "get_rx_trickle", flen, _Case_GetRxTrickle, plen, &results[cnt++]);
+        }
+    }
+    if (opt->FeedRx && cnt < max_results) {
+        _Measure(&ctx, "rx_resync", BENCH_NOISE_LEN, _Case_RxResync, BENCH_NOISE_LEN, &results[cnt++]);
+    }
+    return cnt;
+}
+
+void LoRa_BenchMicro_Print(const LoRa_BenchMicroResult_t *results, uint16_t count,
+                           void (*put_line)(const char *line)) {
+    char line[96];
+    if (!results || !put_line) return;
+
+    snprintf(line, sizeof(line), "%-14s %6s %12s %10s %9s", "case", "bytes", "cycles/op", "ns/op", "ns/byte");
+    put_line(line);
+    for (uint16_t i = 0; i < count; i++) {
+        const LoRa_BenchMicroResult_t *r = &results[i];
+        snprintf(line, sizeof(line), "%-14s %6u %12.1f %10.1f %9.2f",
+                 r->Name, r->Bytes, r->CyclesPerOp, r->NsPerOp, r->NsPerByte);
+        put_line(line);
+    }
+}
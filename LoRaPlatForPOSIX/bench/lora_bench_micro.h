@@ -0,0 +1,74 @@
+/**
+  ******************************************************************************
+  * @file    lora_bench_micro.h
+  * @author  LoRaPlat Team
+  * @brief   热路径微基准测试套件 (可移植)
+  *          覆盖 Protocol_Pack / Protocol_Unpack / CRC16 / RingBuffer 读写 /
+  *          Buffer_GetRxPacket，输出 cycles/op 与 ns/byte。
+  *          套件本身只依赖协议栈头文件，可直接加入 STM32/ESP32 工程，
+  *          配合 lora_bench_counter.h 中的 DWT / CCOUNT 计数器运行。
+  * @note    套件会调用 LoRa_Manager_Buffer_Init 重置收发队列，
+  *          必须在 LoRa_Service_Init 之前 (或代替它) 运行。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_BENCH_MICRO_H
+#define __LORA_BENCH_MICRO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lora_bench_counter.h"
+
+#define LORA_BENCH_MICRO_MAX_RESULTS    32
+
+/**
+ * @brief 运行参数
+ */
+typedef struct {
+    uint32_t Iterations;                /*!< 每轮测量的操作次数 */
+    uint8_t  Repeats;                   /*!< 测量轮数，取最快一轮 (抑制中断/调度噪声) */
+
+    /**
+     * @brief 注入 RX 字节 (可选)
+     * @note  追加到尚未读出的字节之后，使随后的 LoRa_Port_PeekRx / ReceiveData 返回这些字节。
+     *        为 NULL 时跳过 Buffer_GetRxPacket 用例 (真实硬件上无法注入)。
+     */
+    bool (*FeedRx)(const uint8_t *data, uint16_t len);
+} LoRa_BenchMicroOpt_t;
+
+/**
+ * @brief 单个用例结果
+ */
+typedef struct {
+    const char *Name;
+    uint16_t    Bytes;                  /*!< 每次操作处理的字节数 */
+    uint32_t    Ops;                    /*!< 最快一轮的操作次数 */
+    double      CyclesPerOp;            /*!< 单次操作周期数 (cycles/packet) */
+    double      NsPerOp;
+    double      NsPerByte;
+} LoRa_BenchMicroResult_t;
+
+/**
+ * @brief  填充默认参数 (1000 次 x 5 轮，不注入 RX)
+ */
+void LoRa_BenchMicro_DefaultOpt(LoRa_BenchMicroOpt_t *opt);
+
+/**
+ * @brief  运行全部用例
+ * @param  counter: 周期计数器 (NULL 使用 g_LoRaBenchCounterDefault)
+ * @param  opt: 运行参数 (NULL 使用默认值)
+ * @param  results: 输出数组
+ * @param  max_results: 数组容量
+ * @return 实际输出的结果条数
+ */
+uint16_t LoRa_BenchMicro_Run(const LoRa_BenchCounter_t *counter, const LoRa_BenchMicroOpt_t *opt,
+                             LoRa_BenchMicroResult_t *results, uint16_t max_results);
+
+/**
+ * @brief  将结果格式化为文本表格，逐行回调输出 (便于走串口/日志)
+ * @param  put_line: 行输出回调 (不含换行符)
+ */
+void LoRa_BenchMicro_Print(const LoRa_BenchMicroResult_t *results, uint16_t count,
+                           void (*put_line)(const char *line));
+
+#endif // __LORA_BENCH_MICRO_H
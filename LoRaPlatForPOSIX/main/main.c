@@ -0,0 +1,223 @@
+/**
+  ******************************************************************************
+  * @file    main.c
+  * @author  LoRaPlat Team
+  * @brief   LoRaPlat Linux 主机例程
+  *          在 PC 上以原生进程运行完整协议栈，可直接用 perf / valgrind /
+  *          sanitizer 分析 LoRa_Service_Run。
+  *
+  *          用法示例:
+  *            真实模组:  lora_node -d /dev/ttyUSB0 -i 1 -t 2
+  *            两进程互联: lora_node -p -i 1 -t 2      (打印 pty 路径 X)
+  *                        lora_node -d X -i 2 -t 1
+  ******************************************************************************
+  */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <getopt.h>
+
+#include "lora_service.h"
+#include "lora_service_command.h"
+#include "lora_port.h"
+#include "lora_port_posix.h"
+
+// --- 声明外部初始化函数 ---
+extern void LoRa_OSAL_Init_POSIX(void);
+
+// ============================================================
+//                    0. 运行参数
+// ============================================================
+
+static const char *s_CfgPath  = "loraplat_cfg.bin";
+static uint16_t    s_NetId    = 1;
+static uint16_t    s_TargetId = 2;
+static bool        s_Confirmed = true;
+
+// ============================================================
+//                    1. 配置存储适配 (文件代替 Flash)
+// ============================================================
+
+static void App_SaveConfig(const LoRa_Config_t *cfg) {
+    FILE *fp = fopen(s_CfgPath, "wb");
+    if (!fp) return;
+    fwrite(cfg, sizeof(LoRa_Config_t), 1, fp);
+    fclose(fp);
+    printf("[CFG] Saved to %s\n", s_CfgPath);
+}
+
+static void App_LoadConfig(LoRa_Config_t *cfg) {
+    memset(cfg, 0, sizeof(LoRa_Config_t));
+    FILE *fp = fopen(s_CfgPath, "rb");
+    if (!fp) return;
+    if (fread(cfg, sizeof(LoRa_Config_t), 1, fp) != 1) {
+        cfg->magic = 0;
+    }
+    fclose(fp);
+}
+
+static uint32_t App_GetRandomSeed(void) {
+    return LoRa_Port_GetEntropy32();
+}
+
+static void App_SystemReset(void) {
+    printf("[SYS] Hard Reset Requested, exiting.\n");
+    exit(0);
+}
+
+// ============================================================
+//                    2. LoRa 回调逻辑
+// ============================================================
+
+static void App_OnRecvData(uint16_t src_id, const uint8_t *data, uint16_t len, LoRa_RxMeta_t *meta) {
+    printf("[RX] From 0x%04X (RSSI:%d): %.*s\n", src_id, meta->rssi, len, (const char *)data);
+    fflush(stdout);
+}
+
+static void App_OnEvent(LoRa_Event_t event, void *arg) {
+    switch (event) {
+        case LORA_EVENT_INIT_SUCCESS:
+            printf("[EVT] LoRa Stack Ready. ID:%d\n", s_NetId);
+            break;
+        case LORA_EVENT_TX_SUCCESS_ID:
+            printf("[EVT] Msg ID:%d Send Success\n", *(LoRa_MsgID_t *)arg);
+            break;
+        case LORA_EVENT_TX_FAILED_ID:
+            printf("[EVT] Msg ID:%d Send Failed (Timeout)\n", *(LoRa_MsgID_t *)arg);
+            break;
+        case LORA_EVENT_CONFIG_COMMIT:
+            printf("[EVT] Config Commit.\n");
+            break;
+        default:
+            break;
+    }
+    fflush(stdout);
+}
+
+static const LoRa_Callback_t s_LoRaCb = {
+    .SaveConfig    = App_SaveConfig,
+    .LoadConfig    = App_LoadConfig,
+    .GetRandomSeed = App_GetRandomSeed,
+    .SystemReset   = App_SystemReset,
+    .OnRecvData    = App_OnRecvData,
+    .OnEvent       = App_OnEvent
+};
+
+// ============================================================
+//                    3. 辅助函数
+// ============================================================
+
+// 创建 pty 对，master 作为 LoRa 通道，打印 slave 路径供另一进程打开
+static bool _OpenPty(void) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) return false;
+    printf("[PTY] Peer device: %s\n", ptsname(fd));
+    fflush(stdout);
+    LoRa_Port_POSIX_Attach(fd, true);
+    return true;
+}
+
+static void _HandleInputLine(char *line) {
+    char resp_buf[128];
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '\0') return;
+
+    if (strncmp(line, "CMD:", 4) == 0) {
+        if (LoRa_Service_Command_Process(line, resp_buf, sizeof(resp_buf))) {
+            printf(" -> CMD Result: %s\n", resp_buf);
+        } else {
+            printf(" -> CMD Ignored\n");
+        }
+        return;
+    }
+
+    LoRa_MsgID_t msg_id = LoRa_Service_Send((const uint8_t *)line, strlen(line), s_TargetId,
+                                            s_Confirmed ? LORA_OPT_CONFIRMED : LORA_OPT_UNCONFIRMED);
+    if (msg_id > 0) {
+        printf(" -> Enqueued ID:%d\n", msg_id);
+    } else {
+        printf(" -> Send Failed (Busy)\n");
+    }
+}
+
+static void _Usage(const char *prog) {
+    fprintf(stderr,
+            "Usage: %s (-d <device> | -p) [-i net_id] [-t target_id] [-c cfg_file] [-u]\n"
+            "  -d  serial device or pty path\n"
+            "  -p  create a pty pair and print the peer path\n"
+            "  -u  send unconfirmed (default: confirmed)\n", prog);
+}
+
+// ============================================================
+//                    4. 主函数
+// ============================================================
+
+int main(int argc, char **argv) {
+    const char *dev = NULL;
+    bool use_pty = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:pi:t:c:uh")) != -1) {
+        switch (opt) {
+            case 'd': dev = optarg; break;
+            case 'p': use_pty = true; break;
+            case 'i': s_NetId = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 't': s_TargetId = (uint16_t)strtoul(optarg, NULL, 0); break;
+            case 'c': s_CfgPath = optarg; break;
+            case 'u': s_Confirmed = false; break;
+            default:  _Usage(argv[0]); return 1;
+        }
+    }
+
+    LoRa_OSAL_Init_POSIX();
+
+    bool ok = use_pty ? _OpenPty() : (dev && LoRa_Port_POSIX_Open(dev));
+    if (!ok) {
+        _Usage(argv[0]);
+        return 1;
+    }
+
+    // 启动协议栈 (传入回调和 ID)
+    LoRa_Service_Init(&s_LoRaCb, s_NetId);
+
+    printf("=== LoRaPlat POSIX Node (ID: %d -> %d) ===\n", s_NetId, s_TargetId);
+    printf("Type text to send, or 'CMD:00000000:INFO'\n");
+    fflush(stdout);
+
+    char line[256];
+    while (1) {
+        // 1. 协议栈运行
+        LoRa_Service_Run();
+
+        // 2. Tickless 休眠：在 fd 上 poll，超时取协议栈建议值 (上限 10ms)
+        int timeout_ms = 0;
+        if (LoRa_Service_CanSleep()) {
+            uint32_t sleep_ms = LoRa_Service_GetSleepDuration();
+            timeout_ms = (sleep_ms > 10) ? 10 : (int)sleep_ms;
+        }
+
+        struct pollfd pfds[2] = {
+            { .fd = STDIN_FILENO,            .events = POLLIN },
+            { .fd = LoRa_Port_POSIX_GetFd(), .events = POLLIN },
+        };
+        if (poll(pfds, 2, timeout_ms) <= 0) continue;
+
+        // 3. 用户输入
+        if (pfds[0].revents & (POLLIN | POLLHUP)) {
+            if (!fgets(line, sizeof(line), stdin)) break;
+            _HandleInputLine(line);
+            fflush(stdout);
+        }
+        if (pfds[1].revents & POLLIN) {
+            LoRa_Port_NotifyHwEvent();
+        }
+    }
+
+    LoRa_Port_POSIX_Close();
+    return 0;
+}
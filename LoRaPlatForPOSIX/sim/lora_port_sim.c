@@ -0,0 +1,178 @@
+/**
+  ******************************************************************************
+  * @file    lora_port_sim.c
+  * @author  LoRaPlat Team
+  * @brief   仿真节点的硬件接口实现
+  *          编译进节点动态库，所有硬件行为转发给仿真器的模组模型。
+  ******************************************************************************
+  */
+
+#include "lora_port.h"
+#include "lora_sim_port.h"
+#include "lora_osal.h"
+#include <stddef.h>
+#include <string.h>
+
+static const LoRa_SimPortOps_t *s_Ops = NULL;
+
+// 硬件事件挂起标志 (与 STM32/ESP32 语义一致)
+static volatile bool s_HwEventPending = false;
+
+// [新增] 借出给上层直接封包的发送缓冲 (对应 MCU 的 DMA TX 缓冲)
+static uint8_t s_TxBuf[LORA_PORT_DMA_TX_SIZE];
+static bool    s_TxLent = false;
+
+// [新增] 接收暂存区 (对应 MCU 的 DMA RX 缓冲：已从模组模型读出、尚未被上层消费的字节)
+static uint8_t  s_RxBuf[LORA_PORT_DMA_RX_SIZE];
+static uint16_t s_RxHead = 0;
+static uint16_t s_RxTail = 0;
+
+void LoRa_SimPort_Bind(const LoRa_SimPortOps_t *ops) {
+    s_Ops = ops;
+}
+
+// ============================================================
+//                    1. 初始化与配置
+// ============================================================
+
+void LoRa_Port_Init(uint32_t baudrate) {
+    LORA_CHECK_VOID(s_Ops);
+    s_Ops->SetBaud(s_Ops->ctx, baudrate);
+    LoRa_Port_SetMD0(false);
+    LoRa_Port_SyncAuxState();
+}
+
+void LoRa_Port_ReInitUart(uint32_t baudrate) {
+    if (s_Ops) s_Ops->SetBaud(s_Ops->ctx, baudrate);
+}
+
+// ============================================================
+//                    2. 引脚控制
+// ============================================================
+
+void LoRa_Port_SetMD0(bool level) {
+    if (s_Ops) s_Ops->SetMD0(s_Ops->ctx, level);
+}
+
+void LoRa_Port_SetRST(bool level) {
+    (void)level;
+}
+
+bool LoRa_Port_GetAUX(void) {
+    return s_Ops ? s_Ops->GetAUX(s_Ops->ctx) : false;
+}
+
+uint32_t LoRa_Port_GetAuxIdleTick(void) {
+    return s_Ops ? s_Ops->GetAuxIdleTick(s_Ops->ctx) : 0;
+}
+
+void LoRa_Port_SyncAuxState(void) {
+}
+
+// ============================================================
+//                    3. 发送接口 (TX)
+// ============================================================
+
+bool LoRa_Port_IsTxBusy(void) {
+    return s_Ops ? s_Ops->IsTxBusy(s_Ops->ctx) : false;
+}
+
+uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
+    if (!s_Ops || !data || len == 0 || len > LORA_PORT_DMA_TX_SIZE || s_TxLent) return 0;
+    uint16_t ret = s_Ops->Transmit(s_Ops->ctx, data, len);
+    if (ret > 0) s_HwEventPending = true;
+    return ret;
+}
+
+uint8_t *LoRa_Port_AcquireTxBuffer(uint16_t *capacity) {
+    if (!s_Ops || s_TxLent || s_Ops->IsTxBusy(s_Ops->ctx)) return NULL;
+    s_TxLent = true;
+    if (capacity) *capacity = sizeof(s_TxBuf);
+    return s_TxBuf;
+}
+
+uint16_t LoRa_Port_CommitTx(uint16_t len) {
+    if (!s_TxLent) return 0;
+    s_TxLent = false;
+    if (len == 0) return 0;
+    return LoRa_Port_TransmitData(s_TxBuf, len);
+}
+
+// ============================================================
+//                    4. 接收接口 (RX)
+// ============================================================
+
+uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
+    if (!buf || max_len == 0) return 0;
+    LoRa_PortSpan_t span[2];
+    uint16_t cnt = LoRa_Port_PeekRx(span);
+    if (cnt > max_len) cnt = max_len;
+    memcpy(buf, span[0].data, cnt);
+    LoRa_Port_ConsumeRx(cnt);
+    return cnt;
+}
+
+uint16_t LoRa_Port_PeekRx(LoRa_PortSpan_t span[2]) {
+    if (s_RxHead > 0) {
+        memmove(s_RxBuf, &s_RxBuf[s_RxHead], s_RxTail - s_RxHead);
+        s_RxTail -= s_RxHead;
+        s_RxHead = 0;
+    }
+    if (s_Ops && s_RxTail < sizeof(s_RxBuf)) {
+        uint16_t ret = s_Ops->Receive(s_Ops->ctx, &s_RxBuf[s_RxTail], (uint16_t)(sizeof(s_RxBuf) - s_RxTail));
+        if (ret > 0) s_HwEventPending = true;
+        s_RxTail += ret;
+    }
+    // 暂存区是线性的，只有一段
+    span[0].data = &s_RxBuf[s_RxHead];
+    span[0].len = s_RxTail - s_RxHead;
+    span[1].data = s_RxBuf;
+    span[1].len = 0;
+    return span[0].len;
+}
+
+void LoRa_Port_ConsumeRx(uint16_t len) {
+    if (len > s_RxTail - s_RxHead) len = s_RxTail - s_RxHead;
+    s_RxHead += len;
+    if (s_RxHead == s_RxTail) {
+        s_RxHead = 0;
+        s_RxTail = 0;
+    }
+}
+
+void LoRa_Port_ClearRxBuffer(void) {
+    s_RxHead = 0;
+    s_RxTail = 0;
+    if (s_Ops) s_Ops->ClearRx(s_Ops->ctx);
+}
+
+// [新增] 暂存区只在上层消费后才从模组模型读入新数据，不会被覆盖
+bool LoRa_Port_CheckAndClearRxOverrun(void) {
+    return false;
+}
+
+// ============================================================
+//                    5. 其他能力
+// ============================================================
+
+uint32_t LoRa_Port_GetEntropy32(void) {
+    return s_Ops ? s_Ops->GetEntropy32(s_Ops->ctx) : 0;
+}
+
+// ============================================================
+//                    6. 低功耗支持
+// ============================================================
+
+void LoRa_Port_NotifyHwEvent(void) {
+    s_HwEventPending = true;
+}
+
+void LoRa_Port_OnAuxEdge(void) {
+    s_HwEventPending = true;
+}
+
+bool LoRa_Port_CheckAndClearHwEvent(void) {
+    bool ret = s_HwEventPending;
+    s_HwEventPending = false; // 读后即焚
+    return ret || (s_Ops && s_Ops->HasRxData(s_Ops->ctx));
+}
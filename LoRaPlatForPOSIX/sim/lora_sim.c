@@ -0,0 +1,454 @@
+/**
+  ******************************************************************************
+  * @file    lora_sim.c
+  * @author  LoRaPlat Team
+  * @brief   多节点仿真器：节点加载、主机侧 OSAL/回调、调度器
+  *          协议栈各层均为静态单例，为使每个节点拥有独立的 Manager/FSM，
+  *          每个节点将节点动态库写入独立的 memfd 后 dlopen，得到一份私有副本。
+  ******************************************************************************
+  */
+
+#define _GNU_SOURCE
+#include "lora_sim_internal.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef LORA_SIM_NODE_LIB_DEFAULT
+#define LORA_SIM_NODE_LIB_DEFAULT   "lora_sim_node.so"
+#endif
+
+// 仿真器为单线程模型：当前实例与当前正在执行协议栈代码的节点
+static LoRa_Sim_t     *s_CurSim  = NULL;
+static LoRa_SimNode_t *s_CurNode = NULL;
+
+// ============================================================
+//                    1. 时钟
+// ============================================================
+
+static uint64_t _WallUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000L);
+}
+
+/**
+ * @brief 同步仿真时钟 (实时模式：跟随墙钟；虚拟模式：保持不变)
+ */
+uint64_t LoRa_Sim_ClockSync(LoRa_Sim_t *sim) {
+    if (sim->cfg.realtime) {
+        uint64_t t = _WallUs() - sim->wall_base_us;
+        if (t > sim->now_us) sim->now_us = t;
+    }
+    return sim->now_us;
+}
+
+static void _ClockWaitUntil(LoRa_Sim_t *sim, uint64_t t_us) {
+    if (!sim->cfg.realtime) {
+        if (t_us > sim->now_us) sim->now_us = t_us; // 虚拟时钟：直接跳到目标时刻
+        return;
+    }
+
+    uint64_t now = LoRa_Sim_ClockSync(sim);
+    uint64_t wait = (t_us > now) ? (t_us - now) : 0;
+    if (wait < 100) wait = 100; // 避免空转占满 CPU
+    struct timespec req = { .tv_sec = (time_t)(wait / 1000000ULL), .tv_nsec = (long)(wait % 1000000ULL) * 1000L };
+    while (nanosleep(&req, &req) != 0 && errno == EINTR) {
+    }
+    LoRa_Sim_ClockSync(sim);
+}
+
+// ============================================================
+//                    2. 主机侧 OSAL (所有节点共用)
+// ============================================================
+
+static uint32_t Sim_GetTick(void) {
+    if (!s_CurSim->cfg.realtime) s_CurSim->now_us += LORA_SIM_TICK_COST_US;
+    return (uint32_t)(LoRa_Sim_ClockSync(s_CurSim) / 1000ULL);
+}
+
+static void Sim_DelayMs(uint32_t ms) {
+    _ClockWaitUntil(s_CurSim, LoRa_Sim_ClockSync(s_CurSim) + (uint64_t)ms * 1000ULL);
+}
+
+static uint32_t Sim_EnterCritical(void) {
+    return 0;
+}
+
+static void Sim_ExitCritical(uint32_t ctx) {
+    (void)ctx;
+}
+
+static void Sim_Log(const char *fmt, va_list args) {
+    if (!s_CurSim->cfg.verbose) return;
+    fprintf(stderr, "[%8u][N%02d] ", (unsigned)(s_CurSim->now_us / 1000ULL), s_CurNode ? s_CurNode->index : -1);
+    vfprintf(stderr, fmt, args);
+}
+
+static void Sim_LogHex(const char *tag, const void *data, uint16_t len) {
+    if (!s_CurSim->cfg.verbose) return;
+    const uint8_t *p = (const uint8_t *)data;
+    fprintf(stderr, "[%8u][N%02d] %s (Len=%d): ", (unsigned)(s_CurSim->now_us / 1000ULL),
+            s_CurNode ? s_CurNode->index : -1, tag, len);
+    for (uint16_t i = 0; i < len; i++) {
+        fprintf(stderr, "%02X ", p[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void* Sim_Malloc(uint32_t size) {
+    return malloc(size);
+}
+
+static void Sim_Free(void *ptr) {
+    free(ptr);
+}
+
+static const LoRa_OSAL_Interface_t s_SimOSAL = {
+    .GetTick       = Sim_GetTick,
+    .DelayMs       = Sim_DelayMs,
+    .EnterCritical = Sim_EnterCritical,
+    .ExitCritical  = Sim_ExitCritical,
+    .Log           = Sim_Log,
+    .LogHex        = Sim_LogHex,
+    .Malloc        = Sim_Malloc,
+    .Free          = Sim_Free
+};
+
+// ============================================================
+//                    3. 主机侧应用回调 (按当前节点分派)
+// ============================================================
+
+static void Sim_SaveConfig(const LoRa_Config_t *cfg) {
+    s_CurNode->flash = *cfg;
+}
+
+static void Sim_LoadConfig(LoRa_Config_t *cfg) {
+    *cfg = s_CurNode->flash;
+}
+
+static uint32_t Sim_GetRandomSeed(void) {
+    return (uint32_t)(LoRa_Sim_RandNext(&s_CurNode->rng) >> 32);
+}
+
+static void Sim_SystemReset(void) {
+    if (s_CurSim->cfg.verbose) {
+        fprintf(stderr, "[SIM] Node %d requested hard reset (ignored)\n", s_CurNode->index);
+    }
+}
+
+static void Sim_OnRecvData(uint16_t src_id, const uint8_t *data, uint16_t len, LoRa_RxMeta_t *meta) {
+    (void)meta;
+    if (s_CurSim->app.OnRecv) {
+        s_CurSim->app.OnRecv(s_CurSim->app.user, s_CurNode->index, src_id, data, len);
+    }
+}
+
+static void Sim_OnEvent(LoRa_Event_t event, void *arg) {
+    if (s_CurSim->app.OnEvent) {
+        s_CurSim->app.OnEvent(s_CurSim->app.user, s_CurNode->index, event, arg);
+    }
+}
+
+static const LoRa_Callback_t s_SimAppCb = {
+    .SaveConfig    = Sim_SaveConfig,
+    .LoadConfig    = Sim_LoadConfig,
+    .GetRandomSeed = Sim_GetRandomSeed,
+    .SystemReset   = Sim_SystemReset,
+    .OnRecvData    = Sim_OnRecvData,
+    .OnEvent       = Sim_OnEvent
+};
+
+// 切换当前节点 (所有进入节点协议栈的调用都必须经过此处)
+static void _Enter(LoRa_Sim_t *sim, LoRa_SimNode_t *node) {
+    s_CurSim = sim;
+    s_CurNode = node;
+}
+
+// ============================================================
+//                    4. 节点动态库加载
+// ============================================================
+
+static bool _ReadFile(const char *path, uint8_t **out, size_t *out_len) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long sz = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if (sz <= 0) { fclose(fp); return false; }
+
+    uint8_t *buf = (uint8_t *)malloc((size_t)sz);
+    if (!buf || fread(buf, 1, (size_t)sz, fp) != (size_t)sz) {
+        free(buf);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+    *out = buf;
+    *out_len = (size_t)sz;
+    return true;
+}
+
+// 同一路径的 .so 只会被 dlopen 一次，因此每个节点写入独立 memfd (独立 inode)
+static bool _LoadNodeLib(LoRa_Sim_t *sim, LoRa_SimNode_t *node) {
+    char name[32], path[64];
+    snprintf(name, sizeof(name), "lora_sim_node%d", node->index);
+
+    node->memfd = memfd_create(name, MFD_CLOEXEC);
+    if (node->memfd < 0) return false;
+    if (write(node->memfd, sim->lib_image, sim->lib_size) != (ssize_t)sim->lib_size) return false;
+
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", node->memfd);
+    node->dl = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!node->dl) {
+        fprintf(stderr, "[SIM] dlopen failed: %s\n", dlerror());
+        return false;
+    }
+
+#define _SYM(field, name) \
+    do { \
+        *(void **)(&node->field) = dlsym(node->dl, name); \
+        if (!node->field) return false; \
+    } while (0)
+
+    _SYM(OSAL_Init,                "LoRa_OSAL_Init");
+    _SYM(Port_Bind,                LORA_SIM_PORT_BIND_SYMBOL);
+    _SYM(Service_Init,             "LoRa_Service_Init");
+    _SYM(Service_Run,              "LoRa_Service_Run");
+    _SYM(Service_Send,             "LoRa_Service_Send");
+    _SYM(Service_GetSleepDuration, "LoRa_Service_GetSleepDuration");
+    _SYM(Service_IsBusy,           "LoRa_Service_IsBusy");
+    _SYM(Port_CheckAndClearHwEvent, "LoRa_Port_CheckAndClearHwEvent");
+#undef _SYM
+    // 可选：旧版协议栈没有该接口时不统计重传
+    *(void **)(&node->Protocol_PeekFrame) = dlsym(node->dl, "LoRa_Manager_Protocol_PeekFrame");
+    return true;
+}
+
+static void _FreeNode(LoRa_SimNode_t *node) {
+    if (!node) return;
+    if (node->dl) dlclose(node->dl);
+    if (node->memfd >= 0) close(node->memfd);
+    free(node);
+}
+
+// ============================================================
+//                    5. 生命周期
+// ============================================================
+
+void LoRa_Sim_DefaultConfig(LoRa_SimConfig_t *cfg) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->node_lib        = NULL;
+    cfg->seed            = 0;
+    cfg->path_loss_exp   = 2.7;
+    cfg->capture_db      = 6.0;
+    cfg->noise_figure_db = 6.0;
+    cfg->realtime        = false;
+    cfg->verbose         = false;
+}
+
+void LoRa_Sim_DefaultNodeConfig(LoRa_SimNodeConfig_t *cfg, uint16_t net_id) {
+    if (!cfg) return;
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->net_id   = net_id;
+    cfg->group_id = LORA_GROUP_ID_DEFAULT;
+    cfg->hw_addr  = LORA_HW_ADDR_DEFAULT;
+    cfg->channel  = DEFAULT_LORA_CHANNEL;
+    cfg->air_rate = (uint8_t)DEFAULT_LORA_RATE;
+    cfg->power    = (uint8_t)DEFAULT_LORA_POWER;
+    cfg->tmode    = (uint8_t)DEFAULT_LORA_TMODE;
+}
+
+LoRa_Sim_t* LoRa_Sim_Create(const LoRa_SimConfig_t *cfg, const LoRa_SimAppCb_t *cb) {
+    LoRa_Sim_t *sim = (LoRa_Sim_t *)calloc(1, sizeof(LoRa_Sim_t));
+    if (!sim) return NULL;
+
+    if (cfg) sim->cfg = *cfg;
+    else LoRa_Sim_DefaultConfig(&sim->cfg);
+    if (cb) sim->app = *cb;
+
+    const char *lib = sim->cfg.node_lib ? sim->cfg.node_lib : LORA_SIM_NODE_LIB_DEFAULT;
+    if (!_ReadFile(lib, &sim->lib_image, &sim->lib_size)) {
+        fprintf(stderr, "[SIM] Cannot read node library: %s\n", lib);
+        free(sim);
+        return NULL;
+    }
+
+    if (sim->cfg.seed == 0) sim->cfg.seed = (uint32_t)_WallUs() | 1u;
+    sim->rng = sim->cfg.seed;
+    sim->wall_base_us = _WallUs();
+    sim->now_us = 0;
+    return sim;
+}
+
+void LoRa_Sim_Destroy(LoRa_Sim_t *sim) {
+    if (!sim) return;
+    for (int i = 0; i < sim->node_count; i++) {
+        _FreeNode(sim->nodes[i]);
+    }
+    if (s_CurSim == sim) {
+        s_CurSim = NULL;
+        s_CurNode = NULL;
+    }
+    free(sim->lib_image);
+    free(sim);
+}
+
+int LoRa_Sim_AddNode(LoRa_Sim_t *sim, const LoRa_SimNodeConfig_t *cfg) {
+    if (!sim || !cfg || sim->node_count >= LORA_SIM_MAX_NODES) return -1;
+
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)calloc(1, sizeof(LoRa_SimNode_t));
+    if (!node) return -1;
+    node->sim = sim;
+    node->index = sim->node_count;
+    node->cfg = *cfg;
+    node->memfd = -1;
+    node->rng = ((uint64_t)sim->cfg.seed << 32) ^ (uint64_t)(node->index + 1) * 0xD1B54A32D192ED03ULL;
+
+    if (!_LoadNodeLib(sim, node)) {
+        fprintf(stderr, "[SIM] Failed to load node %d\n", node->index);
+        _FreeNode(node);
+        return -1;
+    }
+
+    // 模拟 Flash：预置节点的出厂配置
+    memset(&node->flash, 0, sizeof(node->flash));
+    node->flash.magic    = LORA_CFG_MAGIC;
+    node->flash.uuid     = (uint32_t)LoRa_Sim_RandNext(&node->rng);
+    node->flash.net_id   = cfg->net_id;
+    node->flash.group_id = cfg->group_id;
+    node->flash.token    = DEFAULT_LORA_TOKEN;
+    node->flash.hw_addr  = cfg->hw_addr;
+    node->flash.channel  = cfg->channel;
+    node->flash.power    = cfg->power;
+    node->flash.air_rate = cfg->air_rate;
+    node->flash.tmode    = cfg->tmode;
+
+    LoRa_Sim_Module_Init(node);
+    sim->nodes[sim->node_count++] = node;
+
+    _Enter(sim, node);
+    LoRa_Sim_ClockSync(sim);
+    node->OSAL_Init(&s_SimOSAL);
+    node->Port_Bind(&node->ops);
+    node->Service_Init(&s_SimAppCb, cfg->net_id);
+    _Enter(sim, NULL);
+
+    return node->index;
+}
+
+int LoRa_Sim_GetNodeCount(const LoRa_Sim_t *sim) {
+    return sim ? sim->node_count : 0;
+}
+
+// ============================================================
+//                    6. 信道控制
+// ============================================================
+
+void LoRa_Sim_SetLinkLoss(LoRa_Sim_t *sim, int from, int to, double prob) {
+    if (!sim) return;
+    if (prob < 0.0) prob = 0.0;
+    if (prob > 1.0) prob = 1.0;
+    for (int i = 0; i < LORA_SIM_MAX_NODES; i++) {
+        if (from >= 0 && i != from) continue;
+        for (int j = 0; j < LORA_SIM_MAX_NODES; j++) {
+            if (to >= 0 && j != to) continue;
+            sim->link_loss[i][j] = prob;
+        }
+    }
+}
+
+void LoRa_Sim_SetLinkBer(LoRa_Sim_t *sim, int from, int to, double ber) {
+    if (!sim) return;
+    if (ber < 0.0) ber = 0.0;
+    if (ber > 1.0) ber = 1.0;
+    for (int i = 0; i < LORA_SIM_MAX_NODES; i++) {
+        if (from >= 0 && i != from) continue;
+        for (int j = 0; j < LORA_SIM_MAX_NODES; j++) {
+            if (to >= 0 && j != to) continue;
+            sim->link_ber[i][j] = ber;
+        }
+    }
+}
+
+// ============================================================
+//                    7. 运行与业务
+// ============================================================
+
+LoRa_MsgID_t LoRa_Sim_Send(LoRa_Sim_t *sim, int node, const uint8_t *data, uint16_t len,
+                           uint16_t target_id, LoRa_SendOpt_t opt) {
+    if (!sim || node < 0 || node >= sim->node_count) return 0;
+    LoRa_SimNode_t *n = sim->nodes[node];
+    _Enter(sim, n);
+    LoRa_Sim_ClockSync(sim);
+    LoRa_MsgID_t id = n->Service_Send(data, len, target_id, opt);
+    _Enter(sim, NULL);
+    return id;
+}
+
+bool LoRa_Sim_IsBusy(LoRa_Sim_t *sim, int node) {
+    if (!sim || node < 0 || node >= sim->node_count) return false;
+    LoRa_SimNode_t *n = sim->nodes[node];
+    _Enter(sim, n);
+    bool busy = n->Service_IsBusy();
+    _Enter(sim, NULL);
+    return busy;
+}
+
+void LoRa_Sim_RunFor(LoRa_Sim_t *sim, uint32_t ms) {
+    if (!sim) return;
+    uint64_t end = LoRa_Sim_ClockSync(sim) + (uint64_t)ms * 1000ULL;
+
+    while (1) {
+        _Enter(sim, NULL);
+        uint64_t now = LoRa_Sim_ClockSync(sim);
+        if (now >= end) break;
+
+        // 1. 空口：判定已结束的帧
+        LoRa_Sim_Medium_Process(sim);
+
+        // 2. 轮询各节点协议栈，并收集各自建议的休眠时长
+        //    Run 期间 Port 有数据进出 (硬件事件) 的节点需要立即再跑一轮
+        uint64_t wake = end;
+        for (int i = 0; i < sim->node_count; i++) {
+            LoRa_SimNode_t *n = sim->nodes[i];
+            _Enter(sim, n);
+            n->Service_Run();
+
+            uint32_t sleep_ms = n->Port_CheckAndClearHwEvent() ? 0 : n->Service_GetSleepDuration();
+            if (sleep_ms != LORA_TIMEOUT_INFINITE) {
+                uint64_t t = sim->now_us + (uint64_t)sleep_ms * 1000ULL;
+                if (t < wake) wake = t;
+            }
+        }
+        _Enter(sim, NULL);
+
+        // 3. 模组/空口事件
+        uint64_t ev = LoRa_Sim_Medium_NextEventUs(sim);
+        if (ev < wake) wake = ev;
+
+        _ClockWaitUntil(sim, wake);
+    }
+}
+
+uint64_t LoRa_Sim_NowUs(const LoRa_Sim_t *sim) {
+    return sim ? sim->now_us : 0;
+}
+
+uint32_t LoRa_Sim_GetSeed(const LoRa_Sim_t *sim) {
+    return sim ? sim->cfg.seed : 0;
+}
+
+void LoRa_Sim_GetNodeStats(const LoRa_Sim_t *sim, int node, LoRa_SimNodeStats_t *out) {
+    if (!sim || !out || node < 0 || node >= sim->node_count) return;
+    *out = sim->nodes[node]->stats;
+}
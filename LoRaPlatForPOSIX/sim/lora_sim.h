@@ -0,0 +1,176 @@
+/**
+  ******************************************************************************
+  * @file    lora_sim.h
+  * @author  LoRaPlat Team
+  * @brief   多节点虚拟空口仿真器 (单进程)
+  *          - 每个节点加载一份独立的协议栈副本 (独立的 Manager/FSM 状态)
+  *          - 仿真 ATK-LORA-01 模组：配置模式 AT 应答、UART 字节时序、AUX 忙闲
+  *          - 共享空口：按 LoRa_AirRate_t 计算空中时间 (Time-on-Air)、半双工、
+  *            碰撞与捕获效应、按距离的路径损耗、逐链路丢包率
+  *          - 默认使用虚拟时钟：无事可做时直接跳到下一个事件 (ACK 超时、重传
+  *            退避、去重 TTL、软重启倒计时)，相同种子下运行结果逐位一致
+  * @note    仿真器非线程安全，所有 API 需在同一线程调用。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_SIM_H
+#define __LORA_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LoRaPlatConfig.h"
+#include "lora_service.h"
+
+// ============================================================
+//                    1. 配置结构体
+// ============================================================
+
+/** @brief 仿真器句柄 */
+typedef struct LoRa_Sim LoRa_Sim_t;
+
+/**
+ * @brief 仿真器全局配置
+ */
+typedef struct {
+    const char *node_lib;        /*!< 节点协议栈动态库路径 (NULL=使用构建目录默认值) */
+    uint32_t    seed;            /*!< 随机种子 (0=按时间生成) */
+    double      path_loss_exp;   /*!< 路径损耗指数 n (自由空间=2.0, 城区约 2.7~3.5) */
+    double      capture_db;      /*!< 捕获效应门限 (dB)，强信号高出该值可存活 */
+    double      noise_figure_db; /*!< 接收机噪声系数 (dB)，用于计算灵敏度 */
+    bool        realtime;        /*!< false=虚拟时间 (默认，离散事件跳跃推进，可按种子复现)
+                                      true=跟随墙钟 (便于与真实节点/人工交互) */
+    bool        verbose;         /*!< true=输出各节点协议栈日志到 stderr */
+} LoRa_SimConfig_t;
+
+/**
+ * @brief 仿真节点配置
+ */
+typedef struct {
+    uint16_t net_id;             /*!< 逻辑 ID */
+    uint16_t group_id;           /*!< 组 ID */
+    uint16_t hw_addr;            /*!< 模组地址 */
+    uint8_t  channel;            /*!< 信道 (0-31) */
+    uint8_t  air_rate;           /*!< 空速 (LoRa_AirRate_t) */
+    uint8_t  power;              /*!< 功率 (LoRa_Power_t) */
+    uint8_t  tmode;              /*!< 传输模式 (LoRa_TMode_t) */
+    double   x_m;                /*!< 坐标 X (米) */
+    double   y_m;                /*!< 坐标 Y (米) */
+} LoRa_SimNodeConfig_t;
+
+/**
+ * @brief 应用层回调 (node 为节点下标)
+ */
+typedef struct {
+    void (*OnRecv)(void *user, int node, uint16_t src_id, const uint8_t *data, uint16_t len);
+    void (*OnEvent)(void *user, int node, LoRa_Event_t event, void *arg);
+    void *user;
+} LoRa_SimAppCb_t;
+
+/**
+ * @brief 节点空口统计 (接收侧计数按 "接收节点 x 空中帧" 统计)
+ */
+typedef struct {
+    uint32_t frames_tx;          /*!< 发射帧数 */
+    uint32_t bytes_tx;           /*!< 发射字节数 (空中) */
+    uint64_t airtime_us;         /*!< 累计发射空中时间 */
+    uint32_t tx_dropped;         /*!< 模组发送缓冲溢出丢弃的帧数 */
+    uint32_t frames_retx;        /*!< [新增] 重传的数据帧数 (同一目标、同一序号的数据帧再次发射) */
+    uint32_t frames_rx;          /*!< 成功接收帧数 */
+    uint32_t lost_collision;     /*!< 碰撞丢失 (未满足捕获门限) */
+    uint32_t lost_halfduplex;    /*!< 自身发射期间到达而丢失 */
+    uint32_t lost_weak;          /*!< 信号低于灵敏度 */
+    uint32_t lost_link;          /*!< 逐链路丢包率导致的丢失 */
+    uint32_t frames_corrupted;   /*!< [新增] 带误码交付的帧数 (逐链路误码率) */
+    uint32_t bit_errors;         /*!< [新增] 注入的误码比特数 */
+} LoRa_SimNodeStats_t;
+
+// ============================================================
+//                    2. 生命周期
+// ============================================================
+
+void LoRa_Sim_DefaultConfig(LoRa_SimConfig_t *cfg);
+void LoRa_Sim_DefaultNodeConfig(LoRa_SimNodeConfig_t *cfg, uint16_t net_id);
+
+/**
+ * @brief  创建仿真器
+ * @return 句柄，失败返回 NULL (例如节点动态库无法读取)
+ */
+LoRa_Sim_t* LoRa_Sim_Create(const LoRa_SimConfig_t *cfg, const LoRa_SimAppCb_t *cb);
+
+void LoRa_Sim_Destroy(LoRa_Sim_t *sim);
+
+/**
+ * @brief  添加节点 (加载独立协议栈副本并执行 LoRa_Service_Init)
+ * @return 节点下标 (>=0)，失败返回 -1
+ */
+int LoRa_Sim_AddNode(LoRa_Sim_t *sim, const LoRa_SimNodeConfig_t *cfg);
+
+int LoRa_Sim_GetNodeCount(const LoRa_Sim_t *sim);
+
+// ============================================================
+//                    3. 信道控制
+// ============================================================
+
+/**
+ * @brief  设置逐链路丢包率
+ * @param  from/to: 节点下标，-1 表示全部
+ * @param  prob: 丢包概率 (0.0 ~ 1.0)
+ */
+void LoRa_Sim_SetLinkLoss(LoRa_Sim_t *sim, int from, int to, double prob);
+
+/**
+ * @brief  [新增] 设置逐链路误码率
+ * @note   模拟关闭了射频 CRC 的模组：帧照常经串口交付，但每个比特以 ber 的概率独立翻转，
+ *         由协议栈的 CRC / FEC 负责检出或纠正。
+ * @param  from/to: 节点下标，-1 表示全部
+ * @param  ber: 比特错误率 (0.0 ~ 1.0)
+ */
+void LoRa_Sim_SetLinkBer(LoRa_Sim_t *sim, int from, int to, double ber);
+
+/**
+ * @brief  查询 from 发射时在 to 处的接收功率 (dBm)
+ */
+double LoRa_Sim_GetRssi(const LoRa_Sim_t *sim, int from, int to);
+
+/**
+ * @brief  计算空中时间 (Semtech SX127x 公式，CR4/5，8 符号前导码)
+ * @param  air_rate: LoRa_AirRate_t
+ * @param  len: 空中负载字节数
+ * @return 微秒
+ */
+uint32_t LoRa_Sim_TimeOnAirUs(uint8_t air_rate, uint16_t len);
+
+// ============================================================
+//                    4. 运行与业务
+// ============================================================
+
+/**
+ * @brief  在节点上调用 LoRa_Service_Send
+ */
+LoRa_MsgID_t LoRa_Sim_Send(LoRa_Sim_t *sim, int node, const uint8_t *data, uint16_t len,
+                           uint16_t target_id, LoRa_SendOpt_t opt);
+
+/**
+ * @brief  查询节点 LoRa_Service_IsBusy
+ */
+bool LoRa_Sim_IsBusy(LoRa_Sim_t *sim, int node);
+
+/**
+ * @brief  推进仿真 (轮询所有节点的 LoRa_Service_Run 并处理空口事件)
+ * @param  ms: 仿真时长
+ */
+void LoRa_Sim_RunFor(LoRa_Sim_t *sim, uint32_t ms);
+
+/**
+ * @brief  当前仿真时间 (微秒，自 Create 起)
+ */
+uint64_t LoRa_Sim_NowUs(const LoRa_Sim_t *sim);
+
+/**
+ * @brief  实际使用的随机种子 (配置为 0 时返回自动生成的值，用于复现)
+ */
+uint32_t LoRa_Sim_GetSeed(const LoRa_Sim_t *sim);
+
+void LoRa_Sim_GetNodeStats(const LoRa_Sim_t *sim, int node, LoRa_SimNodeStats_t *out);
+
+#endif // __LORA_SIM_H
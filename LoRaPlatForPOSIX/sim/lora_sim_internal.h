@@ -0,0 +1,171 @@
+/**
+  ******************************************************************************
+  * @file    lora_sim_internal.h
+  * @author  LoRaPlat Team
+  * @brief   仿真器内部数据结构 (仅供 sim/ 目录内部使用)
+  ******************************************************************************
+  */
+
+#ifndef __LORA_SIM_INTERNAL_H
+#define __LORA_SIM_INTERNAL_H
+
+#include "lora_sim.h"
+#include "lora_sim_port.h"
+#include "lora_osal.h"
+#include "lora_manager_protocol.h"
+
+// ============================================================
+//                    1. 容量与模组参数
+// ============================================================
+
+#define LORA_SIM_MAX_NODES          64      /*!< 最大节点数 */
+#define LORA_SIM_MAX_FRAMES         256     /*!< 空口上同时跟踪的最大帧数 */
+#define LORA_SIM_RX_CHUNKS          16      /*!< 模组串口输出队列深度 (帧) */
+#define LORA_SIM_AIR_MAX_LEN        255     /*!< LoRa 单帧最大负载 */
+
+#define LORA_SIM_MODULE_PROC_US     3000    /*!< 模组内部处理时延 (串口收完 -> 起射 / 空中收完 -> 串口输出) */
+#define LORA_SIM_REBOOT_US          150000  /*!< MD0 拉低后模组重启时长 (AUX 保持高电平) */
+#define LORA_SIM_AT_RESP_US         1000    /*!< AT 指令应答时延 */
+#define LORA_SIM_MODULE_TX_BUF      512     /*!< 模组发送缓冲 (尚未上空口的字节数上限) */
+#define LORA_SIM_TX_HISTORY         32      /*!< 识别重传时回看的最近数据帧数 (每节点) */
+
+/**
+ * @brief 虚拟时间模式下每次 GetTick 调用消耗的时间
+ * @note  驱动/AT 引擎中存在 "while (GetTick() - start < timeout)" 形式的忙等，
+ *        虚拟时钟必须随轮询推进，否则忙等永不结束。
+ */
+#define LORA_SIM_TICK_COST_US       10
+
+// ============================================================
+//                    2. 内部结构体
+// ============================================================
+
+/**
+ * @brief 空中帧
+ */
+typedef struct {
+    int      src;                   /*!< 发射节点下标 */
+    uint8_t  channel;               /*!< 信道 */
+    uint8_t  air_rate;              /*!< 空速 */
+    bool     fixed;                 /*!< 定点模式帧 */
+    uint16_t src_addr;              /*!< 发射模组地址 */
+    uint16_t dst_addr;              /*!< 定点模式目标地址 */
+    double   tx_dbm;                /*!< 发射功率 */
+    uint64_t start_us;              /*!< 起射时刻 */
+    uint64_t end_us;                /*!< 结束时刻 */
+    bool     evaluated;             /*!< 已完成接收判定 */
+    uint16_t len;
+    uint8_t  data[LORA_SIM_AIR_MAX_LEN];
+} LoRa_SimFrame_t;
+
+/**
+ * @brief 模组串口输出块 (逐字节按波特率放出)
+ */
+typedef struct {
+    uint8_t  data[LORA_SIM_AIR_MAX_LEN];
+    uint16_t len;
+    uint16_t pos;                   /*!< 已被 MCU 读走的字节数 */
+    uint64_t t0_us;                 /*!< 第一个字节开始输出的时刻 */
+    uint32_t byte_us;               /*!< 输出时的字节时间 */
+} LoRa_SimRxChunk_t;
+
+typedef struct LoRa_SimNode LoRa_SimNode_t;
+
+/**
+ * @brief 仿真节点 (模组模型 + 协议栈副本)
+ */
+struct LoRa_SimNode {
+    LoRa_Sim_t          *sim;
+    int                  index;
+    LoRa_SimNodeConfig_t cfg;
+
+    // --- 模组状态 (由 AT 指令配置) ---
+    struct {
+        uint16_t addr;
+        uint8_t  channel;
+        uint8_t  air_rate;
+        uint8_t  power;
+        uint8_t  tmode;
+        uint32_t baud;              /*!< MCU 侧 UART 当前波特率 */
+        bool     md0;
+        uint64_t reboot_until_us;
+        uint64_t uart_tx_done_us;   /*!< MCU -> 模组 串口传输完成时刻 */
+        uint64_t air_free_us;       /*!< 本模组最后一帧发射结束时刻 */
+        char     at_buf[64];
+        uint16_t at_len;
+    } mod;
+
+    // --- 模组 -> MCU 串口输出 ---
+    LoRa_SimRxChunk_t rx[LORA_SIM_RX_CHUNKS];
+    uint8_t           rx_head;
+    uint8_t           rx_count;
+    uint64_t          rx_out_until_us;
+
+    // --- 最近发射的数据帧 (目标, 序号)，用于统计重传 ---
+    struct {
+        uint16_t target;
+        uint16_t seq;
+    } tx_hist[LORA_SIM_TX_HISTORY];
+    uint8_t           tx_hist_pos;
+    uint8_t           tx_hist_count;
+
+    uint64_t             rng;       /*!< 节点熵源状态 */
+    LoRa_Config_t        flash;     /*!< 模拟 Flash */
+    LoRa_SimNodeStats_t  stats;
+    LoRa_SimPortOps_t    ops;
+
+    // --- 节点协议栈副本 ---
+    void *dl;
+    int   memfd;
+    bool         (*OSAL_Init)(const LoRa_OSAL_Interface_t *impl);
+    void         (*Port_Bind)(const LoRa_SimPortOps_t *ops);
+    void         (*Service_Init)(const LoRa_Callback_t *callbacks, uint16_t override_net_id);
+    void         (*Service_Run)(void);
+    LoRa_MsgID_t (*Service_Send)(const uint8_t *data, uint16_t len, uint16_t target_id, LoRa_SendOpt_t opt);
+    uint32_t     (*Service_GetSleepDuration)(void);
+    bool         (*Service_IsBusy)(void);
+    bool         (*Port_CheckAndClearHwEvent)(void);
+    uint16_t     (*Protocol_PeekFrame)(const uint8_t *buffer, uint16_t length, uint8_t tmode, LoRa_FrameInfo_t *info);
+};
+
+/**
+ * @brief 仿真器实例
+ */
+struct LoRa_Sim {
+    LoRa_SimConfig_t cfg;
+    LoRa_SimAppCb_t  app;
+
+    uint8_t *lib_image;             /*!< 节点动态库镜像 (每个节点写入独立 memfd) */
+    size_t   lib_size;
+
+    uint64_t now_us;                /*!< 仿真时钟 */
+    uint64_t wall_base_us;          /*!< 实时模式下的墙钟基准 */
+    uint64_t rng;                   /*!< 空口随机数状态 */
+
+    LoRa_SimNode_t *nodes[LORA_SIM_MAX_NODES];
+    int             node_count;
+
+    double link_loss[LORA_SIM_MAX_NODES][LORA_SIM_MAX_NODES];
+    double link_ber[LORA_SIM_MAX_NODES][LORA_SIM_MAX_NODES];
+
+    LoRa_SimFrame_t frames[LORA_SIM_MAX_FRAMES];
+    int             frame_count;
+};
+
+// ============================================================
+//                    3. 内部接口
+// ============================================================
+
+// --- 时钟 (lora_sim.c) ---
+uint64_t LoRa_Sim_ClockSync(LoRa_Sim_t *sim);
+
+// --- 随机数 (lora_sim_medium.c) ---
+uint64_t LoRa_Sim_RandNext(uint64_t *state);
+double   LoRa_Sim_RandUnit(uint64_t *state);
+
+// --- 模组与空口 (lora_sim_medium.c) ---
+void     LoRa_Sim_Module_Init(LoRa_SimNode_t *node);
+void     LoRa_Sim_Medium_Process(LoRa_Sim_t *sim);
+uint64_t LoRa_Sim_Medium_NextEventUs(const LoRa_Sim_t *sim);
+
+#endif // __LORA_SIM_INTERNAL_H
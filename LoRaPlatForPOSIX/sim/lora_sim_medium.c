@@ -0,0 +1,539 @@
+/**
+  ******************************************************************************
+  * @file    lora_sim_medium.c
+  * @author  LoRaPlat Team
+  * @brief   ATK-LORA-01 模组模型 + 共享空口模型
+  *          模组：配置模式 AT 解析、UART 字节时序、AUX 忙闲、定点/透传寻址
+  *          空口：Time-on-Air、半双工、碰撞/捕获、路径损耗、逐链路丢包
+  *          所有状态按 "查询时刻" 惰性推进，不依赖轮询频率。
+  ******************************************************************************
+  */
+
+#include "lora_sim_internal.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================
+//                    1. 物理层参数表
+// ============================================================
+
+/**
+ * @brief 空速 -> LoRa 调制参数 (ATK-LORA-01 未公开具体 SF/BW，按标称速率近似)
+ */
+typedef struct {
+    uint8_t sf;
+    double  bw_hz;
+    double  snr_limit_db;           /*!< 该 SF 的解调门限 */
+} AirRateParam_t;
+
+static const AirRateParam_t s_RateTable[] = {
+    [LORA_RATE_0K3]  = { 12, 125000.0, -20.0 },
+    [LORA_RATE_1K2]  = { 11, 250000.0, -17.5 },
+    [LORA_RATE_2K4]  = { 11, 500000.0, -17.5 },
+    [LORA_RATE_4K8]  = { 10, 500000.0, -15.0 },
+    [LORA_RATE_9K6]  = {  9, 500000.0, -12.5 },
+    [LORA_RATE_19K2] = {  7, 500000.0,  -7.5 },
+};
+
+#define RATE_COUNT  (sizeof(s_RateTable) / sizeof(s_RateTable[0]))
+
+static const double s_PowerDbm[] = { 11.0, 14.0, 17.0, 20.0 };
+
+static const AirRateParam_t* _RateParam(uint8_t air_rate) {
+    return &s_RateTable[(air_rate < RATE_COUNT) ? air_rate : LORA_RATE_19K2];
+}
+
+uint32_t LoRa_Sim_TimeOnAirUs(uint8_t air_rate, uint16_t len) {
+    const AirRateParam_t *p = _RateParam(air_rate);
+    double t_sym = (double)(1u << p->sf) / p->bw_hz;
+    int de = (t_sym > 0.016) ? 1 : 0;           // 低速率优化
+    const int cr = 1, preamble = 8;             // CR 4/5, 显式头, 开启 CRC
+
+    double num = 8.0 * len - 4.0 * p->sf + 28 + 16;
+    double den = 4.0 * (p->sf - 2 * de);
+    double n_payload = 8 + fmax(ceil(num / den) * (cr + 4), 0.0);
+    double t = (preamble + 4.25) * t_sym + n_payload * t_sym;
+    return (uint32_t)(t * 1e6);
+}
+
+static double _SensitivityDbm(uint8_t air_rate, double nf_db) {
+    const AirRateParam_t *p = _RateParam(air_rate);
+    return -174.0 + 10.0 * log10(p->bw_hz) + nf_db + p->snr_limit_db;
+}
+
+// ============================================================
+//                    2. 随机数 (splitmix64)
+// ============================================================
+
+uint64_t LoRa_Sim_RandNext(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+double LoRa_Sim_RandUnit(uint64_t *state) {
+    return (double)(LoRa_Sim_RandNext(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ============================================================
+//                    3. 传播模型
+// ============================================================
+
+static double _PathLossDb(const LoRa_Sim_t *sim, const LoRa_SimNode_t *a, const LoRa_SimNode_t *b, uint8_t channel) {
+    double dx = a->cfg.x_m - b->cfg.x_m;
+    double dy = a->cfg.y_m - b->cfg.y_m;
+    double d  = sqrt(dx * dx + dy * dy);
+    if (d < 1.0) d = 1.0;
+    double f_mhz = 410.0 + channel;             // ATK-LORA-01: 410 + CH (MHz)
+    double pl_1m = 20.0 * log10(f_mhz) - 27.55; // 1 米处自由空间损耗
+    return pl_1m + 10.0 * sim->cfg.path_loss_exp * log10(d);
+}
+
+double LoRa_Sim_GetRssi(const LoRa_Sim_t *sim, int from, int to) {
+    if (!sim || from < 0 || to < 0 || from >= sim->node_count || to >= sim->node_count) return -200.0;
+    const LoRa_SimNode_t *a = sim->nodes[from];
+    const LoRa_SimNode_t *b = sim->nodes[to];
+    return s_PowerDbm[a->mod.power & 0x03] - _PathLossDb(sim, a, b, a->mod.channel);
+}
+
+// ============================================================
+//                    4. 模组模型：串口输出
+// ============================================================
+
+static uint32_t _ByteUs(uint32_t baud) {
+    return (baud > 0) ? (10000000u + baud - 1) / baud : 1000; // 8N1 = 10 bit
+}
+
+// 将一段数据放入模组 -> MCU 串口输出队列
+static void _RxEnqueue(LoRa_SimNode_t *node, const uint8_t *data, uint16_t len, uint64_t ready_us) {
+    if (node->rx_count >= LORA_SIM_RX_CHUNKS || len == 0) return; // 模组缓冲满，丢弃
+    uint8_t idx = (uint8_t)((node->rx_head + node->rx_count) % LORA_SIM_RX_CHUNKS);
+    LoRa_SimRxChunk_t *c = &node->rx[idx];
+
+    if (len > LORA_SIM_AIR_MAX_LEN) len = LORA_SIM_AIR_MAX_LEN;
+    memcpy(c->data, data, len);
+    c->len = len;
+    c->pos = 0;
+    c->byte_us = _ByteUs(node->mod.baud);
+    c->t0_us = (ready_us > node->rx_out_until_us) ? ready_us : node->rx_out_until_us;
+    node->rx_out_until_us = c->t0_us + (uint64_t)len * c->byte_us;
+    node->rx_count++;
+}
+
+// 当前时刻块内已输出到 MCU 的字节数
+static uint16_t _ChunkAvail(const LoRa_SimRxChunk_t *c, uint64_t now) {
+    if (now < c->t0_us) return 0;
+    uint64_t n = (now - c->t0_us) / c->byte_us;
+    return (n >= c->len) ? c->len : (uint16_t)n;
+}
+
+// ============================================================
+//                    5. 模组模型：AT 指令 (配置模式)
+// ============================================================
+
+static void _AtHandleLine(LoRa_SimNode_t *node, const char *line, uint64_t done_us) {
+    unsigned a = 0, b = 0;
+    bool ok = true;
+
+    if (strcmp(line, "AT") == 0) {
+    } else if (sscanf(line, "AT+ADDR=%x,%x", &a, &b) == 2) {
+        node->mod.addr = (uint16_t)(((a & 0xFF) << 8) | (b & 0xFF));
+    } else if (sscanf(line, "AT+WLRATE=%u,%u", &a, &b) == 2 && a <= 31 && b < RATE_COUNT) {
+        node->mod.channel = (uint8_t)a;
+        node->mod.air_rate = (uint8_t)b;
+    } else if (sscanf(line, "AT+TPOWER=%u", &a) == 1 && a <= 3) {
+        node->mod.power = (uint8_t)a;
+    } else if (sscanf(line, "AT+TMODE=%u", &a) == 1 && a <= 1) {
+        node->mod.tmode = (uint8_t)a;
+    } else if (strncmp(line, "AT+", 3) == 0) {
+        // 其余指令 (UART/CWMODE/WLTIME 等) 仅应答，不影响仿真
+    } else {
+        ok = false;
+    }
+
+    const char *resp = ok ? "OK\r\n" : "ERROR\r\n";
+    _RxEnqueue(node, (const uint8_t *)resp, (uint16_t)strlen(resp), done_us + LORA_SIM_AT_RESP_US);
+}
+
+static void _AtFeed(LoRa_SimNode_t *node, const uint8_t *data, uint16_t len, uint64_t done_us) {
+    for (uint16_t i = 0; i < len; i++) {
+        char ch = (char)data[i];
+        if (ch == '\r') continue;
+        if (ch == '\n') {
+            node->mod.at_buf[node->mod.at_len] = '\0';
+            if (node->mod.at_len > 0) _AtHandleLine(node, node->mod.at_buf, done_us);
+            node->mod.at_len = 0;
+        } else if (node->mod.at_len < sizeof(node->mod.at_buf) - 1) {
+            node->mod.at_buf[node->mod.at_len++] = ch;
+        }
+    }
+}
+
+// ============================================================
+//                    6. 模组模型：发射 (MCU -> 空口)
+// ============================================================
+
+static bool _IsNormalMode(const LoRa_SimNode_t *node, uint64_t t) {
+    return !node->mod.md0 && t >= node->mod.reboot_until_us;
+}
+
+// [新增] 用节点自身的协议栈读取帧头：同一目标、同一序号的数据帧再次发射即为重传
+static void _CountRetx(LoRa_SimNode_t *node, const uint8_t *data, uint16_t len) {
+    LoRa_FrameInfo_t info;
+    if (!node->Protocol_PeekFrame || node->Protocol_PeekFrame(data, len, 0, &info) == 0) return;
+    if (info.Ctrl & LORA_CTRL_MASK_TYPE) return; // ACK/NACK
+
+    uint16_t seq = info.SeqShort ? (info.Sequence & 0xFF) : info.Sequence;
+    for (uint8_t i = 0; i < node->tx_hist_count; i++) {
+        if (node->tx_hist[i].target == info.TargetID && node->tx_hist[i].seq == seq) {
+            node->stats.frames_retx++;
+            return;
+        }
+    }
+    node->tx_hist[node->tx_hist_pos].target = info.TargetID;
+    node->tx_hist[node->tx_hist_pos].seq = seq;
+    node->tx_hist_pos = (uint8_t)((node->tx_hist_pos + 1) % LORA_SIM_TX_HISTORY);
+    if (node->tx_hist_count < LORA_SIM_TX_HISTORY) node->tx_hist_count++;
+}
+
+static void _AirSchedule(LoRa_SimNode_t *node, const uint8_t *data, uint16_t len, uint64_t uart_done) {
+    LoRa_Sim_t *sim = node->sim;
+    LoRa_SimFrame_t *f;
+
+    if (sim->frame_count >= LORA_SIM_MAX_FRAMES) return; // 空口表溢出，视为模组丢包
+    f = &sim->frames[sim->frame_count];
+    memset(f, 0, sizeof(*f));
+
+    f->src      = node->index;
+    f->channel  = node->mod.channel;
+    f->air_rate = node->mod.air_rate;
+    f->src_addr = node->mod.addr;
+    f->tx_dbm   = s_PowerDbm[node->mod.power & 0x03];
+    f->fixed    = (node->mod.tmode == LORA_TMODE_FIXED);
+
+    // 定点模式：前 3 字节 (地址高/低, 信道) 由模组消耗，不上空口
+    if (f->fixed) {
+        if (len <= 3) return;
+        f->dst_addr = (uint16_t)((data[0] << 8) | data[1]);
+        f->channel  = data[2] & 0x1F;
+        data += 3;
+        len  -= 3;
+    }
+    if (len > LORA_SIM_AIR_MAX_LEN) len = LORA_SIM_AIR_MAX_LEN;
+
+    // 模组发送缓冲：尚未起射的帧占用缓冲，溢出则丢弃
+    uint32_t queued = 0;
+    for (int i = 0; i < sim->frame_count; i++) {
+        if (sim->frames[i].src == node->index && sim->frames[i].start_us > uart_done) queued += sim->frames[i].len;
+    }
+    if (queued + len > LORA_SIM_MODULE_TX_BUF) {
+        node->stats.tx_dropped++;
+        return;
+    }
+
+    memcpy(f->data, data, len);
+    f->len = len;
+
+    uint64_t start = uart_done + LORA_SIM_MODULE_PROC_US;
+    if (start < node->mod.air_free_us) start = node->mod.air_free_us; // 模组内部排队
+    f->start_us = start;
+    f->end_us   = start + LoRa_Sim_TimeOnAirUs(f->air_rate, len);
+    node->mod.air_free_us = f->end_us;
+
+    node->stats.frames_tx++;
+    node->stats.bytes_tx += len;
+    _CountRetx(node, f->data, len);
+    node->stats.airtime_us += f->end_us - f->start_us;
+    sim->frame_count++;
+}
+
+// ============================================================
+//                    7. Port 操作表实现
+// ============================================================
+
+static void _Op_SetBaud(void *ctx, uint32_t baudrate) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    node->mod.baud = baudrate;
+}
+
+static void _Op_SetMD0(void *ctx, bool level) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    if (node->mod.md0 && !level) {
+        node->mod.reboot_until_us = now + LORA_SIM_REBOOT_US; // 退出配置模式，模组重启
+    }
+    if (!node->mod.md0 && level) {
+        node->mod.at_len = 0;
+    }
+    node->mod.md0 = level;
+}
+
+static bool _Op_GetAUX(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    if (now < node->mod.reboot_until_us) return true;
+    if (node->mod.md0) return false;
+    return (now < node->mod.air_free_us) || (now < node->rx_out_until_us);
+}
+
+// [新增] AUX 最近一次下降沿：已过去的忙时段 (重启/发射/串口输出) 中最晚的结束时刻
+static uint32_t _Op_GetAuxIdleTick(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    uint64_t ends[3] = { node->mod.reboot_until_us, node->mod.air_free_us, node->rx_out_until_us };
+    uint64_t edge = 0;
+    for (int i = 0; i < 3; i++) {
+        if (ends[i] <= now && ends[i] > edge) edge = ends[i];
+    }
+    return (uint32_t)(edge / 1000ULL);
+}
+
+static bool _Op_IsTxBusy(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    return LoRa_Sim_ClockSync(node->sim) < node->mod.uart_tx_done_us;
+}
+
+static uint16_t _Op_Transmit(void *ctx, const uint8_t *data, uint16_t len) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    if (now < node->mod.uart_tx_done_us) return 0;
+
+    uint64_t done = now + (uint64_t)len * _ByteUs(node->mod.baud);
+    node->mod.uart_tx_done_us = done;
+
+    if (node->mod.md0) {
+        _AtFeed(node, data, len, done);
+    } else if (_IsNormalMode(node, done)) {
+        _AirSchedule(node, data, len, done);
+    }
+    return len;
+}
+
+static uint16_t _Op_Receive(void *ctx, uint8_t *buf, uint16_t max_len) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    uint16_t total = 0;
+
+    LoRa_Sim_Medium_Process(node->sim);
+
+    while (node->rx_count > 0 && total < max_len) {
+        LoRa_SimRxChunk_t *c = &node->rx[node->rx_head];
+        uint16_t avail = _ChunkAvail(c, now);
+        if (avail <= c->pos) break;
+
+        uint16_t n = avail - c->pos;
+        if (n > max_len - total) n = max_len - total;
+        memcpy(buf + total, c->data + c->pos, n);
+        c->pos += n;
+        total  += n;
+
+        if (c->pos < c->len) break;
+        node->rx_head = (uint8_t)((node->rx_head + 1) % LORA_SIM_RX_CHUNKS);
+        node->rx_count--;
+    }
+    return total;
+}
+
+static bool _Op_HasRxData(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    LoRa_Sim_Medium_Process(node->sim);
+    if (node->rx_count == 0) return false;
+    const LoRa_SimRxChunk_t *c = &node->rx[node->rx_head];
+    return _ChunkAvail(c, now) > c->pos;
+}
+
+// 清空 MCU 侧已收到的数据 (尚未从模组输出的字节不受影响)
+static void _Op_ClearRx(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    uint64_t now = LoRa_Sim_ClockSync(node->sim);
+    while (node->rx_count > 0) {
+        LoRa_SimRxChunk_t *c = &node->rx[node->rx_head];
+        c->pos = _ChunkAvail(c, now);
+        if (c->pos < c->len) break;
+        node->rx_head = (uint8_t)((node->rx_head + 1) % LORA_SIM_RX_CHUNKS);
+        node->rx_count--;
+    }
+}
+
+static uint32_t _Op_GetEntropy32(void *ctx) {
+    LoRa_SimNode_t *node = (LoRa_SimNode_t *)ctx;
+    return (uint32_t)(LoRa_Sim_RandNext(&node->rng) >> 32);
+}
+
+void LoRa_Sim_Module_Init(LoRa_SimNode_t *node) {
+    memset(&node->mod, 0, sizeof(node->mod));
+    node->mod.addr     = node->cfg.hw_addr;
+    node->mod.channel  = node->cfg.channel;
+    node->mod.air_rate = node->cfg.air_rate;
+    node->mod.power    = node->cfg.power;
+    node->mod.tmode    = node->cfg.tmode;
+    node->mod.baud     = LORA_TARGET_BAUDRATE;
+    node->rx_head = 0;
+    node->rx_count = 0;
+    node->rx_out_until_us = 0;
+
+    node->ops.ctx          = node;
+    node->ops.SetBaud      = _Op_SetBaud;
+    node->ops.SetMD0       = _Op_SetMD0;
+    node->ops.GetAUX       = _Op_GetAUX;
+    node->ops.GetAuxIdleTick = _Op_GetAuxIdleTick;
+    node->ops.IsTxBusy     = _Op_IsTxBusy;
+    node->ops.Transmit     = _Op_Transmit;
+    node->ops.Receive      = _Op_Receive;
+    node->ops.HasRxData    = _Op_HasRxData;
+    node->ops.ClearRx      = _Op_ClearRx;
+    node->ops.GetEntropy32 = _Op_GetEntropy32;
+}
+
+// ============================================================
+//                    8. 空口接收判定
+// ============================================================
+
+static bool _Overlap(const LoRa_SimFrame_t *a, const LoRa_SimFrame_t *b) {
+    return a->start_us < b->end_us && b->start_us < a->end_us;
+}
+
+// 模组地址过滤 (硬件层)
+static bool _AddrMatch(const LoRa_SimFrame_t *f, const LoRa_SimNode_t *rx) {
+    if (rx->mod.addr == 0xFFFF) return true;
+    if (f->fixed) return (f->dst_addr == rx->mod.addr) || (f->dst_addr == 0xFFFF);
+    return (f->src_addr == rx->mod.addr) || (f->src_addr == 0xFFFF);
+}
+
+// 以误码率 ber 独立翻转每个比特 (按几何分布跳到下一个错误比特)，返回翻转的比特数
+static uint32_t _FlipBits(LoRa_Sim_t *sim, const uint8_t *in, uint8_t *out, uint16_t len, double ber) {
+    uint32_t bits = (uint32_t)len * 8, flips = 0;
+    double   log_keep = log1p(-ber);
+    uint32_t pos = 0;
+
+    memcpy(out, in, len);
+    while (1) {
+        double u = LoRa_Sim_RandUnit(&sim->rng);
+        double skip = (ber >= 1.0) ? 0.0 : floor(log(1.0 - u) / log_keep);
+        if (skip >= (double)(bits - pos)) break;
+        pos += (uint32_t)skip;
+        out[pos / 8] ^= (uint8_t)(0x80 >> (pos % 8));
+        flips++;
+        if (++pos >= bits) break;
+    }
+    return flips;
+}
+
+static void _EvaluateFrame(LoRa_Sim_t *sim, LoRa_SimFrame_t *f) {
+    LoRa_SimNode_t *tx = sim->nodes[f->src];
+
+    for (int r = 0; r < sim->node_count; r++) {
+        if (r == f->src) continue;
+        LoRa_SimNode_t *rx = sim->nodes[r];
+
+        // 1. 接收机未在该信道/空速监听，或处于配置/重启状态：不可见
+        if (!_IsNormalMode(rx, f->start_us)) continue;
+        if (rx->mod.channel != f->channel || rx->mod.air_rate != f->air_rate) continue;
+        if (!_AddrMatch(f, rx)) continue;
+
+        // 2. 灵敏度
+        double rssi = f->tx_dbm - _PathLossDb(sim, tx, rx, f->channel);
+        if (rssi < _SensitivityDbm(f->air_rate, sim->cfg.noise_figure_db)) {
+            rx->stats.lost_weak++;
+            continue;
+        }
+
+        // 3. 半双工 / 碰撞 (捕获效应)
+        bool half_duplex = false, collided = false;
+        for (int i = 0; i < sim->frame_count; i++) {
+            const LoRa_SimFrame_t *g = &sim->frames[i];
+            if (g == f || !_Overlap(f, g)) continue;
+            if (g->src == r) { half_duplex = true; break; }
+            if (g->channel != f->channel) continue;
+            double p_g = g->tx_dbm - _PathLossDb(sim, sim->nodes[g->src], rx, g->channel);
+            if (rssi < p_g + sim->cfg.capture_db) collided = true;
+        }
+        if (half_duplex) { rx->stats.lost_halfduplex++; continue; }
+        if (collided)    { rx->stats.lost_collision++;  continue; }
+
+        // 4. 逐链路随机丢包
+        double p_loss = sim->link_loss[f->src][r];
+        if (p_loss > 0.0 && LoRa_Sim_RandUnit(&sim->rng) < p_loss) {
+            rx->stats.lost_link++;
+            continue;
+        }
+
+        // 5. 成功：模组处理后经串口输出 (按链路误码率翻转比特)
+        rx->stats.frames_rx++;
+        double ber = sim->link_ber[f->src][r];
+        if (ber > 0.0) {
+            uint8_t  air[LORA_SIM_AIR_MAX_LEN];
+            uint32_t flips = _FlipBits(sim, f->data, air, f->len, ber);
+            if (flips > 0) {
+                rx->stats.frames_corrupted++;
+                rx->stats.bit_errors += flips;
+            }
+            _RxEnqueue(rx, air, f->len, f->end_us + LORA_SIM_MODULE_PROC_US);
+            continue;
+        }
+        _RxEnqueue(rx, f->data, f->len, f->end_us + LORA_SIM_MODULE_PROC_US);
+    }
+    f->evaluated = true;
+}
+
+/**
+ * @brief 处理所有已结束的空中帧 (按结束时间顺序)，并回收不再影响判定的旧帧
+ */
+void LoRa_Sim_Medium_Process(LoRa_Sim_t *sim) {
+    uint64_t now = sim->now_us;
+
+    while (1) {
+        LoRa_SimFrame_t *next = NULL;
+        for (int i = 0; i < sim->frame_count; i++) {
+            LoRa_SimFrame_t *f = &sim->frames[i];
+            if (!f->evaluated && f->end_us <= now && (!next || f->end_us < next->end_us)) next = f;
+        }
+        if (!next) break;
+        _EvaluateFrame(sim, next);
+    }
+
+    // 回收：已判定且早于所有未判定帧起点的帧不会再参与碰撞计算
+    uint64_t horizon = now;
+    for (int i = 0; i < sim->frame_count; i++) {
+        if (!sim->frames[i].evaluated && sim->frames[i].start_us < horizon) horizon = sim->frames[i].start_us;
+    }
+    int w = 0;
+    for (int i = 0; i < sim->frame_count; i++) {
+        if (sim->frames[i].evaluated && sim->frames[i].end_us <= horizon) continue;
+        if (w != i) sim->frames[w] = sim->frames[i];
+        w++;
+    }
+    sim->frame_count = w;
+}
+
+/**
+ * @brief 下一个模组/空口事件时刻 (帧结束、串口字节就绪、AUX 变化)
+ * @return UINT64_MAX 表示没有挂起事件
+ */
+uint64_t LoRa_Sim_Medium_NextEventUs(const LoRa_Sim_t *sim) {
+    uint64_t now = sim->now_us;
+    uint64_t next = UINT64_MAX;
+
+#define _CONSIDER(t)  do { uint64_t _t = (t); if (_t > now && _t < next) next = _t; } while (0)
+
+    for (int i = 0; i < sim->frame_count; i++) {
+        if (!sim->frames[i].evaluated) _CONSIDER(sim->frames[i].end_us);
+    }
+    for (int n = 0; n < sim->node_count; n++) {
+        const LoRa_SimNode_t *node = sim->nodes[n];
+        _CONSIDER(node->mod.reboot_until_us);
+        _CONSIDER(node->mod.uart_tx_done_us);
+        _CONSIDER(node->mod.air_free_us);
+        _CONSIDER(node->rx_out_until_us);
+        if (node->rx_count > 0) {
+            const LoRa_SimRxChunk_t *c = &node->rx[node->rx_head];
+            _CONSIDER(c->t0_us + (uint64_t)c->len * c->byte_us); // 整帧输出完毕
+        }
+    }
+#undef _CONSIDER
+    return next;
+}
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file    lora_sim_port.h
+  * @author  LoRaPlat Team
+  * @brief   仿真器 <-> 节点协议栈 之间的 Port 绑定接口
+  *          每个仿真节点都是一份独立加载的协议栈动态库 (拥有独立的静态变量)，
+  *          其 lora_port.h 实现 (lora_port_sim.c) 通过本接口回调到仿真器中的
+  *          模组/空口模型。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_SIM_PORT_H
+#define __LORA_SIM_PORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief 仿真模组操作表 (由仿真器实现，ctx 为仿真器内部的节点句柄)
+ */
+typedef struct {
+    void     *ctx;
+    void     (*SetBaud)(void *ctx, uint32_t baudrate);
+    void     (*SetMD0)(void *ctx, bool level);
+    bool     (*GetAUX)(void *ctx);
+    uint32_t (*GetAuxIdleTick)(void *ctx);   /*!< [新增] 最近一次 AUX 下降沿时刻 (ms) */
+    bool     (*IsTxBusy)(void *ctx);
+    uint16_t (*Transmit)(void *ctx, const uint8_t *data, uint16_t len);
+    uint16_t (*Receive)(void *ctx, uint8_t *buf, uint16_t max_len);
+    bool     (*HasRxData)(void *ctx);
+    void     (*ClearRx)(void *ctx);
+    uint32_t (*GetEntropy32)(void *ctx);
+} LoRa_SimPortOps_t;
+
+/** @brief 节点动态库导出的绑定函数名 (供 dlsym 使用) */
+#define LORA_SIM_PORT_BIND_SYMBOL   "LoRa_SimPort_Bind"
+
+/**
+ * @brief  绑定仿真模组 (节点动态库导出，必须在 LoRa_Service_Init 之前调用)
+ * @param  ops: 操作表指针 (生命周期由仿真器保证)
+ */
+void LoRa_SimPort_Bind(const LoRa_SimPortOps_t *ops);
+
+#endif // __LORA_SIM_PORT_H
@@ -21,6 +21,14 @@
  */
 uint16_t LoRa_CRC16_Calculate(const uint8_t *data, uint16_t length);
 
+/**
+ * @brief  [新增] 增量计算 CRC16 (逐字节送入，初值 0x0000)
+ * @param  crc: 之前字节的 CRC
+ * @param  byte: 新字节
+ * @return 更新后的 CRC
+ */
+uint16_t LoRa_CRC16_Update(uint16_t crc, uint8_t byte);
+
 /**
  * @brief  校验 CRC16
  * @param  data: 数据指针
@@ -75,6 +75,37 @@ uint16_t LoRa_RingBuffer_Read(LoRa_RingBuffer_t *rb, uint8_t *data, uint16_t max
     return max_length;
 }
 
+uint16_t LoRa_RingBuffer_Peek(const LoRa_RingBuffer_t *rb, uint16_t offset, uint8_t *data, uint16_t max_length) {
+    LORA_CHECK(rb && rb->pBuffer && data && max_length > 0, 0);
+    
+    if (offset >= rb->Count) return 0;
+    if (max_length > rb->Count - offset) max_length = rb->Count - offset;
+    
+    uint16_t start = rb->Tail + offset;
+    if (start >= rb->Size) start -= rb->Size;
+    uint16_t chunk1 = rb->Size - start;
+    
+    if (max_length <= chunk1) {
+        memcpy(data, &rb->pBuffer[start], max_length);
+    } else {
+        memcpy(data, &rb->pBuffer[start], chunk1);
+        memcpy(data + chunk1, &rb->pBuffer[0], max_length - chunk1);
+    }
+    return max_length;
+}
+
+uint16_t LoRa_RingBuffer_Skip(LoRa_RingBuffer_t *rb, uint16_t length) {
+    LORA_CHECK(rb && rb->pBuffer, 0);
+    
+    if (length > rb->Count) length = rb->Count;
+    
+    uint32_t tail = (uint32_t)rb->Tail + length;
+    if (tail >= rb->Size) tail -= rb->Size;
+    rb->Tail = (uint16_t)tail;
+    rb->Count -= length;
+    return length;
+}
+
 void LoRa_RingBuffer_Clear(LoRa_RingBuffer_t *rb) {
     if (!rb) return;
     rb->Head = 0;
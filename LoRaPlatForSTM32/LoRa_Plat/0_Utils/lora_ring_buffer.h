@@ -56,6 +56,24 @@ uint16_t LoRa_RingBuffer_Write(LoRa_RingBuffer_t *rb, const uint8_t *data, uint1
  */
 uint16_t LoRa_RingBuffer_Read(LoRa_RingBuffer_t *rb, uint8_t *data, uint16_t max_length);
 
+/**
+ * @brief  [新增] 预览数据 (不移动读指针)
+ * @param  rb: 句柄
+ * @param  offset: 相对读指针的偏移
+ * @param  data: 目标缓冲区
+ * @param  max_length: 最大读取长度
+ * @return 实际读取长度
+ */
+uint16_t LoRa_RingBuffer_Peek(const LoRa_RingBuffer_t *rb, uint16_t offset, uint8_t *data, uint16_t max_length);
+
+/**
+ * @brief  [新增] 丢弃数据 (只移动读指针，O(1))
+ * @param  rb: 句柄
+ * @param  length: 丢弃长度
+ * @return 实际丢弃长度
+ */
+uint16_t LoRa_RingBuffer_Skip(LoRa_RingBuffer_t *rb, uint16_t length);
+
 /**
  * @brief  清空缓冲区
  */
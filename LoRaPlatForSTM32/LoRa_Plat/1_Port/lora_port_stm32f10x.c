@@ -12,19 +12,27 @@
 #include <string.h>
 
 // --- DMA 缓冲区配置 ---
-#define PORT_DMA_RX_BUF_SIZE 512
-#define PORT_DMA_TX_BUF_SIZE 512
+#define PORT_DMA_RX_BUF_SIZE LORA_PORT_DMA_RX_SIZE
+#define PORT_DMA_TX_BUF_SIZE LORA_PORT_DMA_TX_SIZE
 
 static uint8_t  s_DmaRxBuf[PORT_DMA_RX_BUF_SIZE];
 static uint8_t  s_DmaTxBuf[PORT_DMA_TX_BUF_SIZE];
 static volatile uint16_t s_RxReadIndex = 0;
+// [新增] 接收溢出检测：DMA 写满一圈的次数 (TC 中断累加) 与已消费字节累计，二者之差即未读字节数
+static volatile uint32_t s_RxDmaLaps = 0;
+static uint32_t s_RxReadCount = 0;
+static volatile bool s_RxOverrun = false;
 
 // --- 状态标志 ---
 static volatile bool s_TxDmaBusy = false;
+static bool s_TxLent = false;   // [新增] s_DmaTxBuf 已借出 (Acquire 后、Commit 前)
 
 // [新增] 硬件事件挂起标志 (用于低功耗唤醒判断)
 static volatile bool s_HwEventPending = false;
 
+// [新增] 最近一次 AUX 下降沿时刻 (EXTI 中断中记录)
+static volatile uint32_t s_AuxIdleTick = 0;
+
 // ============================================================
 //                    1. 初始化与配置
 // ============================================================
@@ -91,6 +99,7 @@ void LoRa_Port_Init(uint32_t baudrate)
     DMA_InitStructure.DMA_Priority = DMA_Priority_High;
     DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
     DMA_Init(DMA1_Channel3, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel3, DMA_IT_TC, ENABLE); // [新增] 回绕计数 (溢出检测)
 
     // 5. DMA TX (Normal) -> DMA1_Channel2
     DMA_DeInit(DMA1_Channel2);
@@ -112,6 +121,12 @@ void LoRa_Port_Init(uint32_t baudrate)
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
 
+    // [新增] DMA RX 回绕中断 (必须在 DMA 再写满一圈之前得到处理)
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 2;
+    NVIC_Init(&NVIC_InitStructure);
+
     // [新增] AUX EXTI 中断
     NVIC_InitStructure.NVIC_IRQChannel = EXTI9_5_IRQn;
     NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2; // 优先级稍低
@@ -164,6 +179,10 @@ bool LoRa_Port_GetAUX(void) {
     return (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_5) == 1);
 }
 
+uint32_t LoRa_Port_GetAuxIdleTick(void) {
+    return s_AuxIdleTick;
+}
+
 void LoRa_Port_SyncAuxState(void) {
     uint32_t primask = OSAL_EnterCritical();
     DMA_Cmd(DMA1_Channel2, DISABLE);
@@ -181,17 +200,45 @@ bool LoRa_Port_IsTxBusy(void) {
 }
 
 uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
-    if (len == 0 || len > PORT_DMA_TX_BUF_SIZE) return 0;
+    uint16_t cap;
+    if (!data || len == 0) return 0;
     
+    uint8_t *buf = LoRa_Port_AcquireTxBuffer(&cap);
+    if (!buf) return 0;
+    if (len > cap) {
+        LoRa_Port_CommitTx(0);
+        return 0;
+    }
+    memcpy(buf, data, len);
+    return LoRa_Port_CommitTx(len);
+}
+
+uint8_t *LoRa_Port_AcquireTxBuffer(uint16_t *capacity) {
     uint32_t primask = OSAL_EnterCritical();
 
-    if (s_TxDmaBusy || DMA_GetCurrDataCounter(DMA1_Channel2) != 0) {
+    if (s_TxLent || s_TxDmaBusy || DMA_GetCurrDataCounter(DMA1_Channel2) != 0) {
         OSAL_ExitCritical(primask);
-        return 0; 
+        return NULL; 
+    }
+    s_TxLent = true;
+    
+    OSAL_ExitCritical(primask);
+    if (capacity) *capacity = PORT_DMA_TX_BUF_SIZE;
+    return s_DmaTxBuf;
+}
+
+uint16_t LoRa_Port_CommitTx(uint16_t len) {
+    if (!s_TxLent) return 0;
+    if (len == 0 || len > PORT_DMA_TX_BUF_SIZE) {
+        s_TxLent = false;
+        return 0;
     }
+    
+    uint32_t primask = OSAL_EnterCritical();
 
+    // DMA 只在 Acquire 时检查过空闲，借出期间不会有其他发送者启动它
     s_TxDmaBusy = true;
-    memcpy(s_DmaTxBuf, data, len);
+    s_TxLent = false;
     
     DMA_Cmd(DMA1_Channel2, DISABLE);
     DMA1_Channel2->CNDTR = len;
@@ -208,18 +255,83 @@ uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
 uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
     if (!buf || max_len == 0) return 0;
     
+    // [变更] 按段整块复制，不再逐字节搬运
+    LoRa_PortSpan_t span[2];
     uint16_t cnt = 0;
-    uint16_t dma_write_idx = PORT_DMA_RX_BUF_SIZE - DMA_GetCurrDataCounter(DMA1_Channel3);
-    
-    while (s_RxReadIndex != dma_write_idx && cnt < max_len) {
-        buf[cnt++] = s_DmaRxBuf[s_RxReadIndex++];
-        if (s_RxReadIndex >= PORT_DMA_RX_BUF_SIZE) s_RxReadIndex = 0;
+    LoRa_Port_PeekRx(span);
+    for (int i = 0; i < 2 && cnt < max_len; i++) {
+        uint16_t n = (span[i].len < max_len - cnt) ? span[i].len : (max_len - cnt);
+        memcpy(&buf[cnt], span[i].data, n);
+        cnt += n;
     }
+    LoRa_Port_ConsumeRx(cnt);
     return cnt;
 }
 
+/**
+ * @brief [新增] DMA 累计写入的字节数 (圈数 x 缓冲区大小 + 当前写位置)
+ * @param idx: 输出当前写位置
+ * @note  回绕的 TC 标志已置位、中断尚未处理时补上这一圈 (前后两次读标志一致，计数值才可信)
+ */
+static uint32_t _Port_RxWriteCount(uint16_t *idx) {
+    bool tc, tc_again;
+    uint16_t remain;
+
+    uint32_t primask = OSAL_EnterCritical();
+    do {
+        tc = (DMA_GetFlagStatus(DMA1_FLAG_TC3) != RESET);
+        remain = DMA_GetCurrDataCounter(DMA1_Channel3);
+        tc_again = (DMA_GetFlagStatus(DMA1_FLAG_TC3) != RESET);
+    } while (tc != tc_again);
+    uint32_t laps = s_RxDmaLaps + (tc ? 1 : 0);
+    OSAL_ExitCritical(primask);
+
+    uint16_t pos = PORT_DMA_RX_BUF_SIZE - remain;
+    if (pos >= PORT_DMA_RX_BUF_SIZE) pos = 0;
+    *idx = pos;
+    return laps * PORT_DMA_RX_BUF_SIZE + pos;
+}
+
+uint16_t LoRa_Port_PeekRx(LoRa_PortSpan_t span[2]) {
+    uint16_t dma_write_idx;
+    uint32_t written = _Port_RxWriteCount(&dma_write_idx);
+    uint32_t unread = written - s_RxReadCount;
+
+    // [新增] DMA 已追上读指针 (未读数据被覆盖)：丢弃全部未读数据，由上层重新同步
+    if (unread > PORT_DMA_RX_BUF_SIZE) {
+        s_RxReadIndex = dma_write_idx;
+        s_RxReadCount = written;
+        s_RxOverrun = true;
+        unread = 0;
+    }
+
+    uint16_t rd = s_RxReadIndex;
+    span[0].data = &s_DmaRxBuf[rd];
+    span[1].data = s_DmaRxBuf;
+    // [变更] 按未读字节数划分 (写满整圈时写位置与读位置重合，不能据此判断)
+    span[0].len = (unread < (uint32_t)(PORT_DMA_RX_BUF_SIZE - rd)) ? (uint16_t)unread : (PORT_DMA_RX_BUF_SIZE - rd);
+    span[1].len = (uint16_t)(unread - span[0].len); // DMA 已回绕：头部一段
+    return span[0].len + span[1].len;
+}
+
+void LoRa_Port_ConsumeRx(uint16_t len) {
+    uint16_t rd = s_RxReadIndex + len;
+    if (rd >= PORT_DMA_RX_BUF_SIZE) rd -= PORT_DMA_RX_BUF_SIZE;
+    s_RxReadIndex = rd;
+    s_RxReadCount += len;
+}
+
 void LoRa_Port_ClearRxBuffer(void) {
-    s_RxReadIndex = PORT_DMA_RX_BUF_SIZE - DMA_GetCurrDataCounter(DMA1_Channel3);
+    uint16_t dma_write_idx;
+    s_RxReadCount = _Port_RxWriteCount(&dma_write_idx);
+    s_RxReadIndex = dma_write_idx;
+    s_RxOverrun = false;
+}
+
+bool LoRa_Port_CheckAndClearRxOverrun(void) {
+    bool ret = s_RxOverrun;
+    s_RxOverrun = false;
+    return ret;
 }
 
 // ============================================================
@@ -239,6 +351,12 @@ void LoRa_Port_NotifyHwEvent(void) {
     s_HwEventPending = true;
 }
 
+void LoRa_Port_OnAuxEdge(void) {
+    // 双边沿触发：此刻为低电平即下降沿 (模组发射完毕或串口输出完毕)
+    if (!LoRa_Port_GetAUX()) s_AuxIdleTick = OSAL_GetTick();
+    s_HwEventPending = true;
+}
+
 bool LoRa_Port_CheckAndClearHwEvent(void) {
     uint32_t primask = OSAL_EnterCritical();
     bool ret = s_HwEventPending;
@@ -260,3 +378,11 @@ void DMA1_Channel2_IRQHandler(void) {
         LoRa_Port_NotifyHwEvent(); 
     }
 }
+
+// [新增] DMA RX 写满一圈 (循环模式自动回到缓冲区开头)
+void DMA1_Channel3_IRQHandler(void) {
+    if (DMA_GetITStatus(DMA1_IT_TC3)) {
+        DMA_ClearITPendingBit(DMA1_IT_TC3);
+        s_RxDmaLaps++;
+    }
+}
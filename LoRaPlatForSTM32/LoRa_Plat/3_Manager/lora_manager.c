@@ -1,6 +1,8 @@
 #include "lora_manager.h"
 #include "lora_manager_fsm.h"
 #include "lora_manager_buffer.h"
+#include "lora_manager_frag.h"
+#include "lora_manager_compress.h"
 #include "lora_osal.h"
 #include <string.h>
 
@@ -8,9 +10,6 @@
 //                    内部变量
 // ============================================================
 
-#define RX_WORKSPACE_SIZE  MGR_RX_BUF_SIZE 
-static uint8_t s_RxWorkspace[RX_WORKSPACE_SIZE];
-
 // 保存回调结构体
 static LoRa_Manager_Callback_t s_MgrCb = { NULL, NULL };
 
@@ -28,6 +27,8 @@ typedef struct {
     uint16_t target_id;
     LoRa_SendOpt_t opt;
     LoRa_MsgID_t msg_id; 
+    uint32_t enq_tick;      // [新增] 入队时刻 (聚合等待计时)
+    uint8_t  flags;         // [新增] 附加控制位 (LORA_CTRL_MASK_COMP)
 } TxRequest_t;
 
 static TxRequest_t s_TxQueue[TX_PACKET_QUEUE_SIZE];
@@ -35,6 +36,26 @@ static uint8_t s_TxQ_Head = 0;
 static uint8_t s_TxQ_Tail = 0;
 static uint8_t s_TxQ_Count = 0;
 
+// [新增] 聚合帧：每条子消息前加 1 字节长度
+#define AGG_SUB_HDR_LEN  1
+// [新增] 含压缩子消息的聚合帧 (置 LORA_CTRL_MASK_COMP)：负载首字节为压缩位图 (bit i=第 i 条已压缩)
+#define AGG_COMP_MAP_LEN 1
+
+#if (TX_PACKET_QUEUE_SIZE > 8)
+#error "TX_PACKET_QUEUE_SIZE exceeds aggregate compression bitmap"
+#endif
+
+#if LORA_AGG_ENABLE
+// 聚合帧以首条消息的 ID 进入 FSM，其余消息的 ID 记录在此，结果出来后逐条上报
+typedef struct {
+    LoRa_MsgID_t lead_id;   // 0=空闲
+    LoRa_MsgID_t ids[TX_PACKET_QUEUE_SIZE - 1];
+    uint8_t      count;
+} AggGroup_t;
+
+static AggGroup_t s_AggGroups[LORA_ARQ_TX_SLOTS];
+#endif
+
 // ============================================================
 //                    核心实现
 // ============================================================
@@ -57,69 +78,386 @@ void LoRa_Manager_Init(const LoRa_Config_t *cfg, const LoRa_Manager_Callback_t *
     s_TxQ_Tail = 0;
     s_TxQ_Count = 0;
     s_NextMsgID = 1; 
+#if LORA_AGG_ENABLE
+    memset(s_AggGroups, 0, sizeof(s_AggGroups));
+#endif
     
     LoRa_Manager_Buffer_Init();
+    LoRa_Manager_Protocol_Init();
     LoRa_Manager_FSM_Init(cfg); 
+    LoRa_Manager_Frag_Init();
 }
 
 void LoRa_Manager_RegisterCipher(const LoRa_Cipher_t *cipher) {
     s_Cipher = cipher;
 }
 
+void LoRa_Manager_SetLinkFec(uint16_t peer_id, bool enable) {
+    LoRa_Manager_Protocol_SetLinkFec(peer_id, enable);
+}
+
+// 从队列中间移除第 idx 个请求 (idx 为相对队尾的偏移)，其后的请求依次前移
+static void _TxQueueRemove(uint8_t idx) {
+    for (uint8_t i = idx; i + 1 < s_TxQ_Count; i++) {
+        uint8_t cur = (s_TxQ_Tail + i) % TX_PACKET_QUEUE_SIZE;
+        uint8_t nxt = (s_TxQ_Tail + i + 1) % TX_PACKET_QUEUE_SIZE;
+        s_TxQueue[cur] = s_TxQueue[nxt];
+    }
+    s_TxQ_Head = (s_TxQ_Head + TX_PACKET_QUEUE_SIZE - 1) % TX_PACKET_QUEUE_SIZE;
+    s_TxQ_Count--;
+}
+
+static TxRequest_t* _TxQueueAt(uint8_t idx) {
+    return &s_TxQueue[(s_TxQ_Tail + idx) % TX_PACKET_QUEUE_SIZE];
+}
+
+#if LORA_AGG_ENABLE
+/**
+ * @brief  收集可与第 idx 个请求合并的后续请求 (同一目标、同一发送选项)
+ * @note   遇到同目标但放不下或选项不同的请求即停止，保证同一目标内部先进先出。
+ * @param  batch: 输出请求下标 (含 idx 本身，升序)
+ * @param  total: 输出聚合负载长度
+ * @param  full:  输出是否已无法再追加 (后续同目标请求放不下)
+ * @return 请求条数
+ */
+static uint8_t _AggCollect(uint8_t idx, uint8_t *batch, uint16_t *total, bool *full) {
+    const TxRequest_t *head = _TxQueueAt(idx);
+    bool comp = (head->flags & LORA_CTRL_MASK_COMP) != 0;
+    uint16_t sum = (comp ? AGG_COMP_MAP_LEN : 0) + AGG_SUB_HDR_LEN + head->len;
+    uint8_t n = 0;
+
+    batch[n++] = idx;
+    *full = false;
+    for (uint8_t i = idx + 1; i < s_TxQ_Count; i++) {
+        const TxRequest_t *r = _TxQueueAt(i);
+        if (r->target_id != head->target_id) continue;
+        // 第一条压缩子消息额外占用位图字节
+        uint16_t add = AGG_SUB_HDR_LEN + r->len;
+        if (!comp && (r->flags & LORA_CTRL_MASK_COMP)) add += AGG_COMP_MAP_LEN;
+        if (r->opt.NeedAck != head->opt.NeedAck || r->opt.UseFec != head->opt.UseFec || sum + add > LORA_MAX_PAYLOAD_LEN) {
+            *full = true;
+            break;
+        }
+        if (r->flags & LORA_CTRL_MASK_COMP) comp = true;
+        sum += add;
+        batch[n++] = i;
+    }
+    if (sum + AGG_SUB_HDR_LEN >= LORA_MAX_PAYLOAD_LEN) *full = true;
+    *total = sum;
+    return n;
+}
+
+/**
+ * @brief  Nagle 规则：第 idx 个请求还应等待多久再发 (ms)
+ * @return 0=立即发送
+ */
+static uint32_t _AggHoldMs(uint8_t idx) {
+#if (LORA_AGG_HOLD_MS > 0)
+    const TxRequest_t *head = _TxQueueAt(idx);
+    uint8_t batch[TX_PACKET_QUEUE_SIZE];
+    uint16_t total;
+    bool full;
+
+    _AggCollect(idx, batch, &total, &full);
+    // 已装满、队列已满 (再等也无法追加)、已过半帧 (继续等待收益有限) 时不等待
+    if (full || s_TxQ_Count >= TX_PACKET_QUEUE_SIZE || total * 2 > LORA_MAX_PAYLOAD_LEN) return 0;
+    // 目标空闲：立即发送，不增加时延
+    if (LoRa_Manager_FSM_GetInflight(head->target_id) == 0) return 0;
+
+    uint32_t waited = OSAL_GetTick() - head->enq_tick;
+    return (waited >= LORA_AGG_HOLD_MS) ? 0 : (LORA_AGG_HOLD_MS - waited);
+#else
+    (void)idx;
+    return 0;
+#endif
+}
+
+/**
+ * @brief  将多条请求打包为一个聚合帧送入 FSM，成功后移出队列
+ * @return true=已送入, false=发送队列满 (队列保持不变)
+ */
+static bool _AggSend(const uint8_t *batch, uint8_t cnt, uint8_t *tx_stack_buf, uint16_t tx_stack_len) {
+    static uint8_t s_AggBuf[LORA_MAX_PAYLOAD_LEN];
+    AggGroup_t *group = NULL;
+    uint8_t comp_map = 0;
+    uint16_t off = 0;
+
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        if (s_AggGroups[i].lead_id == 0) { group = &s_AggGroups[i]; break; }
+    }
+    if (!group) return false;
+
+    for (uint8_t i = 0; i < cnt; i++) {
+        if (_TxQueueAt(batch[i])->flags & LORA_CTRL_MASK_COMP) comp_map |= (uint8_t)(1u << i);
+    }
+    if (comp_map) s_AggBuf[off++] = comp_map;
+
+    for (uint8_t i = 0; i < cnt; i++) {
+        const TxRequest_t *r = _TxQueueAt(batch[i]);
+        s_AggBuf[off++] = (uint8_t)r->len;
+        memcpy(&s_AggBuf[off], r->payload, r->len);
+        off += r->len;
+    }
+
+    const TxRequest_t *head = _TxQueueAt(batch[0]);
+    if (!LoRa_Manager_FSM_Send(s_AggBuf, off, head->target_id, head->opt, head->msg_id,
+                               LORA_CTRL_MASK_AGG | (comp_map ? LORA_CTRL_MASK_COMP : 0), tx_stack_buf, tx_stack_len)) {
+        return false;
+    }
+
+    group->lead_id = head->msg_id;
+    group->count = cnt - 1;
+    for (uint8_t i = 1; i < cnt; i++) {
+        group->ids[i - 1] = _TxQueueAt(batch[i])->msg_id;
+    }
+    LORA_LOG("[MGR] Dequeue TX Agg (ID:%d, Msgs:%d, Len:%d)\r\n", head->msg_id, cnt, off);
+
+    // 从后往前移除，保持前面的下标有效
+    for (uint8_t i = cnt; i > 0; i--) {
+        _TxQueueRemove(batch[i - 1]);
+    }
+    return true;
+}
+#endif
+
+// [新增] 分片消息：窗口可用时逐片加密并送入 FSM
+static void _ProcessFragTx(uint8_t *tx_stack_buf, uint16_t tx_stack_len) {
+    static uint8_t s_FragPlain[LORA_FRAG_HDR_LEN + LORA_FRAG_CHUNK_LEN];
+    static uint8_t s_FragCipher[LORA_MAX_PAYLOAD_LEN];
+    uint16_t target_id;
+    LoRa_SendOpt_t opt;
+    LoRa_MsgID_t msg_id;
+    uint16_t len;
+
+    while ((len = LoRa_Manager_Frag_TxPeek(s_FragPlain, &target_id, &opt, &msg_id)) > 0) {
+        if (!LoRa_Manager_FSM_CanSend(target_id, opt)) break;
+
+        const uint8_t *frame = s_FragPlain;
+        if (s_Cipher && s_Cipher->Encrypt) {
+            len = s_Cipher->Encrypt(s_FragPlain, len, s_FragCipher);
+            frame = s_FragCipher;
+        }
+        if (len > LORA_MAX_PAYLOAD_LEN) {
+            // 加密扩展超出单帧负载 (LORA_FRAG_CHUNK_LEN 配置过大)：按失败上报
+            LORA_LOG("[MGR] Frag Too Large After Encrypt\r\n");
+            LoRa_Manager_Frag_TxAdvance();
+            if (LoRa_Manager_Frag_OnTxResult(msg_id, false) == LORA_FRAG_TX_DONE_FAIL && s_MgrCb.OnTxResult) {
+                s_MgrCb.OnTxResult(msg_id, false);
+            }
+            break;
+        }
+        if (!LoRa_Manager_FSM_Send(frame, len, target_id, opt, msg_id, LORA_CTRL_MASK_FRAG, tx_stack_buf, tx_stack_len)) {
+            break;
+        }
+        LoRa_Manager_Frag_TxAdvance();
+    }
+}
+
+// [变更] 按目标会话出队：某目标窗口已满或处于重传退避时跳过它的请求，
+//        其余目标的请求照常进入窗口 (同一目标内部仍保持先进先出)
 static void _ProcessTxQueue(void) {
-    if (LoRa_Manager_FSM_IsBusy()) return;
-    if (s_TxQ_Count == 0) return;
-    
-    TxRequest_t *req = &s_TxQueue[s_TxQ_Tail];
-    
-    uint8_t tx_stack_buf[LORA_MAX_PAYLOAD_LEN + 32];
-    
-    if (LoRa_Manager_FSM_Send(req->payload, req->len, req->target_id, req->opt, req->msg_id, tx_stack_buf, sizeof(tx_stack_buf))) {
-        s_TxQ_Tail = (s_TxQ_Tail + 1) % TX_PACKET_QUEUE_SIZE;
-        s_TxQ_Count--;
-        LORA_LOG("[MGR] Dequeue TX (ID:%d, Left:%d)\r\n", req->msg_id, s_TxQ_Count);
+    uint8_t tx_stack_buf[LORA_PROTOCOL_MAX_FRAME_LEN];
+    uint16_t blocked[TX_PACKET_QUEUE_SIZE];
+    uint8_t blocked_cnt = 0;
+    uint8_t idx = 0;
+
+    while (idx < s_TxQ_Count) {
+        TxRequest_t *req = &s_TxQueue[(s_TxQ_Tail + idx) % TX_PACKET_QUEUE_SIZE];
+        bool skip = false;
+
+        for (uint8_t i = 0; i < blocked_cnt; i++) {
+            if (blocked[i] == req->target_id) { skip = true; break; }
+        }
+        if (!skip && !LoRa_Manager_FSM_CanSend(req->target_id, req->opt)) {
+            blocked[blocked_cnt++] = req->target_id;
+            skip = true;
+        }
+        if (skip) {
+            idx++;
+            continue;
+        }
+
+#if LORA_AGG_ENABLE
+        // [新增] 小消息聚合：目标忙时暂留等待合并；有可合并的请求时打包为一帧
+        // [修复] 仅对已声明支持扩展负载的对端聚合，旧版节点无法解析聚合帧
+        if (LoRa_Manager_Protocol_LinkExt(req->target_id)) {
+            if (_AggHoldMs(idx) > 0) {
+                blocked[blocked_cnt++] = req->target_id;
+                idx++;
+                continue;
+            }
+            uint8_t batch[TX_PACKET_QUEUE_SIZE];
+            uint16_t agg_len;
+            bool agg_full;
+            uint8_t agg_cnt = _AggCollect(idx, batch, &agg_len, &agg_full);
+            if (agg_cnt > 1) {
+                if (!_AggSend(batch, agg_cnt, tx_stack_buf, sizeof(tx_stack_buf))) return;
+                continue;
+            }
+        }
+#endif
+
+        // 窗口可用但发送队列已满：本轮停止，等待物理层消化
+        if (!LoRa_Manager_FSM_Send(req->payload, req->len, req->target_id, req->opt, req->msg_id, req->flags, tx_stack_buf, sizeof(tx_stack_buf))) {
+            return;
+        }
+        LoRa_MsgID_t msg_id = req->msg_id;
+        _TxQueueRemove(idx);
+        LORA_LOG("[MGR] Dequeue TX (ID:%d, Left:%d)\r\n", msg_id, s_TxQ_Count);
+    }
+
+    _ProcessFragTx(tx_stack_buf, sizeof(tx_stack_buf));
+}
+
+// [新增] 解压一条已解密的消息到 s_PlainBuf
+static uint8_t s_PlainBuf[LORA_MAX_PAYLOAD_LEN];
+
+static uint16_t _Decompress(const uint8_t *data, uint16_t len, uint16_t src_id) {
+    uint16_t n = LoRa_Manager_Compress_Decode(data, len, s_PlainBuf, sizeof(s_PlainBuf));
+    if (n == 0) {
+        LORA_LOG("[MGR] Decompress Fail, Drop (Src %d, Len %d)\r\n", src_id, len);
+    }
+    return n;
+}
+
+// [新增] 拆分聚合帧：逐条解密、解压并回调 (子消息各自独立压缩和加密)
+static void _DeliverAggregate(LoRa_Packet_t *pkt) {
+    uint8_t comp_map = 0;
+    uint16_t off = 0;
+
+    if (pkt->IsCompressed && pkt->PayloadLen > 0) {
+        comp_map = pkt->Payload[0];
+        off = AGG_COMP_MAP_LEN;
+    }
+    for (uint8_t k = 0; off < pkt->PayloadLen; k++) {
+        uint8_t *sub = &pkt->Payload[off + AGG_SUB_HDR_LEN];
+        uint16_t n = pkt->Payload[off];
+        if (off + AGG_SUB_HDR_LEN + n > pkt->PayloadLen) {
+            LORA_LOG("[MGR] Agg Drop Malformed (Src %d, Off %d)\r\n", pkt->SourceID, off);
+            return;
+        }
+        off += AGG_SUB_HDR_LEN + n;
+
+        if (s_Cipher && s_Cipher->Decrypt && n > 0) {
+            n = s_Cipher->Decrypt(sub, n, sub);
+        }
+        if (k < 8 && (comp_map & (1u << k))) {
+            n = _Decompress(sub, n, pkt->SourceID);
+            if (n == 0) continue;
+            sub = s_PlainBuf;
+        }
+        s_MgrCb.OnRecv(sub, n, pkt->SourceID);
+    }
+}
+
+// 解密、解压并回调上层 (分片帧先重组，收齐后整条回调；聚合帧拆分后逐条回调)
+static void _DeliverPacket(LoRa_Packet_t *pkt) {
+    if (!s_MgrCb.OnRecv) return;
+
+    if (pkt->IsAggregate) {
+        _DeliverAggregate(pkt);
+        return;
+    }
+
+    if (s_Cipher && s_Cipher->Decrypt && pkt->PayloadLen > 0) {
+        uint16_t new_len = s_Cipher->Decrypt(pkt->Payload, pkt->PayloadLen, pkt->Payload);
+        pkt->PayloadLen = new_len;
+    }
+
+    uint8_t *data = pkt->Payload;
+    uint16_t len = pkt->PayloadLen;
+    if (pkt->IsCompressed) {
+        len = _Decompress(data, len, pkt->SourceID);
+        if (len == 0) return;
+        data = s_PlainBuf;
+    }
+
+    if (pkt->IsFragment) {
+        uint8_t *msg;
+        uint16_t msg_len;
+        if (LoRa_Manager_Frag_RxInput(pkt->SourceID, data, len, &msg, &msg_len)) {
+            s_MgrCb.OnRecv(msg, msg_len, pkt->SourceID);
+        }
+        return;
+    }
+    s_MgrCb.OnRecv(data, len, pkt->SourceID);
+}
+
+// 上报发送结果 (分片消息只在全部分片结束时上报一次)
+static void _ReportTxResult(LoRa_MsgID_t msg_id, bool success) {
+    switch (LoRa_Manager_Frag_OnTxResult(msg_id, success)) {
+        case LORA_FRAG_TX_PENDING:   return;
+        case LORA_FRAG_TX_DONE_OK:   success = true; break;
+        case LORA_FRAG_TX_DONE_FAIL: success = false; break;
+        default: break;
+    }
+    if (s_MgrCb.OnTxResult) {
+        s_MgrCb.OnTxResult(msg_id, success);
+    }
+
+#if LORA_AGG_ENABLE
+    // 聚合帧：同一帧内其余消息共享结果，按入队顺序依次上报
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        AggGroup_t *g = &s_AggGroups[i];
+        if (g->lead_id != msg_id) continue;
+        g->lead_id = 0;
+        for (uint8_t k = 0; k < g->count && s_MgrCb.OnTxResult; k++) {
+            s_MgrCb.OnTxResult(g->ids[k], success);
+        }
+        break;
+    }
+#endif
+}
+
+// 交付乱序缓存中已按序就绪的帧 (pkt 作为临时存储)
+static void _DeliverReadyPackets(LoRa_Packet_t *pkt) {
+    while (LoRa_Manager_FSM_PopRxPacket(pkt)) {
+        _DeliverPacket(pkt);
     }
 }
 
 void LoRa_Manager_Run(void) {
-    // 1. 从 Port 拉取数据
-    LoRa_Manager_Buffer_PullFromPort();
-    
-    // 2. 解析数据包
+    // 1. [变更] 按到达顺序解析并处理所有完整的帧 (每次至多 LORA_RX_FRAMES_PER_RUN 帧)
     LoRa_Packet_t pkt;
-    memset(&pkt, 0, sizeof(pkt));
     
-    if (s_Mgr_Config && LoRa_Manager_Buffer_GetRxPacket(&pkt, s_Mgr_Config->net_id, s_Mgr_Config->group_id, 
-                                        s_RxWorkspace, RX_WORKSPACE_SIZE)) {
+    for (uint16_t n = 0; s_Mgr_Config && n < LORA_RX_FRAMES_PER_RUN; n++) {
+        memset(&pkt, 0, sizeof(pkt));
+        if (!LoRa_Manager_Buffer_GetRxPacket(&pkt, s_Mgr_Config->net_id, s_Mgr_Config->group_id)) break;
         
-        // 调用 FSM 处理 (去重、ACK识别)
-        bool valid_new_packet = LoRa_Manager_FSM_ProcessRxPacket(&pkt);
+        // [新增] 分片帧：没有可用的重组缓冲区时不交给 FSM (不确认)，等待发送方重传
+        bool defer = pkt.IsFragment && !pkt.IsAckPacket && !LoRa_Manager_Frag_RxReserve(pkt.SourceID);
         
-        // 如果是有效新包，回调上层
-        if (valid_new_packet && s_MgrCb.OnRecv) {
-            if (s_Cipher && s_Cipher->Decrypt && pkt.PayloadLen > 0) {
-                uint16_t new_len = s_Cipher->Decrypt(pkt.Payload, pkt.PayloadLen, pkt.Payload);
-                pkt.PayloadLen = new_len;
+        if (!defer) {
+            // 调用 FSM 处理 (去重、ACK识别)
+            bool valid_new_packet = LoRa_Manager_FSM_ProcessRxPacket(&pkt);
+            
+            // 如果是有效新包，回调上层
+            if (valid_new_packet) {
+                _DeliverPacket(&pkt);
+            } else if (pkt.IsFragment && !LoRa_Manager_FSM_RxHoldsFragment(pkt.SourceID)) {
+                // [修复] 只有重复/被拒的分片才释放预留；进入乱序缓存的分片已被确认，预留要保留到交付
+                LoRa_Manager_Frag_RxUnreserve(pkt.SourceID);
             }
-            s_MgrCb.OnRecv(pkt.Payload, pkt.PayloadLen, pkt.SourceID);
         }
+        
+        // 本帧补齐缺口后就绪的缓存帧先交付，再处理下一帧 (保证交付顺序)
+        _DeliverReadyPackets(&pkt);
     }
     
-    // 3. 运行状态机并处理事件
-    LoRa_FSM_Output_t fsm_out = LoRa_Manager_FSM_Run(s_RxWorkspace, RX_WORKSPACE_SIZE);
+    // 2. 运行状态机并处理事件
+    LoRa_FSM_Output_t fsm_out = LoRa_Manager_FSM_Run();
+    
+    // [新增] 交付乱序缓存中已按序就绪的帧 (等待超时跳过缺口)
+    _DeliverReadyPackets(&pkt);
     
     if (fsm_out.Event != FSM_EVT_NONE) {
         switch (fsm_out.Event) {
             case FSM_EVT_TX_DONE:
-                if (s_MgrCb.OnTxResult) {
-                    s_MgrCb.OnTxResult(fsm_out.MsgID, true);
-                }
+                _ReportTxResult(fsm_out.MsgID, true);
                 break;
                 
             case FSM_EVT_TX_TIMEOUT:
-                if (s_MgrCb.OnTxResult) {
-                    s_MgrCb.OnTxResult(fsm_out.MsgID, false);
-                }
+                _ReportTxResult(fsm_out.MsgID, false);
                 break;
                 
             default:
@@ -127,21 +465,62 @@ void LoRa_Manager_Run(void) {
         }
     }
     
-    // 4. 处理发送队列
+    // 3. 处理发送队列
+    _ProcessTxQueue();
+}
+
+static LoRa_MsgID_t _NextMsgID(void) {
+    LoRa_MsgID_t id = s_NextMsgID++;
+    if (s_NextMsgID == 0) s_NextMsgID = 1;
+    return id;
+}
+
+static LoRa_MsgID_t _SendFragmented(const uint8_t *payload, uint16_t len, uint16_t target_id, LoRa_SendOpt_t opt) {
+    if (len > LORA_FRAG_MAX_MSG_LEN) return 0;
+
+    uint32_t ctx = OSAL_EnterCritical();
+    if (LoRa_Manager_Frag_TxIsBusy()) {
+        OSAL_ExitCritical(ctx);
+        LORA_LOG("[MGR] Frag TX Busy!\r\n");
+        return 0;
+    }
+    LoRa_MsgID_t msg_id = _NextMsgID();
+    LoRa_Manager_Frag_TxStart(payload, len, target_id, opt, msg_id);
+    OSAL_ExitCritical(ctx);
+
     _ProcessTxQueue();
+    return msg_id;
 }
 
 LoRa_MsgID_t LoRa_Manager_Send(const uint8_t *payload, uint16_t len, uint16_t target_id, LoRa_SendOpt_t opt) {
     static uint8_t s_FinalPayload[LORA_MAX_PAYLOAD_LEN];
     uint16_t final_len = len;
+    uint8_t flags = 0;
     
-    if (len > LORA_MAX_PAYLOAD_LEN) return 0;
+    // [新增] 超长消息走分片发送 (每片在送入窗口时单独加密)
+    if (len > LORA_MAX_PAYLOAD_LEN) return _SendFragmented(payload, len, target_id, opt);
+
+#if LORA_COMPRESS_ENABLE
+    // [新增] 先压缩后加密 (密文不可压缩)；压缩后不变短则按原文发送
+    // [修复] 仅对已声明支持扩展负载的对端压缩，旧版节点无法解压
+    static uint8_t s_CompPayload[LORA_MAX_PAYLOAD_LEN];
+    if (len >= LORA_COMPRESS_MIN_LEN && LoRa_Manager_Protocol_LinkExt(target_id)) {
+        uint16_t comp_len = LoRa_Manager_Compress_Encode(payload, len, s_CompPayload, sizeof(s_CompPayload));
+        if (comp_len > 0) {
+            payload = s_CompPayload;
+            len = comp_len;
+            final_len = comp_len;
+            flags = LORA_CTRL_MASK_COMP;
+        }
+    }
+#endif
 
+    // [变更] 不加密时直接从调用方缓冲区复制进队列，不再经过 s_FinalPayload
+    const uint8_t *final_payload = payload;
     if (s_Cipher && s_Cipher->Encrypt) {
         final_len = s_Cipher->Encrypt(payload, len, s_FinalPayload);
         if (final_len > LORA_MAX_PAYLOAD_LEN) return 0; 
-    } else {
-        memcpy(s_FinalPayload, payload, len);
+        final_payload = s_FinalPayload;
     }
 
     uint32_t ctx = OSAL_EnterCritical();
@@ -153,13 +532,14 @@ LoRa_MsgID_t LoRa_Manager_Send(const uint8_t *payload, uint16_t len, uint16_t ta
     }
     
     TxRequest_t *req = &s_TxQueue[s_TxQ_Head];
-    memcpy(req->payload, s_FinalPayload, final_len);
+    memcpy(req->payload, final_payload, final_len);
     req->len = final_len;
     req->target_id = target_id;
     req->opt = opt; 
+    req->flags = flags;
     
-    req->msg_id = s_NextMsgID++;
-    if (s_NextMsgID == 0) s_NextMsgID = 1; 
+    req->msg_id = _NextMsgID();
+    req->enq_tick = OSAL_GetTick();
     
     LoRa_MsgID_t ret_id = req->msg_id;
     
@@ -174,10 +554,50 @@ LoRa_MsgID_t LoRa_Manager_Send(const uint8_t *payload, uint16_t len, uint16_t ta
 }
 
 bool LoRa_Manager_IsBusy(void) {
-    return LoRa_Manager_FSM_IsBusy() || (s_TxQ_Count > 0);
+    return LoRa_Manager_FSM_IsBusy() || (s_TxQ_Count > 0) || LoRa_Manager_Frag_TxIsBusy();
 }
 
 uint32_t LoRa_Manager_GetSleepDuration(void) {
-    if (s_TxQ_Count > 0) return 0;
-    return LoRa_Manager_FSM_GetNextTimeout();
+    // [新增] 本次 Run 的接收预算用完，缓冲区里还有待解析的数据
+    if (LoRa_Manager_Buffer_HasRxData()) return 0;
+
+    // [修复] 队列非空但发送窗口已满时队列无法推进，应按 FSM 超时休眠，而不是空转
+    //        (任一目标的请求可以进入窗口即不能休眠)
+    uint32_t min_wait = LORA_TIMEOUT_INFINITE;
+#if LORA_AGG_ENABLE
+    // [新增] 聚合等待中的请求按剩余等待时间唤醒 (只看每个目标的队首请求)
+    uint16_t seen[TX_PACKET_QUEUE_SIZE];
+    uint8_t seen_cnt = 0;
+#endif
+    for (uint8_t i = 0; i < s_TxQ_Count; i++) {
+        const TxRequest_t *req = _TxQueueAt(i);
+#if LORA_AGG_ENABLE
+        bool dup = false;
+        for (uint8_t k = 0; k < seen_cnt; k++) {
+            if (seen[k] == req->target_id) { dup = true; break; }
+        }
+        if (dup) continue;
+        seen[seen_cnt++] = req->target_id;
+        if (LoRa_Manager_FSM_CanSend(req->target_id, req->opt)) {
+            // [修复] 与 _ProcessTxQueue 一致：只有支持扩展负载的目标才会等待聚合
+            uint32_t hold = LoRa_Manager_Protocol_LinkExt(req->target_id) ? _AggHoldMs(i) : 0;
+            if (hold == 0) return 0;
+            if (hold < min_wait) min_wait = hold;
+        }
+#else
+        if (LoRa_Manager_FSM_CanSend(req->target_id, req->opt)) return 0;
+#endif
+    }
+    uint16_t frag_target;
+    LoRa_SendOpt_t frag_opt;
+    LoRa_MsgID_t frag_id;
+    if (LoRa_Manager_Frag_TxPeek(NULL, &frag_target, &frag_opt, &frag_id) > 0 &&
+        LoRa_Manager_FSM_CanSend(frag_target, frag_opt)) return 0;
+
+    // [新增] 缓存着半帧时按空闲重新同步时间唤醒 (之后可能不再有字节到达)
+    uint32_t rx_wait = LoRa_Manager_Buffer_GetRxIdleWait();
+    if (rx_wait < min_wait) min_wait = rx_wait;
+
+    uint32_t fsm_wait = LoRa_Manager_FSM_GetNextTimeout();
+    return (fsm_wait < min_wait) ? fsm_wait : min_wait;
 }
@@ -7,44 +7,43 @@
 
 // 缓冲区大小定义
 #define TX_QUEUE_SIZE   MGR_TX_BUF_SIZE
-#define RX_QUEUE_SIZE   MGR_RX_BUF_SIZE
-#define ACK_QUEUE_SIZE  64 // ACK 队列较小，足够存 2-3 个 ACK 包
+// ACK_QUEUE_SIZE 见 LoRaPlatConfig.h (按帧记录存储，每个 ACK 额外占 2 字节长度头，64 字节约存 3 个)
 
 // 静态缓冲区
 static uint8_t s_TxBufArr[TX_QUEUE_SIZE];
-static uint8_t s_RxBufArr[RX_QUEUE_SIZE];
 static uint8_t s_AckBufArr[ACK_QUEUE_SIZE]; // [新增] ACK 专用缓冲区
 
 // 环形队列句柄
 static LoRa_RingBuffer_t s_TxRing;
-static LoRa_RingBuffer_t s_RxRing;
 static LoRa_RingBuffer_t s_AckRing; // [新增] ACK 专用队列
 
+// [新增] 流式接收解析器 (跨 Run 保持半帧)
+static LoRa_Protocol_Parser_t s_RxParser;
+static uint32_t s_RxLastTick; // [新增] 最近一次送入新字节的时刻 (半帧空闲超时)
+
 void LoRa_Manager_Buffer_Init(void) {
     LoRa_RingBuffer_Init(&s_TxRing, s_TxBufArr, TX_QUEUE_SIZE);
-    LoRa_RingBuffer_Init(&s_RxRing, s_RxBufArr, RX_QUEUE_SIZE);
     LoRa_RingBuffer_Init(&s_AckRing, s_AckBufArr, ACK_QUEUE_SIZE);
+    LoRa_Manager_Protocol_ParserReset(&s_RxParser);
 }
 
 // ============================================================
-//                    普通发送队列 (Tx Queue)
+//                    [变更] 帧记录队列 (TX / ACK 共用)
 // ============================================================
+// 每条记录 = 2 字节长度 (小端) + 一个完整帧，出队只移动读指针。
+// 发送侧因此总是恰好取出一帧，不会把后面排队的帧一起交给 Port。
 
-bool LoRa_Manager_Buffer_PushTx(const LoRa_Packet_t *packet, uint8_t tmode, uint8_t channel, 
-                                uint8_t *scratch_buf, uint16_t scratch_len) {
-    LORA_CHECK(packet && scratch_buf && scratch_len > 0, false);
+#define RECORD_HDR_LEN  2
 
-    // 1. 序列化 (耗时操作，在临界区外进行，使用传入的栈内存)
-    uint16_t len = LoRa_Manager_Protocol_Pack(packet, scratch_buf, scratch_len, tmode, channel);
-    if (len == 0) return false;
-    
-    // 2. 入队 (快速操作，必须原子化)
+static bool _Buffer_PushRecord(LoRa_RingBuffer_t *rb, const uint8_t *frame, uint16_t len) {
+    uint8_t hdr[RECORD_HDR_LEN] = { (uint8_t)(len & 0xFF), (uint8_t)(len >> 8) };
     bool ret = false;
     
     uint32_t primask = OSAL_EnterCritical(); // 【关中断/加锁】
     
-    if (LoRa_RingBuffer_GetFree(&s_TxRing) >= len) {
-        LoRa_RingBuffer_Write(&s_TxRing, scratch_buf, len);
+    if (LoRa_RingBuffer_GetFree(rb) >= (uint32_t)len + RECORD_HDR_LEN) {
+        LoRa_RingBuffer_Write(rb, hdr, RECORD_HDR_LEN);
+        LoRa_RingBuffer_Write(rb, frame, len);
         ret = true;
     }
     
@@ -53,44 +52,56 @@ bool LoRa_Manager_Buffer_PushTx(const LoRa_Packet_t *packet, uint8_t tmode, uint
     return ret;
 }
 
-bool LoRa_Manager_Buffer_HasTxData(void) {
-    return !LoRa_RingBuffer_IsEmpty(&s_TxRing);
+// 队首记录的帧长度 (0=队列空)
+static uint16_t _Buffer_RecordLen(const LoRa_RingBuffer_t *rb) {
+    uint8_t hdr[RECORD_HDR_LEN];
+    if (LoRa_RingBuffer_Peek(rb, 0, hdr, RECORD_HDR_LEN) < RECORD_HDR_LEN) return 0;
+    return (uint16_t)(hdr[0] | ((uint16_t)hdr[1] << 8));
 }
 
-uint16_t LoRa_Manager_Buffer_PeekTx(uint8_t *scratch_buf, uint16_t scratch_len) {
-    // Peek 操作只读不写，且是在单线程 Run 中调用，通常不需要加锁
-    // 但为了绝对安全（防止 Push 修改 Head 导致 Count 变化），建议加锁读取 Count
-    // 这里简化处理：假设 Run 是单线程的，且 Push 只修改 Head，Peek 只读 Tail 和 Count
-    // 只要 Count 读取是原子的，Peek 就是安全的。
-    
-    if (s_TxRing.Count == 0) return 0;
-    
-    uint16_t len = s_TxRing.Count;
-    if (len > scratch_len) len = scratch_len;
-    
-    uint16_t chunk1 = s_TxRing.Size - s_TxRing.Tail;
-    if (len <= chunk1) {
-        memcpy(scratch_buf, &s_TxRing.pBuffer[s_TxRing.Tail], len);
-    } else {
-        memcpy(scratch_buf, &s_TxRing.pBuffer[s_TxRing.Tail], chunk1);
-        memcpy(scratch_buf + chunk1, &s_TxRing.pBuffer[0], len - chunk1);
-    }
-    return len;
+static uint16_t _Buffer_PeekRecord(const LoRa_RingBuffer_t *rb, uint8_t *scratch_buf, uint16_t scratch_len) {
+    // Peek 只在单线程 Run 中调用，Push 只追加在队尾，不影响队首记录，无需加锁
+    uint16_t len = _Buffer_RecordLen(rb);
+    if (len == 0 || len > scratch_len) return 0;
+    return LoRa_RingBuffer_Peek(rb, RECORD_HDR_LEN, scratch_buf, len);
 }
 
-void LoRa_Manager_Buffer_PopTx(uint16_t len) {
-    uint8_t dummy;
-    
+static void _Buffer_PopRecord(LoRa_RingBuffer_t *rb) {
     uint32_t primask = OSAL_EnterCritical(); // 【关中断/加锁】
     
-    // 简单粗暴的移动指针方式
-    for(uint16_t i=0; i<len; i++) {
-        LoRa_RingBuffer_Read(&s_TxRing, &dummy, 1);
-    }
+    uint16_t len = _Buffer_RecordLen(rb);
+    if (!LoRa_RingBuffer_IsEmpty(rb)) LoRa_RingBuffer_Skip(rb, (uint16_t)(len + RECORD_HDR_LEN));
     
     OSAL_ExitCritical(primask);  // 【开中断/解锁】
 }
 
+// ============================================================
+//                    普通发送队列 (Tx Queue)
+// ============================================================
+
+bool LoRa_Manager_Buffer_PushTx(const uint8_t *frame, uint16_t len) {
+    LORA_CHECK(frame && len > 0, false);
+
+    // 入队 (快速操作，必须原子化；序列化已由调用方在临界区外完成)
+    return _Buffer_PushRecord(&s_TxRing, frame, len);
+}
+
+bool LoRa_Manager_Buffer_HasTxData(void) {
+    return !LoRa_RingBuffer_IsEmpty(&s_TxRing);
+}
+
+uint16_t LoRa_Manager_Buffer_TxFrameLen(void) {
+    return _Buffer_RecordLen(&s_TxRing);
+}
+
+uint16_t LoRa_Manager_Buffer_PeekTx(uint8_t *scratch_buf, uint16_t scratch_len) {
+    return _Buffer_PeekRecord(&s_TxRing, scratch_buf, scratch_len);
+}
+
+void LoRa_Manager_Buffer_PopTx(void) {
+    _Buffer_PopRecord(&s_TxRing);
+}
+
 // ============================================================
 //                    ACK 高优先级队列 (Ack Queue)
 // ============================================================
@@ -104,18 +115,7 @@ bool LoRa_Manager_Buffer_PushAck(const LoRa_Packet_t *packet, uint8_t tmode, uin
     if (len == 0) return false;
     
     // 2. 入队 (原子操作)
-    bool ret = false;
-    
-    uint32_t primask = OSAL_EnterCritical();
-    
-    if (LoRa_RingBuffer_GetFree(&s_AckRing) >= len) {
-        LoRa_RingBuffer_Write(&s_AckRing, scratch_buf, len);
-        ret = true;
-    }
-    
-    OSAL_ExitCritical(primask);
-    
-    return ret;
+    return _Buffer_PushRecord(&s_AckRing, scratch_buf, len);
 }
 
 bool LoRa_Manager_Buffer_HasAckData(void) {
@@ -123,85 +123,76 @@ bool LoRa_Manager_Buffer_HasAckData(void) {
 }
 
 uint16_t LoRa_Manager_Buffer_PeekAck(uint8_t *scratch_buf, uint16_t scratch_len) {
-    if (s_AckRing.Count == 0) return 0;
-    
-    uint16_t len = s_AckRing.Count;
-    if (len > scratch_len) len = scratch_len;
-    
-    uint16_t chunk1 = s_AckRing.Size - s_AckRing.Tail;
-    if (len <= chunk1) {
-        memcpy(scratch_buf, &s_AckRing.pBuffer[s_AckRing.Tail], len);
-    } else {
-        memcpy(scratch_buf, &s_AckRing.pBuffer[s_AckRing.Tail], chunk1);
-        memcpy(scratch_buf + chunk1, &s_AckRing.pBuffer[0], len - chunk1);
-    }
-    return len;
+    return _Buffer_PeekRecord(&s_AckRing, scratch_buf, scratch_len);
 }
 
-void LoRa_Manager_Buffer_PopAck(uint16_t len) {
-    uint8_t dummy;
-    
-    uint32_t primask = OSAL_EnterCritical();
-    
-    for(uint16_t i=0; i<len; i++) {
-        LoRa_RingBuffer_Read(&s_AckRing, &dummy, 1);
-    }
-    
-    OSAL_ExitCritical(primask);
+void LoRa_Manager_Buffer_PopAck(void) {
+    _Buffer_PopRecord(&s_AckRing);
 }
 
 // ============================================================
 //                    接收处理 (RX Buffer)
 // ============================================================
 
-uint16_t LoRa_Manager_Buffer_PullFromPort(void) {
-    // 这里可以使用小一点的栈变量，因为是从 DMA 读，通常不会太大
-    uint8_t temp_buf[64]; 
-    uint16_t total_read = 0;
+bool LoRa_Manager_Buffer_GetRxPacket(LoRa_Packet_t *packet, uint16_t local_id, uint16_t group_id) {
+    LORA_CHECK(packet, false);
     
-    while (1) {
-        uint16_t len = LoRa_Port_ReceiveData(temp_buf, sizeof(temp_buf));
-        if (len == 0) break;
-        
-        // [新增] 打印接收到的原始数据
-        LORA_HEXDUMP("RX RAW", temp_buf, len);
-        
-        // RX 仅由单线程 Run 调用，不需要加锁
-        LoRa_RingBuffer_Write(&s_RxRing, temp_buf, len);
-        total_read += len;
-    }
-    return total_read;
-}
-
-bool LoRa_Manager_Buffer_GetRxPacket(LoRa_Packet_t *packet, uint16_t local_id, uint16_t group_id,
-                                     uint8_t *scratch_buf, uint16_t scratch_len) {
-    LORA_CHECK(packet && scratch_buf && scratch_len > 0, false);
-    
-    uint16_t count = LoRa_RingBuffer_GetCount(&s_RxRing);
-    if (count > scratch_len) count = scratch_len; // 保护防止溢出
-    
-    // 1. 偷看所有数据 (Peek) 到共享缓冲区
-    uint16_t chunk1 = s_RxRing.Size - s_RxRing.Tail;
-    if (count <= chunk1) {
-        memcpy(scratch_buf, &s_RxRing.pBuffer[s_RxRing.Tail], count);
-    } else {
-        memcpy(scratch_buf, &s_RxRing.pBuffer[s_RxRing.Tail], chunk1);
-        memcpy(scratch_buf + chunk1, &s_RxRing.pBuffer[0], count - chunk1);
-    }
-    
-    // 2. 尝试解析
-    uint16_t consumed = LoRa_Manager_Protocol_Unpack(scratch_buf, count, packet, local_id, group_id);
-    
-    // 3. 如果消耗了数据，从 RingBuffer 移除
-    if (consumed > 0) {
-        uint8_t dummy;
-        for(uint16_t i=0; i<consumed; i++) {
-            LoRa_RingBuffer_Read(&s_RxRing, &dummy, 1);
+    // [变更] 流式解析：字节按到达顺序送入解析器，每个字节只处理一次，
+    //        半帧留在解析器中等待后续字节，不再每次复制整个 Ring 重新解析
+    //        [变更] 被过滤的帧 (非本机/空帧) 直接跳过，继续解析后面的帧
+    //        [变更] 零拷贝：直接解析 Port 的 DMA 接收缓冲 (回绕时先解析尾段，消费后头段成为下一次的首段)，
+    //               不再经过中转缓冲与 RX Ring；解析完的字节随即归还给 DMA
+    bool done = false;
+    bool ret = false;
+    uint32_t skipped = s_RxParser.skipped;
+    
+    for (;;) {
+        LoRa_PortSpan_t span[2];
+        uint16_t n = (LoRa_Port_PeekRx(span) > 0) ? span[0].len : 0;
+        if (LoRa_Port_CheckAndClearRxOverrun()) {
+            // [新增] 接收缓冲溢出：缓存的半帧与之后的字节不连续，丢弃其帧头重新同步
+            LORA_LOG("[MGR] RX Overrun\r\n");
+            LoRa_Manager_Protocol_ParserResync(&s_RxParser);
+        }
+        uint16_t used = LoRa_Manager_Protocol_ParserFeed(&s_RxParser, span[0].data, n, packet, local_id, group_id, &done);
+        if (used > 0) {
+            // [新增] 打印接收到的原始数据
+            LORA_HEXDUMP("RX RAW", span[0].data, used);
+            LoRa_Port_ConsumeRx(used);
+            s_RxLastTick = OSAL_GetTick();
         }
         
-        // 只有当 packet 被有效填充时才返回 true
-        return (packet->IsAckPacket || packet->PayloadLen > 0);
+        // 只有当 packet 被有效填充时才返回 true ([新增] CRC 失败的帧头交给 FSM 回 NACK)
+        if (done && (packet->IsAckPacket || packet->PayloadLen > 0 || packet->CrcError)) {
+            ret = true;
+            break;
+        }
+        if (!done && n == 0) {
+            // [修复] 候选帧长时间等不到后续字节 (噪声字节形似帧头)：丢弃其帧头，
+            //        重新扫描其后已缓存的字节，里面的真实帧不再被扣留
+            if (s_RxParser.fill == 0 || LoRa_Manager_Buffer_GetRxIdleWait() > 0) break;
+            LoRa_Manager_Protocol_ParserResync(&s_RxParser);
+        }
     }
     
-    return false;
+    // [新增] 报告本次重新同步丢弃的字节 (噪声/残帧)
+    if (s_RxParser.skipped != skipped) {
+        LORA_LOG("[MGR] RX Resync, Skipped %u Bytes\r\n", (unsigned)(s_RxParser.skipped - skipped));
+    }
+    return ret;
+}
+
+uint32_t LoRa_Manager_Buffer_GetRxSkipped(void) {
+    return s_RxParser.skipped;
+}
+
+uint32_t LoRa_Manager_Buffer_GetRxIdleWait(void) {
+    if (s_RxParser.fill == 0) return LORA_TIMEOUT_INFINITE;
+    uint32_t idle = OSAL_GetTick() - s_RxLastTick;
+    return (idle >= LORA_RX_IDLE_RESYNC_MS) ? 0 : (LORA_RX_IDLE_RESYNC_MS - idle);
+}
+
+bool LoRa_Manager_Buffer_HasRxData(void) {
+    LoRa_PortSpan_t span[2];
+    return (LoRa_Port_PeekRx(span) > 0) || (s_RxParser.scan < s_RxParser.fill);
 }
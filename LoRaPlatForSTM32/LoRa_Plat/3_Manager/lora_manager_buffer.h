@@ -27,16 +27,13 @@ void LoRa_Manager_Buffer_Init(void);
 // ============================================================
 
 /**
- * @brief  将普通数据包推入发送队列 (线程安全)
- * @param  packet: 待发送的数据包结构体
- * @param  tmode: 传输模式
- * @param  channel: 信道
- * @param  scratch_buf: 外部传入的栈缓冲区 (用于序列化)
- * @param  scratch_len: 缓冲区长度
+ * @brief  [变更] 将已序列化的数据帧推入发送队列 (线程安全)
+ * @note   由 FSM 封包 (封包结果同时缓存在窗口槽中供重传)，这里只做拷贝入队
+ * @param  frame: 完整的线上字节
+ * @param  len: 帧长度
  * @return true=成功入队, false=队列满
  */
-bool LoRa_Manager_Buffer_PushTx(const LoRa_Packet_t *packet, uint8_t tmode, uint8_t channel, 
-                                uint8_t *scratch_buf, uint16_t scratch_len);
+bool LoRa_Manager_Buffer_PushTx(const uint8_t *frame, uint16_t len);
 
 /**
  * @brief  检查普通发送队列是否有数据
@@ -44,18 +41,24 @@ bool LoRa_Manager_Buffer_PushTx(const LoRa_Packet_t *packet, uint8_t tmode, uint
 bool LoRa_Manager_Buffer_HasTxData(void);
 
 /**
- * @brief  从普通发送队列头部预览数据 (Peek)
+ * @brief  [新增] 普通发送队列队首帧的长度 (不复制帧内容)
+ * @return 帧长度 (0=队列空)
+ */
+uint16_t LoRa_Manager_Buffer_TxFrameLen(void);
+
+/**
+ * @brief  [变更] 预览普通发送队列的队首帧 (Peek)
+ * @note   队列按帧记录存储，只取出恰好一帧
  * @param  scratch_buf: 输出缓冲区
  * @param  scratch_len: 缓冲区大小
- * @return 数据长度
+ * @return 帧长度 (0=队列空或缓冲区放不下该帧)
  */
 uint16_t LoRa_Manager_Buffer_PeekTx(uint8_t *scratch_buf, uint16_t scratch_len);
 
 /**
- * @brief  从普通发送队列移除已发送的数据 (Pop) (线程安全)
- * @param  len: 要移除的长度
+ * @brief  [变更] 移除普通发送队列的队首帧 (Pop) (线程安全，O(1))
  */
-void LoRa_Manager_Buffer_PopTx(uint16_t len);
+void LoRa_Manager_Buffer_PopTx(void);
 
 // ============================================================
 //                    3. ACK 高优先级队列 (Ack Queue)
@@ -74,35 +77,45 @@ bool LoRa_Manager_Buffer_PushAck(const LoRa_Packet_t *packet, uint8_t tmode, uin
 bool LoRa_Manager_Buffer_HasAckData(void);
 
 /**
- * @brief  从 ACK 队列头部预览数据
+ * @brief  [变更] 预览 ACK 队列的队首帧
+ * @return 帧长度 (0=队列空或缓冲区放不下该帧)
  */
 uint16_t LoRa_Manager_Buffer_PeekAck(uint8_t *scratch_buf, uint16_t scratch_len);
 
 /**
- * @brief  从 ACK 队列移除数据 (线程安全)
+ * @brief  [变更] 移除 ACK 队列的队首帧 (线程安全，O(1))
  */
-void LoRa_Manager_Buffer_PopAck(uint16_t len);
+void LoRa_Manager_Buffer_PopAck(void);
 
 // ============================================================
 //                    4. 接收处理 (RX Buffer)
 // ============================================================
 
 /**
- * @brief  从 Port 层拉取数据并推入 RX RingBuffer
- * @return 拉取到的字节数
- */
-uint16_t LoRa_Manager_Buffer_PullFromPort(void);
-
-/**
- * @brief  尝试从 RX RingBuffer 解析一个完整包
+ * @brief  尝试从 Port 接收缓冲解析一个完整包
+ * @note   [变更] 字节送入流式解析器，半帧跨调用保留，不再需要外部工作区
+ *         [变更] 直接原地解析 Port 的 DMA 接收缓冲 (LoRa_Port_PeekRx)，不再经过 RX RingBuffer
  * @param  packet: 输出结构体
  * @param  local_id: 本地 ID
  * @param  group_id: 组 ID
- * @param  scratch_buf: 外部传入的共享缓冲区 (RX Workspace)
- * @param  scratch_len: 缓冲区长度
  * @return true=解析成功, false=无完整包
  */
-bool LoRa_Manager_Buffer_GetRxPacket(LoRa_Packet_t *packet, uint16_t local_id, uint16_t group_id,
-                                     uint8_t *scratch_buf, uint16_t scratch_len);
+bool LoRa_Manager_Buffer_GetRxPacket(LoRa_Packet_t *packet, uint16_t local_id, uint16_t group_id);
+
+/**
+ * @brief  [新增] 距离缓存的半帧判定为过期 (空闲重新同步) 还有多久
+ * @return ms (0=下一次 GetRxPacket 将丢弃该候选帧; 没有缓存的半帧时为 LORA_TIMEOUT_INFINITE)
+ */
+uint32_t LoRa_Manager_Buffer_GetRxIdleWait(void);
+
+/**
+ * @brief  [新增] 是否还有未解析的接收数据 (GetRxPacket 因处理预算提前停止时为真)
+ */
+bool LoRa_Manager_Buffer_HasRxData(void);
+
+/**
+ * @brief  [新增] 接收重新同步累计丢弃的字节数 (串口噪声、残帧、被否定的帧头)
+ */
+uint32_t LoRa_Manager_Buffer_GetRxSkipped(void);
 
 #endif // __LORA_MANAGER_BUFFER_H
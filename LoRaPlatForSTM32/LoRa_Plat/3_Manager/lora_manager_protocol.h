@@ -21,9 +21,60 @@
 #define LORA_PROTOCOL_TAIL_0     '\r'
 #define LORA_PROTOCOL_TAIL_1     '\n'
 
+/**
+ * [新增] V2 紧凑帧 (与 V1 按首字节区分，两种格式都能接收)
+ *   [Head(1)][Len(1)][Ctrl(1)][Seq(1|2)][Target(1|2)][Source(1|2)][HCS(0|1)][Payload(N)][CRC16(2)]
+ *   - Head:  0xA8 | 格式标志 (bit0=短地址：两个 ID 各 1 字节，0xFF 表示广播；
+ *            bit1=[新增] 带帧头校验 HCS，覆盖 Head 到 Source 的 CRC16 低字节)
+ *   - Seq:   ACK 帧与确认帧只带低 8 位 (接收方按窗口扩展为 16 位)，其余帧 16 位
+ *   - CRC16: 始终存在，覆盖 Head 到 Payload 结束 (无包尾，CRC 是唯一的完整性校验)
+ */
+#define LORA_PROTOCOL_V2_HEAD        0xA8
+#define LORA_PROTOCOL_V2_HEAD_MASK   0xFC
+#define LORA_PROTOCOL_V2_SHORT_ADDR  0x01
+#define LORA_PROTOCOL_V2_HDR_CHECK   0x02
+
+/**
+ * [新增] FEC 帧 (包裹一个完整的 V1/V2 帧，按首字节区分)
+ *   [Head(1)][Len(1)][HdrParity(4)][内层帧(Len)][交织校验(D x P)]
+ *   - Head/Len 与 4 字节校验组成 RS(6,2) 码字，可纠正 2 个字节错误
+ *   - 内层帧按 LORA_FEC_BLOCK_LEN 分为 D 个码字，第 j 字节属于码字 j % D，
+ *     码字 i 的第 p 个校验字节位于校验区 p x D + i (P = LORA_FEC_PARITY_LEN)，
+ *     连续的突发错误因此分散到各码字，每个码字可纠正 P/2 个字节错误
+ *   - 纠错后内层帧照常校验 CRC，误纠由 CRC 拦截
+ */
+#define LORA_PROTOCOL_FEC_HEAD       0xAC
+#define LORA_PROTOCOL_FEC_HDR_PARITY 4
+#define LORA_PROTOCOL_FEC_HDR_LEN    (2 + LORA_PROTOCOL_FEC_HDR_PARITY)
+#define LORA_PROTOCOL_FEC_BLOCKS(len) (((len) + LORA_FEC_BLOCK_LEN - 1) / LORA_FEC_BLOCK_LEN)
+
+// 最长的帧：定点前缀 + FEC 包裹的满负载 V1 帧 (发送封包缓冲区按此分配)
+#define LORA_PROTOCOL_V1_MAX_LEN     (10 + LORA_MAX_PAYLOAD_LEN + 2 + 2)
+#define LORA_PROTOCOL_MAX_FRAME_LEN  (3 + LORA_PROTOCOL_FEC_HDR_LEN + LORA_PROTOCOL_V1_MAX_LEN + \
+                                      LORA_PROTOCOL_FEC_BLOCKS(LORA_PROTOCOL_V1_MAX_LEN) * LORA_FEC_PARITY_LEN)
+
+#define LORA_FRAME_FMT_V1        0
+#define LORA_FRAME_FMT_V2        1
+
+// [新增] 能力声明 (V1 ACK 负载第 1 字节)
+#define LORA_PROTOCOL_CAP_V2     0x01 // 支持接收 V2 帧
+#define LORA_PROTOCOL_CAP_HCS    0x02 // [新增] 支持接收带帧头校验的 V2 帧 (并处理 NACK)
+#define LORA_PROTOCOL_CAP_EXT    0x04 // [新增] 支持接收聚合帧、压缩负载与捎带确认 (发 V2 帧的对端均支持)
+
 #define LORA_CTRL_MASK_TYPE      0x80 // 1=ACK, 0=Data
-#define LORA_CTRL_MASK_NEED_ACK  0x40 // 1=Need ACK
+#define LORA_CTRL_MASK_NEED_ACK  0x40 // 1=Need ACK ([新增] 与 TYPE 同时置位表示 NACK：Seq 帧 CRC 校验失败，请立即重传)
 #define LORA_CTRL_MASK_HAS_CRC   0x20 // 1=Has CRC
+#define LORA_CTRL_MASK_FRAG      0x10 // [新增] 1=分片帧 (负载以分片头开始)
+#define LORA_CTRL_MASK_AGG       0x08 // [新增] 1=聚合帧 (负载为多条 [长度][子消息])
+#define LORA_CTRL_MASK_COMP      0x04 // [新增] 1=负载已压缩 (先压缩后加密；聚合帧负载首字节为子消息压缩位图)
+#define LORA_CTRL_MASK_BLOCK     0x02 // [新增] 1=块确认 (ACK 帧：Seq 为最新收到的序号，负载 [V1 能力字节] 之后为位图，
+                                      //        bit i = Seq-1-i 已收到；早于 Seq 帧发出而未收到的帧视为丢失)
+#define LORA_CTRL_MASK_PIGGY     0x01 // [新增] 1=捎带确认 (数据帧：负载前附 [AckSeq(2)][MapLen(1)][Map]，含义同块确认，
+                                      //        帧头 Len 含该前缀)
+
+// [新增] 捎带确认前缀
+#define LORA_PROTOCOL_PIGGY_HDR_LEN  3  // AckSeq(2, LE) + MapLen(1)
+#define LORA_PROTOCOL_PIGGY_MAP_MAX  8  // 位图最多 8 字节 (覆盖 64 个序号)
 
 // 最大负载长度 (根据缓冲区大小估算，预留头部开销)
 #define LORA_MAX_PAYLOAD_LEN     200
@@ -41,6 +92,19 @@ typedef struct {
     bool     IsAckPacket;    // 是否为 ACK 包
     bool     NeedAck;        // 是否需要回复 ACK
     bool     HasCrc;         // 是否包含 CRC
+    bool     IsFragment;     // [新增] 是否为分片帧
+    bool     IsAggregate;    // [新增] 是否为聚合帧
+    bool     IsCompressed;   // [新增] 负载是否已压缩
+    bool     IsBlockAck;     // [新增] 块确认 (ACK 帧负载带序号位图)
+    uint8_t  Format;         // [新增] 帧格式 (LORA_FRAME_FMT_V1/V2)
+    bool     SeqShort;       // [新增] 帧中只带序号低 8 位 (V2 确认帧与 ACK 帧)
+    bool     UseFec;         // [新增] 以 FEC 帧包裹 (发送时由调用方指定，接收时由解包填写)
+    bool     HasPiggyAck;    // [新增] 数据帧捎带确认 (解包时已从负载中剥离)
+    uint16_t PiggyAckSeq;    // [新增] 捎带确认的基序号 (16 位)
+    uint8_t  PiggyAckLen;    // [新增] 捎带确认位图字节数
+    uint8_t  PiggyAckMap[LORA_PROTOCOL_PIGGY_MAP_MAX]; // [新增] 捎带确认位图 (bit i = PiggyAckSeq-1-i 已收到)
+    bool     HdrCheck;       // [新增] V2 帧带帧头校验 (接收方 CRC 失败时可回 NACK)
+    bool     CrcError;       // [新增] 帧头校验通过但 CRC 失败 (只有地址、序号与控制域有效，负载为空)
     
     // --- 地址域 ---
     uint16_t TargetID;       // 目标 ID
@@ -53,13 +117,86 @@ typedef struct {
     
 } LoRa_Packet_t;
 
+/**
+ * @brief 帧头摘要 (不校验 CRC，仅用于发送调度定位帧边界)
+ */
+typedef struct {
+    uint16_t FrameLen;       // 整帧长度 (含定点前缀与包尾)
+    uint8_t  Ctrl;           // 控制字
+    uint16_t Sequence;       // 包序号
+    uint16_t TargetID;       // 目标 ID
+    bool     SeqShort;       // [新增] Sequence 只有低 8 位有效
+} LoRa_FrameInfo_t;
+
+/**
+ * @brief [新增] 流式接收解析器 (跨调用保持进度)
+ * @note  字节逐个推进：帧头一到齐即确定帧长，CRC 随字节到达增量计算，帧尾到达时解包。
+ *        候选帧被否定时只丢弃其首字节，其后已缓存的字节重新扫描 (与整块解析的重新同步一致)。
+ */
+typedef struct {
+    uint8_t  buf[LORA_PROTOCOL_MAX_FRAME_LEN]; // 候选帧 (buf[0] 为帧头)
+    uint16_t fill;      // 已缓存字节数
+    uint16_t scan;      // 已推进的字节数
+    uint16_t need;      // 整帧长度 (0=帧头未齐)
+    uint16_t crc;       // 增量 CRC
+    uint16_t crc_start; // CRC 覆盖区间 [crc_start, crc_end) (crc_end=0 表示不校验或校验在解包时进行)
+    uint16_t crc_end;
+    uint32_t skipped;   // [新增] 重新同步累计丢弃的字节数 (噪声/残帧)
+} LoRa_Protocol_Parser_t;
+
 // ============================================================
 //                    3. 核心接口
 // ============================================================
 
+/**
+ * @brief  [新增] 初始化 (清空对端格式协商表)
+ */
+void LoRa_Manager_Protocol_Init(void);
+
+/**
+ * @brief  [新增] 根据收到的帧更新对端的格式能力
+ * @note   收到 V2 帧即认为对端支持 V2 (及扩展负载)；V1 ACK 按负载中的能力字节更新
+ *         (对端回退到旧版本后会自动降级)。
+ */
+void LoRa_Manager_Protocol_LearnPeer(const LoRa_Packet_t *packet);
+
+/**
+ * @brief  [新增] 选择发往某目标的帧格式
+ * @return LORA_FRAME_FMT_V2 (对端已声明支持) 或 LORA_FRAME_FMT_V1
+ */
+uint8_t LoRa_Manager_Protocol_SelectFormat(uint16_t target_id);
+
+/**
+ * @brief  [新增] 手动指定某条链路是否使用 FEC
+ * @param  peer_id: 对端 ID
+ * @param  enable: true=发往该对端的所有帧 (含 ACK) 都以 FEC 帧发送
+ */
+void LoRa_Manager_Protocol_SetLinkFec(uint16_t peer_id, bool enable);
+
+/**
+ * @brief  [新增] 发往某目标的帧是否使用 FEC
+ * @note   手动指定过，或对端最近发来的帧是 FEC 帧 (链路两个方向对称使用)。
+ *         LORA_FEC_ENABLE 关闭时恒为 false。
+ */
+bool LoRa_Manager_Protocol_LinkFec(uint16_t target_id);
+
+/**
+ * @brief  [新增] 发往某目标的确认帧是否带帧头校验
+ * @note   对端已协商 V2 且声明支持帧头校验 (LORA_NACK_ENABLE 关闭时恒为 false)。
+ */
+bool LoRa_Manager_Protocol_LinkHdrCheck(uint16_t target_id);
+
+/**
+ * @brief  [新增] 发往某目标的帧能否使用扩展负载 (聚合帧、压缩负载、捎带确认)
+ * @note   对端已声明 LORA_PROTOCOL_CAP_EXT 或已发来 V2 帧。未知对端 (如旧版 V1 节点)
+ *         与广播目标恒为 false，按旧格式发送。
+ */
+bool LoRa_Manager_Protocol_LinkExt(uint16_t target_id);
+
 /**
  * @brief  将结构体打包为字节流 (Serialize)
- * @param  packet: 待发送的数据包结构体
+ * @param  packet: 待发送的数据包结构体 (按 packet->Format 选择 V1/V2 格式，
+ *                 packet->UseFec 时再以 FEC 帧包裹)
  * @param  buffer: 输出缓冲区
  * @param  buffer_size: 缓冲区最大大小
  * @param  tmode: 当前传输模式 (0=透传, 1=定点) - 影响包头格式
@@ -80,6 +217,7 @@ uint16_t LoRa_Manager_Protocol_Pack(const LoRa_Packet_t *packet,
  * @param  local_id: 本地 ID (用于地址过滤)
  * @param  group_id: 组 ID (用于地址过滤)
  * @return 解析消耗的字节数 (0表示未找到完整包，>0表示成功解析并消耗了多少字节)
+ * @note   [新增] 带帧头校验的 V2 帧 CRC 失败时仍消耗整帧，并置 packet->CrcError 返回帧头信息。
  */
 uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer, 
                                       uint16_t length, 
@@ -87,4 +225,56 @@ uint16_t LoRa_Manager_Protocol_Unpack(const uint8_t *buffer,
                                       uint16_t local_id,
                                       uint16_t group_id);
 
+/**
+ * @brief  [新增] 复位流式解析器 (丢弃缓存的半帧，丢弃字节计数清零)
+ */
+void LoRa_Manager_Protocol_ParserReset(LoRa_Protocol_Parser_t *parser);
+
+/**
+ * @brief  [新增] 放弃解析器当前的候选帧 (接收空闲超时)
+ * @note   只丢弃候选帧的帧头 (计入 parser->skipped)，其后已缓存的字节由下一次
+ *         LoRa_Manager_Protocol_ParserFeed 重新扫描。没有缓存字节时无动作。
+ */
+void LoRa_Manager_Protocol_ParserResync(LoRa_Protocol_Parser_t *parser);
+
+/**
+ * @brief  [新增] 向流式解析器送入字节，解出一帧即返回
+ * @param  data: 新到达的字节 (可为 NULL/0，仅推进解析器内已缓存的字节)
+ * @param  packet: 输出解析后的结构体 (填充规则同 LoRa_Manager_Protocol_Unpack)
+ * @param  done: 输出 true=消耗了一个完整帧
+ * @return 从 data 中消耗的字节数 (done 时其余字节留待下次送入)
+ * @note   每个字节只推进一次 (重新同步时除外)，与缓冲区中积压的数据量无关。
+ *         [新增] 重新同步时一次扫描跳过所有不可能是帧头的字节，跳过的字节计入 parser->skipped。
+ */
+uint16_t LoRa_Manager_Protocol_ParserFeed(LoRa_Protocol_Parser_t *parser,
+                                          const uint8_t *data,
+                                          uint16_t length,
+                                          LoRa_Packet_t *packet,
+                                          uint16_t local_id,
+                                          uint16_t group_id,
+                                          bool *done);
+
+/**
+ * @brief  [新增] 读取缓冲区头部第一帧的帧头信息 (Peek)
+ * @note   队列中的帧由本机 Pack 生成，格式可信，此处只做边界检查。
+ * @param  buffer: 输入缓冲区 (从帧起始处开始，含定点前缀)
+ * @param  length: 缓冲区有效数据长度
+ * @param  tmode: 传输模式 (1=定点模式，帧前带 3 字节前缀)
+ * @param  info: 输出帧头信息
+ * @return 整帧长度 (0=不是完整帧)
+ */
+uint16_t LoRa_Manager_Protocol_PeekFrame(const uint8_t *buffer,
+                                         uint16_t length,
+                                         uint8_t tmode,
+                                         LoRa_FrameInfo_t *info);
+
+/**
+ * @brief  [新增] 估算一帧的空中时间 (Time-on-Air)
+ * @note   ATK-LORA-01 未公开各空速的 SF/BW，按标称速率近似 (CR 4/5，显式头，开启 CRC)。
+ * @param  air_rate: 空速 (LoRa_AirRate_t)
+ * @param  air_len: 空中字节数 (定点模式不含 3 字节前缀)
+ * @return 空中时间 (us)
+ */
+uint32_t LoRa_Manager_Protocol_AirTimeUs(uint8_t air_rate, uint16_t air_len);
+
 #endif // __LORA_MANAGER_PROTOCOL_H
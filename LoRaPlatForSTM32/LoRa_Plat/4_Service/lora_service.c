@@ -236,7 +236,16 @@ void LoRa_Service_SoftReset(void) {
 }
 
 uint32_t LoRa_Service_GetSleepDuration(void) {
-    return LoRa_Manager_GetSleepDuration();
+    uint32_t sleep_ms = LoRa_Manager_GetSleepDuration();
+    
+    // [修复] 软重启倒计时期间，休眠时长不得越过重启时刻
+    if (s_SvcCtx.state == SVC_STATE_REBOOT_NOW) return 0;
+    if (s_SvcCtx.state == SVC_STATE_REBOOT_WAIT) {
+        uint32_t elapsed = OSAL_GetTick() - s_SvcCtx.reboot_tick;
+        uint32_t remain = (elapsed > LORA_REBOOT_DELAY_MS) ? 0 : (LORA_REBOOT_DELAY_MS - elapsed + 1);
+        if (remain < sleep_ms) sleep_ms = remain;
+    }
+    return sleep_ms;
 }
 
 void LoRa_Service_FactoryReset(void) {
@@ -306,3 +315,7 @@ void LoRa_Service_RegisterCipher(const LoRa_Cipher_t *cipher) {
     s_SavedCipher = cipher;
     LoRa_Manager_RegisterCipher(cipher);
 }
+
+void LoRa_Service_SetLinkFec(uint16_t peer_id, bool enable) {
+    LoRa_Manager_SetLinkFec(peer_id, enable);
+}
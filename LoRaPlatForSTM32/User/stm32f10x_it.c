@@ -171,7 +171,8 @@ void EXTI9_5_IRQHandler(void)
     {
         EXTI_ClearITPendingBit(EXTI_Line5);
         // 通知协议栈：AUX 状态变了（可能发送完了，或者收到数据了）
-        LoRa_Port_NotifyHwEvent();
+        // [变更] 同时记录下降沿时刻，协议栈据此精确计算收发切换
+        LoRa_Port_OnAuxEdge();
     }
 }
 
@@ -0,0 +1,117 @@
+/**
+  ******************************************************************************
+  * @file    lora_osal_posix.c
+  * @author  LoRaPlat Team
+  * @brief   OSAL 接口适配层 (Linux / POSIX 主机版)
+  *          单调时钟 + pthread 递归互斥锁 + stderr 日志。
+  *          用于在 PC 上以原生进程运行完整协议栈 (perf/valgrind/sanitizer)。
+  ******************************************************************************
+  */
+
+#include "lora_osal.h"
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+
+// 临界区使用递归锁：同一线程嵌套进入不会死锁
+static pthread_mutex_t s_LoRaMutex;
+static pthread_once_t  s_MutexOnce = PTHREAD_ONCE_INIT;
+
+// 时间基准 (进程启动后第一次取时刻)，使 Tick 从 0 附近开始
+static uint64_t s_TickBaseMs = 0;
+
+// ============================================================
+//                    1. 接口适配实现
+// ============================================================
+
+static uint64_t _MonotonicMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)(ts.tv_nsec / 1000000L);
+}
+
+// 适配 GetTick (ms, 32 位自然回绕)
+static uint32_t POSIX_GetTick(void) {
+    return (uint32_t)(_MonotonicMs() - s_TickBaseMs);
+}
+
+// 适配 DelayMs (被信号打断时继续睡完剩余时间)
+static void POSIX_DelayMs(uint32_t ms) {
+    struct timespec req = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&req, &req) != 0 && errno == EINTR) {
+    }
+}
+
+static void _MutexInit(void) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_LoRaMutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+// 适配 EnterCritical (主机上没有关中断，用互斥锁保护应用线程与 Run 线程)
+static uint32_t POSIX_EnterCritical(void) {
+    pthread_mutex_lock(&s_LoRaMutex);
+    return 0;
+}
+
+static void POSIX_ExitCritical(uint32_t ctx) {
+    (void)ctx;
+    pthread_mutex_unlock(&s_LoRaMutex);
+}
+
+// 适配日志打印 (带毫秒时间戳，输出到 stderr，不污染 stdout 的业务数据)
+static void POSIX_Log(const char *fmt, va_list args) {
+    fprintf(stderr, "[%8u] ", (unsigned)POSIX_GetTick());
+    vfprintf(stderr, fmt, args);
+}
+
+// 适配 HexDump
+static void POSIX_LogHex(const char *tag, const void *data, uint16_t len) {
+    const uint8_t *p = (const uint8_t *)data;
+    fprintf(stderr, "[%8u] %s (Len=%d): ", (unsigned)POSIX_GetTick(), tag, len);
+    for (uint16_t i = 0; i < len; i++) {
+        fprintf(stderr, "%02X ", p[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+static void* POSIX_Malloc(uint32_t size) {
+    return malloc(size);
+}
+
+static void POSIX_Free(void* ptr) {
+    free(ptr);
+}
+
+// ============================================================
+//                    2. 接口注册结构体
+// ============================================================
+
+static const LoRa_OSAL_Interface_t s_OsalImpl = {
+    .GetTick       = POSIX_GetTick,
+    .DelayMs       = POSIX_DelayMs,
+    .EnterCritical = POSIX_EnterCritical,
+    .ExitCritical  = POSIX_ExitCritical,
+    .Log           = POSIX_Log,
+    .LogHex        = POSIX_LogHex,
+    .Malloc        = POSIX_Malloc,
+    .Free          = POSIX_Free
+};
+
+// ============================================================
+//                    3. 公开初始化函数
+// ============================================================
+
+// 在 main.c 中调用此函数
+void LoRa_OSAL_Init_POSIX(void) {
+    pthread_once(&s_MutexOnce, _MutexInit);
+    if (s_TickBaseMs == 0) {
+        s_TickBaseMs = _MonotonicMs();
+    }
+    LoRa_OSAL_Init(&s_OsalImpl);
+}
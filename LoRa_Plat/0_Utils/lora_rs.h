@@ -0,0 +1,38 @@
+/**
+  ******************************************************************************
+  * @file    lora_rs.h
+  * @author  LoRaPlat Team
+  * @brief   Reed-Solomon 编解码工具 (GF(256)，本原多项式 0x11D)
+  *          - 系统码：码字 = [数据 k 字节][校验 nparity 字节]，cw[0] 为最高次项。
+  *          - 生成多项式根为 a^0 .. a^(nparity-1)，可纠正 nparity/2 个字节错误。
+  *          - 与 CRC16 一样按位计算，不使用查找表 (不占 RAM/Flash 表空间)。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_RS_H
+#define __LORA_RS_H
+
+#include <stdint.h>
+
+/** @brief 支持的最大校验字节数 */
+#define LORA_RS_MAX_PARITY      16
+
+/**
+ * @brief  计算校验字节
+ * @param  data: 数据指针
+ * @param  k: 数据长度 (k + nparity <= 255)
+ * @param  parity: 输出校验字节 (nparity 字节)
+ * @param  nparity: 校验字节数 (偶数，<= LORA_RS_MAX_PARITY)
+ */
+void LoRa_RS_Encode(const uint8_t *data, uint8_t k, uint8_t *parity, uint8_t nparity);
+
+/**
+ * @brief  原地纠错
+ * @param  cw: 码字 (数据 + 校验，共 n 字节)
+ * @param  n: 码字长度
+ * @param  nparity: 校验字节数
+ * @return 纠正的字节数 (0=无错误)，-1=错误过多无法纠正 (码字保持不变)
+ */
+int LoRa_RS_Decode(uint8_t *cw, uint8_t n, uint8_t nparity);
+
+#endif // __LORA_RS_H
@@ -0,0 +1,459 @@
+/**
+  ******************************************************************************
+  * @file    lora_port_posix.c
+  * @author  LoRaPlat Team
+  * @brief   POSIX 硬件接口实现 (Linux 主机版)
+  *          通道可以是真实串口 (USB-TTL 接 ATK-LORA-01)、pty 或 socketpair。
+  *          - 串口且支持 Modem 控制线：MD0 -> RTS, AUX <- CTS
+  *          - 其他 (pty/socketpair)：Port 内部仿真模组配置模式，AT 指令本地应答 OK
+  ******************************************************************************
+  */
+
+#include "lora_port.h"
+#include "lora_port_posix.h"
+#include "lora_osal.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <sys/random.h>
+#include <string.h>
+
+// --- 发送暂存区 (模拟 DMA TX 缓冲：内核一次写不完的部分暂存于此) ---
+#define PORT_TX_BUF_SIZE     LORA_PORT_DMA_TX_SIZE
+
+// --- [新增] 接收暂存区 (模拟 DMA RX 缓冲：已从内核读出、尚未被上层消费的字节) ---
+#define PORT_RX_BUF_SIZE     LORA_PORT_DMA_RX_SIZE
+
+// --- 仿真模组：AT 应答回环缓冲 ---
+#define PORT_EMU_RX_SIZE     64
+#define PORT_EMU_LINE_SIZE   64
+// 退出配置模式后模组重启，AUX 拉高的时间窗口 (ms)
+#define PORT_EMU_REBOOT_MS   150
+
+static int      s_Fd = -1;
+static bool     s_IsTty = false;
+static bool     s_HasModemLines = false;
+static bool     s_Emulate = false;
+
+static uint8_t  s_TxBuf[PORT_TX_BUF_SIZE];
+static uint16_t s_TxLen = 0;
+static uint16_t s_TxOff = 0;
+static bool     s_TxLent = false;   // [新增] s_TxBuf 已借出 (Acquire 后、Commit 前)
+
+static uint8_t  s_RxBuf[PORT_RX_BUF_SIZE];
+static uint16_t s_RxHead = 0;       // 下一个未消费字节
+static uint16_t s_RxTail = 0;       // 有效数据末尾
+
+// 仿真模组状态
+static bool     s_Md0 = false;
+static uint32_t s_RebootTick = 0;
+static bool     s_Rebooting = false;
+static uint8_t  s_EmuRx[PORT_EMU_RX_SIZE];
+static uint16_t s_EmuRxLen = 0;
+static char     s_EmuLine[PORT_EMU_LINE_SIZE];
+static uint16_t s_EmuLineLen = 0;
+
+// 硬件事件挂起标志 (与 STM32/ESP32 语义一致)
+static volatile bool s_HwEventPending = false;
+
+// [新增] AUX 下降沿检测 (轮询)
+static bool     s_AuxLast = false;
+static uint32_t s_AuxIdleTick = 0;
+
+// ============================================================
+//                    0. 内部辅助
+// ============================================================
+
+static speed_t _BaudToSpeed(uint32_t baudrate) {
+    switch (baudrate) {
+        case 1200:   return B1200;
+        case 2400:   return B2400;
+        case 4800:   return B4800;
+        case 9600:   return B9600;
+        case 19200:  return B19200;
+        case 38400:  return B38400;
+        case 57600:  return B57600;
+        case 115200: return B115200;
+        default:     return B9600;
+    }
+}
+
+// 尝试把暂存区剩余数据写入内核
+static void _FlushTx(void) {
+    while (s_Fd >= 0 && s_TxOff < s_TxLen) {
+        ssize_t n = write(s_Fd, &s_TxBuf[s_TxOff], s_TxLen - s_TxOff);
+        if (n > 0) {
+            s_TxOff += (uint16_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break; // EAGAIN: 内核缓冲满，下次再写
+        }
+    }
+    if (s_TxOff >= s_TxLen) {
+        if (s_TxLen > 0) s_HwEventPending = true; // 发送完成也是硬件事件
+        s_TxLen = 0;
+        s_TxOff = 0;
+    }
+}
+
+// 仿真模组：处理一行 AT 指令，应答 OK
+static void _EmuHandleAtByte(uint8_t byte) {
+    if (s_EmuLineLen < PORT_EMU_LINE_SIZE - 1) {
+        s_EmuLine[s_EmuLineLen++] = (char)byte;
+    }
+    if (byte != '\n') return;
+
+    static const char k_Ok[] = "OK\r\n";
+    if (s_EmuLineLen >= 2 && s_EmuLine[0] == 'A' && s_EmuLine[1] == 'T' &&
+        s_EmuRxLen + sizeof(k_Ok) - 1 <= PORT_EMU_RX_SIZE) {
+        memcpy(&s_EmuRx[s_EmuRxLen], k_Ok, sizeof(k_Ok) - 1);
+        s_EmuRxLen += sizeof(k_Ok) - 1;
+    }
+    s_EmuLineLen = 0;
+}
+
+// ============================================================
+//                    1. 主机扩展接口 (lora_port_posix.h)
+// ============================================================
+
+void LoRa_Port_POSIX_Attach(int fd, bool emulate_module) {
+    LoRa_Port_POSIX_Close();
+
+    s_Fd = fd;
+    s_Emulate = emulate_module;
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+    struct termios tio;
+    s_IsTty = (tcgetattr(fd, &tio) == 0);
+
+    int lines = 0;
+    s_HasModemLines = s_IsTty && (ioctl(fd, TIOCMGET, &lines) == 0);
+}
+
+bool LoRa_Port_POSIX_Open(const char *path) {
+    LORA_CHECK(path, false);
+
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0) {
+        LORA_LOG("[PORT] Open %s Failed (errno %d)\r\n", path, errno);
+        return false;
+    }
+
+    int lines = 0;
+    bool has_modem = (ioctl(fd, TIOCMGET, &lines) == 0);
+    LoRa_Port_POSIX_Attach(fd, !has_modem);
+
+    LORA_LOG("[PORT] Opened %s (%s)\r\n", path, has_modem ? "Module" : "Emulated");
+    return true;
+}
+
+int LoRa_Port_POSIX_GetFd(void) {
+    return s_Fd;
+}
+
+void LoRa_Port_POSIX_Close(void) {
+    if (s_Fd >= 0) close(s_Fd);
+    s_Fd = -1;
+    s_IsTty = false;
+    s_HasModemLines = false;
+    s_TxLen = 0;
+    s_TxOff = 0;
+    s_TxLent = false;
+    s_RxHead = 0;
+    s_RxTail = 0;
+    s_EmuRxLen = 0;
+    s_EmuLineLen = 0;
+}
+
+// ============================================================
+//                    2. 初始化与配置
+// ============================================================
+
+void LoRa_Port_Init(uint32_t baudrate) {
+    if (s_Fd < 0) {
+        LORA_LOG("[PORT] No fd attached! Call LoRa_Port_POSIX_Open first.\r\n");
+        return;
+    }
+    LoRa_Port_ReInitUart(baudrate);
+
+    // 初始状态同步
+    LoRa_Port_SetMD0(false);
+    LoRa_Port_SyncAuxState();
+}
+
+void LoRa_Port_ReInitUart(uint32_t baudrate) {
+    if (!s_IsTty) return; // socketpair 无波特率概念
+
+    struct termios tio;
+    if (tcgetattr(s_Fd, &tio) != 0) return;
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= (CLOCAL | CREAD);
+    tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+    cfsetispeed(&tio, _BaudToSpeed(baudrate));
+    cfsetospeed(&tio, _BaudToSpeed(baudrate));
+    tio.c_cc[VMIN]  = 0;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(s_Fd, TCSANOW, &tio);
+}
+
+// ============================================================
+//                    3. 引脚控制
+// ============================================================
+
+void LoRa_Port_SetMD0(bool level) {
+    // 下降沿：模组退出配置模式并重启，AUX 短暂拉高
+    if (s_Md0 && !level) {
+        s_Rebooting = true;
+        s_RebootTick = OSAL_GetTick();
+    }
+    s_Md0 = level;
+
+    if (s_HasModemLines && !s_Emulate) {
+        // 注意：多数 USB-TTL 的 RTS 引脚为低有效，硬件上需反相后接 MD0
+        int bit = TIOCM_RTS;
+        ioctl(s_Fd, level ? TIOCMBIS : TIOCMBIC, &bit);
+    }
+}
+
+void LoRa_Port_SetRST(bool level) {
+    (void)level;
+}
+
+bool LoRa_Port_GetAUX(void) {
+    if (s_HasModemLines && !s_Emulate) {
+        int lines = 0;
+        if (ioctl(s_Fd, TIOCMGET, &lines) == 0) {
+            return (lines & TIOCM_CTS) != 0;
+        }
+        return false;
+    }
+
+    // 仿真：仅在重启窗口内为 Busy
+    if (s_Rebooting) {
+        if (OSAL_GetTick() - s_RebootTick < PORT_EMU_REBOOT_MS) return true;
+        s_Rebooting = false;
+    }
+    return false;
+}
+
+uint32_t LoRa_Port_GetAuxIdleTick(void) {
+    // 无 AUX 边沿中断：调用时轮询电平检测下降沿
+    bool aux = LoRa_Port_GetAUX();
+    if (s_AuxLast && !aux) s_AuxIdleTick = OSAL_GetTick();
+    s_AuxLast = aux;
+    return s_AuxIdleTick;
+}
+
+void LoRa_Port_SyncAuxState(void) {
+    uint32_t ctx = OSAL_EnterCritical();
+    s_TxLen = 0;
+    s_TxOff = 0;
+    OSAL_ExitCritical(ctx);
+}
+
+// ============================================================
+//                    4. 发送接口 (TX)
+// ============================================================
+
+bool LoRa_Port_IsTxBusy(void) {
+    if (s_TxLen > 0) _FlushTx();
+    if (s_TxLen > 0) return true;
+
+    // 真实串口：内核发送队列未空也视为 "DMA 搬运中"
+    if (s_IsTty) {
+        int outq = 0;
+        if (ioctl(s_Fd, TIOCOUTQ, &outq) == 0 && outq > 0) return true;
+    }
+    return false;
+}
+
+uint16_t LoRa_Port_TransmitData(const uint8_t *data, uint16_t len) {
+    uint16_t cap;
+    if (!data || len == 0) return 0;
+
+    uint8_t *buf = LoRa_Port_AcquireTxBuffer(&cap);
+    if (!buf) return 0;
+    if (len > cap) {
+        LoRa_Port_CommitTx(0);
+        return 0;
+    }
+    memcpy(buf, data, len);
+    return LoRa_Port_CommitTx(len);
+}
+
+uint8_t *LoRa_Port_AcquireTxBuffer(uint16_t *capacity) {
+    if (s_Fd < 0) return NULL;
+
+    uint32_t ctx = OSAL_EnterCritical();
+
+    if (s_TxLen > 0) _FlushTx();
+    if (s_TxLent || s_TxLen > 0) {
+        OSAL_ExitCritical(ctx);
+        return NULL; // 上一帧还未写完
+    }
+    s_TxLent = true;
+
+    OSAL_ExitCritical(ctx);
+    if (capacity) *capacity = PORT_TX_BUF_SIZE;
+    return s_TxBuf;
+}
+
+uint16_t LoRa_Port_CommitTx(uint16_t len) {
+    if (!s_TxLent) return 0;
+
+    uint32_t ctx = OSAL_EnterCritical();
+
+    s_TxLent = false;
+    if (len == 0 || len > PORT_TX_BUF_SIZE) {
+        OSAL_ExitCritical(ctx);
+        return 0;
+    }
+
+    // 仿真模组的配置模式：AT 指令不上线路，本地应答
+    if (s_Emulate && s_Md0) {
+        for (uint16_t i = 0; i < len; i++) _EmuHandleAtByte(s_TxBuf[i]);
+        s_HwEventPending = true;
+        OSAL_ExitCritical(ctx);
+        return len;
+    }
+
+    s_TxLen = len;
+    s_TxOff = 0;
+    _FlushTx();
+
+    OSAL_ExitCritical(ctx);
+    return len;
+}
+
+// ============================================================
+//                    5. 接收接口 (RX)
+// ============================================================
+
+// [新增] 把仿真模组的 AT 应答与内核中的新数据追加到接收暂存区
+static void _FillRx(void) {
+    if (s_RxHead > 0) {
+        // 已消费的前部腾出来 (上层通常整段消费，此时无需搬移)
+        memmove(s_RxBuf, &s_RxBuf[s_RxHead], s_RxTail - s_RxHead);
+        s_RxTail -= s_RxHead;
+        s_RxHead = 0;
+    }
+
+    // 先交付仿真模组的 AT 应答
+    if (s_EmuRxLen > 0) {
+        uint16_t cnt = PORT_RX_BUF_SIZE - s_RxTail;
+        if (cnt > s_EmuRxLen) cnt = s_EmuRxLen;
+        memcpy(&s_RxBuf[s_RxTail], s_EmuRx, cnt);
+        memmove(s_EmuRx, &s_EmuRx[cnt], s_EmuRxLen - cnt);
+        s_EmuRxLen -= cnt;
+        s_RxTail += cnt;
+        return;
+    }
+
+    if (s_Fd < 0 || s_RxTail >= PORT_RX_BUF_SIZE) return;
+
+    ssize_t n;
+    do {
+        n = read(s_Fd, &s_RxBuf[s_RxTail], PORT_RX_BUF_SIZE - s_RxTail);
+    } while (n < 0 && errno == EINTR);
+
+    if (n > 0) {
+        s_HwEventPending = true;
+        s_RxTail += (uint16_t)n;
+    }
+}
+
+uint16_t LoRa_Port_ReceiveData(uint8_t *buf, uint16_t max_len) {
+    if (!buf || max_len == 0) return 0;
+
+    LoRa_PortSpan_t span[2];
+    uint16_t cnt = LoRa_Port_PeekRx(span);
+    if (cnt > max_len) cnt = max_len;
+    memcpy(buf, span[0].data, cnt);
+    LoRa_Port_ConsumeRx(cnt);
+    return cnt;
+}
+
+uint16_t LoRa_Port_PeekRx(LoRa_PortSpan_t span[2]) {
+    _FillRx();
+    // 暂存区是线性的，只有一段
+    span[0].data = &s_RxBuf[s_RxHead];
+    span[0].len = s_RxTail - s_RxHead;
+    span[1].data = s_RxBuf;
+    span[1].len = 0;
+    return span[0].len;
+}
+
+void LoRa_Port_ConsumeRx(uint16_t len) {
+    if (len > s_RxTail - s_RxHead) len = s_RxTail - s_RxHead;
+    s_RxHead += len;
+    if (s_RxHead == s_RxTail) {
+        s_RxHead = 0;
+        s_RxTail = 0;
+    }
+}
+
+void LoRa_Port_ClearRxBuffer(void) {
+    s_EmuRxLen = 0;
+    s_RxHead = 0;
+    s_RxTail = 0;
+    if (s_Fd < 0) return;
+
+    if (s_IsTty) {
+        tcflush(s_Fd, TCIFLUSH);
+        return;
+    }
+    uint8_t dummy[64];
+    while (read(s_Fd, dummy, sizeof(dummy)) > 0) {
+    }
+}
+
+// [新增] 暂存区只在上层消费后才从内核读入新数据，不会被覆盖
+bool LoRa_Port_CheckAndClearRxOverrun(void) {
+    return false;
+}
+
+// ============================================================
+//                    6. 其他能力
+// ============================================================
+
+uint32_t LoRa_Port_GetEntropy32(void) {
+    uint32_t val = 0;
+    if (getrandom(&val, sizeof(val), GRND_NONBLOCK) != (ssize_t)sizeof(val)) {
+        val = OSAL_GetTick() ^ 0x12345678;
+    }
+    return val;
+}
+
+// ============================================================
+//                    7. 低功耗支持
+// ============================================================
+
+void LoRa_Port_NotifyHwEvent(void) {
+    s_HwEventPending = true;
+}
+
+void LoRa_Port_OnAuxEdge(void) {
+    LoRa_Port_GetAuxIdleTick();
+    s_HwEventPending = true;
+}
+
+bool LoRa_Port_CheckAndClearHwEvent(void) {
+    uint32_t ctx = OSAL_EnterCritical();
+    bool ret = s_HwEventPending;
+    s_HwEventPending = false; // 读后即焚
+    OSAL_ExitCritical(ctx);
+
+    // 主机上没有 RX 中断：fd 可读即视为有挂起的硬件事件
+    if (!ret && s_Fd >= 0) {
+        struct pollfd pfd = { .fd = s_Fd, .events = POLLIN };
+        ret = (poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLIN);
+    }
+    return ret || (s_EmuRxLen > 0);
+}
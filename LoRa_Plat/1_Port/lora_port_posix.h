@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file    lora_port_posix.h
+  * @author  LoRaPlat Team
+  * @brief   POSIX 硬件接口扩展 (Linux 主机版)
+  *          通用 Port 接口见 lora_port.h，本文件仅声明主机特有的绑定函数。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_PORT_POSIX_H
+#define __LORA_PORT_POSIX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief  打开串口设备或 pty 并绑定为 LoRa 通道
+ * @param  path: 设备路径 (e.g. "/dev/ttyUSB0", "/dev/pts/3")
+ * @return true=成功
+ * @note   若设备支持 Modem 控制线，则 MD0 映射到 RTS、AUX 映射到 CTS (真实模组)；
+ *         否则自动启用模组仿真 (本地应答 AT 指令，AUX 恒为空闲)。
+ *         必须在 LoRa_Service_Init 之前调用。
+ */
+bool LoRa_Port_POSIX_Open(const char *path);
+
+/**
+ * @brief  绑定一个已打开的文件描述符 (socketpair / pty master / 串口)
+ * @param  fd: 文件描述符 (Port 会将其设为非阻塞)，所有权转交给 Port
+ * @param  emulate_module: true=在 Port 内仿真模组的配置模式 (AT 指令本地应答)
+ */
+void LoRa_Port_POSIX_Attach(int fd, bool emulate_module);
+
+/**
+ * @brief  获取当前绑定的文件描述符 (供主循环 poll() 休眠使用)
+ * @return fd, 未绑定时返回 -1
+ */
+int LoRa_Port_POSIX_GetFd(void);
+
+/**
+ * @brief  关闭并解绑当前文件描述符
+ */
+void LoRa_Port_POSIX_Close(void);
+
+#endif // __LORA_PORT_POSIX_H
@@ -0,0 +1,36 @@
+/**
+  ******************************************************************************
+  * @file    lora_manager_compress.h
+  * @author  LoRaPlat Team
+  * @brief   LoRa 负载压缩 (LZSS，heatshrink 式位流)
+  *          - 一次性压缩/解压整条消息，输入本身即滑动窗口，不需要额外 RAM。
+  *          - 窗口 256 字节 (8 位偏移)，匹配长度 2~17 (4 位长度)。
+  *          - 位流 (高位在前)：
+  *              1 + 8 位字面量
+  *              0 + 8 位 (偏移-1) + 4 位 (长度-2)
+  *            末字节不足 8 位时补 0。任何记号至少 9 位，因此解压时
+  *            剩余不足 9 位即结束，不需要长度字段。
+  ******************************************************************************
+  */
+
+#ifndef __LORA_MANAGER_COMPRESS_H
+#define __LORA_MANAGER_COMPRESS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief  压缩
+ * @param  out_max: 输出缓冲区大小
+ * @return 压缩后长度 (0=压缩后不短于原文或超出 out_max，应按原文发送)
+ */
+uint16_t LoRa_Manager_Compress_Encode(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t out_max);
+
+/**
+ * @brief  解压 (in 与 out 不可重叠)
+ * @param  out_max: 输出缓冲区大小
+ * @return 解压后长度 (0=数据非法或超出 out_max)
+ */
+uint16_t LoRa_Manager_Compress_Decode(const uint8_t *in, uint16_t len, uint8_t *out, uint16_t out_max);
+
+#endif // __LORA_MANAGER_COMPRESS_H
@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    lora_manager_frag.h
+  * @author  LoRaPlat Team
+  * @brief   LoRa 分片与重组 (Fragmentation & Reassembly)
+  *          - 发送：超过 LORA_MAX_PAYLOAD_LEN 的消息切成分片，每片作为独立的帧
+  *            进入 ARQ 窗口，丢失的分片由选择重传单独补发；全部分片结束后
+  *            只上报一次发送结果。
+  *          - 接收：按源重组，缓冲区数量有限 (LORA_FRAG_RX_SLOTS)，
+  *            超时未收齐则丢弃。
+  *          分片帧在控制字中置 LORA_CTRL_MASK_FRAG，负载开头为 2 字节分片头
+  *          (随负载一起加密)：
+  *            [0] 消息标签
+  *            [1] bit7=最后一片, bit0~6=分片序号
+  ******************************************************************************
+  */
+
+#ifndef __LORA_MANAGER_FRAG_H
+#define __LORA_MANAGER_FRAG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LoRaPlatConfig.h"
+
+#define LORA_FRAG_HDR_LEN       2
+#define LORA_FRAG_LAST_MASK     0x80
+
+/**
+ * @brief 分片消息发送结果 (FSM 事件归属判定)
+ */
+typedef enum {
+    LORA_FRAG_TX_NONE = 0,      // 不属于分片消息，按普通消息上报
+    LORA_FRAG_TX_PENDING,       // 属于分片消息，尚未结束，不上报
+    LORA_FRAG_TX_DONE_OK,       // 分片消息全部确认，上报成功
+    LORA_FRAG_TX_DONE_FAIL      // 分片消息失败，上报失败
+} LoRa_FragTxResult_t;
+
+// ============================================================
+//                    1. 发送
+// ============================================================
+
+/**
+ * @brief  初始化 (清空收发上下文)
+ */
+void LoRa_Manager_Frag_Init(void);
+
+/**
+ * @brief  开始发送一条分片消息 (拷贝数据)
+ * @return true=成功, false=已有分片消息在发送或长度超限
+ */
+bool LoRa_Manager_Frag_TxStart(const uint8_t *data, uint16_t len, uint16_t target_id,
+                               LoRa_SendOpt_t opt, LoRa_MsgID_t msg_id);
+
+/**
+ * @brief  取下一个待发分片 (明文，含分片头)，不出队
+ * @param  out: 输出缓冲区 (至少 LORA_FRAG_HDR_LEN + LORA_FRAG_CHUNK_LEN，NULL=只查询)
+ * @param  target_id/opt/msg_id: 输出该消息的发送参数
+ * @return 分片负载长度 (0=没有待发分片)
+ */
+uint16_t LoRa_Manager_Frag_TxPeek(uint8_t *out, uint16_t *target_id, LoRa_SendOpt_t *opt, LoRa_MsgID_t *msg_id);
+
+/**
+ * @brief  确认上一次 Peek 的分片已送入发送窗口
+ */
+void LoRa_Manager_Frag_TxAdvance(void);
+
+/**
+ * @brief  处理一个 FSM 发送结果
+ * @note   同一消息的所有分片共用消息 ID。任一分片失败即停止发送剩余分片，
+ *         待已送入窗口的分片全部结束后上报失败。
+ */
+LoRa_FragTxResult_t LoRa_Manager_Frag_OnTxResult(LoRa_MsgID_t msg_id, bool success);
+
+/**
+ * @brief  是否有分片消息未结束
+ */
+bool LoRa_Manager_Frag_TxIsBusy(void);
+
+// ============================================================
+//                    2. 接收
+// ============================================================
+
+/**
+ * @brief  为某个源预留重组缓冲区
+ * @note   在分片帧交给 FSM (即确认) 之前调用：返回 false 时不应确认该帧，
+ *         让发送方稍后重传，避免确认后因无缓冲区而丢弃。
+ * @return true=已有或已分配缓冲区
+ */
+bool LoRa_Manager_Frag_RxReserve(uint16_t src_id);
+
+/**
+ * @brief  释放尚未收到分片的预留 (分片帧被 FSM 判为重复或暂存时调用)
+ */
+void LoRa_Manager_Frag_RxUnreserve(uint16_t src_id);
+
+/**
+ * @brief  输入一个已解密的分片
+ * @param  out/out_len: 消息收齐时输出完整消息 (指向内部缓冲区，下次调用前有效)
+ * @return true=消息收齐
+ */
+bool LoRa_Manager_Frag_RxInput(uint16_t src_id, const uint8_t *payload, uint16_t len,
+                               uint8_t **out, uint16_t *out_len);
+
+#endif // __LORA_MANAGER_FRAG_H
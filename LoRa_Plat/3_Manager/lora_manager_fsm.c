@@ -2,7 +2,11 @@
   ******************************************************************************
   * @file    lora_manager_fsm.c
   * @author  LoRaPlat Team
-  * @brief   LoRa 协议状态机实现 (V3.4.1 Fixes)
+  * @brief   LoRa 协议状态机实现 (V3.5.0 Selective Repeat)
+  *          - 发送：按目标建立会话 (独立序号/窗口/退避)，共享 LORA_ARQ_TX_SLOTS 个窗口槽，
+  *            每个在途帧独立重传计时，超时按目标的 RTT 估计自适应
+  *          - 接收：按源维护接收窗口，乱序帧缓存后按序交付
+  *          - ACK 延时独立计时，不再占用发送状态
   ******************************************************************************
   */
 
@@ -16,6 +20,16 @@
 
 //#define LORA_DEDUP_TTL_MS  5000  // 去重记录有效期 (5秒)，已移动至LoRaPlatConfig.h进行管理
 
+#if (LORA_ARQ_WINDOW_SIZE < 1) || (LORA_ARQ_WINDOW_SIZE > 16)
+#error "LORA_ARQ_WINDOW_SIZE must be 1..16"
+#endif
+#if (LORA_ARQ_TX_SLOTS < LORA_ARQ_WINDOW_SIZE)
+#error "LORA_ARQ_TX_SLOTS must be >= LORA_ARQ_WINDOW_SIZE"
+#endif
+
+// 乱序缓存池大小：窗口内除按序帧外最多还有 (窗口-1) 帧可能提前到达
+#define ARQ_REORDER_POOL_SIZE   ((LORA_ARQ_WINDOW_SIZE > 1) ? (LORA_ARQ_WINDOW_SIZE - 1) : 1)
+
 // ============================================================
 //                    1. 内部数据结构
 // ============================================================
@@ -23,87 +37,551 @@
 static const LoRa_Config_t *s_FSM_Config = NULL;
 
 
-// 去重表条目
+// 去重表条目 (用于非确认帧/广播帧)
 typedef struct {
     uint16_t src_id;
     uint16_t  seq;
-    uint32_t last_seen; 
+    uint32_t last_seen;
     bool     valid;
 } DeDupEntry_t;
 
+// 发送窗口槽
+typedef struct {
+    LoRa_FSM_SlotState_t state;
+    uint8_t              retry_count;
+    uint32_t             deadline;
+    uint32_t             sent_tick;     // 最近一次发出的时刻 (RTT 采样)
+    uint32_t             air_end;       // [新增] 最近一次发射结束时刻 (估算，AUX 下降沿校正)
+    LoRa_MsgID_t         msg_id;
+    uint16_t             target_id;
+    uint16_t             seq;
+    bool                 need_ack;
+    uint16_t             frame_len;
+    uint8_t              frame[LORA_PROTOCOL_MAX_FRAME_LEN]; // [变更] 重传用的线上字节 (发送时封包一次，重传直接交给 Port)
+} TxSlot_t;
+
+// 发送会话：每个目标独立的确认帧序号与 RTT 估计 (在途帧与退避状态由窗口槽实时统计)
+typedef struct {
+    uint16_t peer_id;
+    uint16_t next_seq;
+    uint32_t last_used;
+    uint32_t srtt;          // 平滑往返时间 (ms)
+    uint32_t rttvar;        // 往返时间偏差 (ms)
+    bool     has_rtt;       // 是否已有 RTT 样本
+    uint32_t ack_delay;     // [新增] 对端回复 ACK 的实测延时 (ms)
+    bool     valid;
+} TxSession_t;
+
+// 接收方对端条目：接收窗口
+typedef struct {
+    uint16_t src_id;
+    uint16_t base;          // 下一个期望交付的序号
+    uint16_t seen;          // base 之前 16 个序号的接收位图 (bit i = base-1-i 已交付)
+    uint32_t last_seen;
+    uint32_t hole_deadline; // 缺口等待截止时刻 (仅 held > 0 时有效)
+    uint8_t  held;          // 缓存池中属于该源的帧数
+    uint16_t ack_delay;     // [新增] 对该源的 ACK 延时 (ms，按结果自适应)
+    bool     valid;
+} RxPeer_t;
+
+// [新增] 待回复 ACK 条目：同一源的多个待确认序号合并延时发送 (count == 0 且无 NACK 为空闲)
+typedef struct {
+    uint8_t  count;
+    uint16_t target_id;
+    uint16_t seqs[LORA_ARQ_WINDOW_SIZE];
+    uint32_t deadline;
+    bool     nack;          // [新增] 待回复 NACK (随 ACK 一起延时发出)
+    uint16_t nack_seq;
+} AckCtx_t;
+
+// 乱序缓存条目
 typedef struct {
-    LoRa_FSM_State_t state;
-    uint32_t         timeout_deadline; 
-    uint8_t          retry_count;
-    uint8_t          tx_seq; 
-    
-    // 当前正在处理的消息 ID
-    LoRa_MsgID_t     current_tx_id;
-    
-    // --- 重传/广播上下文 ---
-    uint8_t  pending_buf[LORA_MAX_PAYLOAD_LEN + 32];
-    uint16_t pending_len;
-    
-    // --- ACK 发送上下文 ---
-    struct {
-        bool     pending;
-        uint16_t target_id;
-        uint16_t  seq;
-    } ack_ctx;
-    
+    uint8_t       state;    // 0=空闲, 1=等待缺口, 2=就绪待交付
+    uint16_t      stamp;    // 就绪顺序 (保证交付顺序)
+    LoRa_Packet_t pkt;
+} RxHold_t;
+
+#define RX_HOLD_FREE    0
+#define RX_HOLD_WAIT    1
+#define RX_HOLD_READY   2
+
+typedef struct {
+    uint16_t         tx_seq;    // 非确认帧/广播帧序号
+    uint32_t         air_free_tick; // 模组发射队列预计清空时刻
+    uint32_t         uart_done_tick; // [新增] 最近一帧串口发完的时刻 (此后的 AUX 下降沿才是发射结束)
+    uint32_t         ack_due_tick;  // [新增] 对端预计开始回复 ACK 的时刻 (仅 ack_due 为真时有效)
+    uint32_t         ack_due_end;   // [新增] 对端 ACK 空中时段的结束时刻
+    const TxSlot_t  *ack_due_slot;  // [新增] 等待其 ACK 的帧 (确认前收到的其他 ACK 不结束避让)
+    bool             ack_due;
+    uint32_t         tx_hold_until; // 数据帧因避让 ACK 暂缓发送的截止时刻 (仅 tx_held 为真时有效)
+    bool             tx_held;
+
+    // --- 发送窗口 ---
+    TxSlot_t slots[LORA_ARQ_TX_SLOTS];
+    TxSession_t sessions[LORA_ARQ_PEER_MAX];
+
+    // --- [变更] 待回复 ACK 表 (每个源一个条目，各自延时，与发送调度并行) ---
+    AckCtx_t acks[LORA_ARQ_PEER_MAX];
+
+    // --- 接收窗口与乱序缓存 ---
+    RxPeer_t rx_peers[LORA_ARQ_PEER_MAX];
+    RxHold_t rx_hold[ARQ_REORDER_POOL_SIZE];
+    uint16_t rx_stamp;
+
     // --- 接收去重表 ---
     DeDupEntry_t dedup_table[LORA_DEDUP_MAX_COUNT];
-    
+
 } FSM_Context_t;
 
 static FSM_Context_t s_FSM;
 
-// 内部事件队列 (用于跨函数传递事件)
-static LoRa_FSM_Output_t s_PendingOutput = { .Event = FSM_EVT_NONE, .MsgID = 0 };
-
 // ============================================================
 //                    2. 内部辅助函数 (Actions)
 // ============================================================
 
-// 辅助：设置待处理事件
-static void _SetPendingEvent(LoRa_FSM_EventType_t evt, LoRa_MsgID_t id) {
-    s_PendingOutput.Event = evt;
-    s_PendingOutput.MsgID = id;
+static bool _IsExpired(uint32_t deadline, uint32_t now) {
+    // 使用 int32_t 强转处理 tick 溢出回绕问题
+    return (int32_t)(deadline - now) <= 0;
+}
+
+static bool _IsReliable(const LoRa_Packet_t *pkt) {
+    return pkt->NeedAck && pkt->TargetID != LORA_ID_BROADCAST;
+}
+
+static bool _FSM_SlotReliable(const TxSlot_t *slot) {
+    return slot->need_ack && slot->target_id != LORA_ID_BROADCAST;
+}
+
+// --- 发送会话表 ---
+
+/**
+ * @brief 统计某目标的会话负载
+ * @param inflight: 输出占用的窗口槽数 (确认帧)
+ * @return true=该目标处于重传退避中 (有帧已超时未获确认)
+ */
+static bool _FSM_SessionLoad(uint16_t peer_id, uint8_t *inflight) {
+    bool backoff = false;
+    uint8_t n = 0;
+
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        const TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_FREE || !_FSM_SlotReliable(slot)) continue;
+        if (slot->target_id != peer_id) continue;
+        if (slot->state == LORA_FSM_SLOT_DONE_OK || slot->state == LORA_FSM_SLOT_DONE_FAIL) continue;
+        n++;
+        if (slot->retry_count > 0) backoff = true;
+    }
+    if (inflight) *inflight = n;
+    return backoff;
+}
+
+static TxSession_t* _FSM_SessionFind(uint16_t peer_id) {
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        TxSession_t *p = &s_FSM.sessions[i];
+        if (p->valid && p->peer_id == peer_id) return p;
+    }
+    return NULL;
+}
+
+static TxSession_t* _FSM_SessionGet(uint16_t peer_id) {
+    uint32_t now = OSAL_GetTick();
+    TxSession_t *p = _FSM_SessionFind(peer_id);
+
+    if (p) {
+        p->last_used = now;
+        return p;
+    }
+
+    // 淘汰最久未用的会话 (优先选择没有在途帧的)
+    TxSession_t *victim = NULL;
+    uint32_t max_age = 0;
+    bool victim_idle = false;
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        TxSession_t *c = &s_FSM.sessions[i];
+        uint8_t inflight = 0;
+        if (c->valid) _FSM_SessionLoad(c->peer_id, &inflight);
+        bool idle = (inflight == 0);
+        uint32_t age = c->valid ? (now - c->last_used) : 0xFFFFFFFF;
+
+        if (!victim || (idle && !victim_idle) || (idle == victim_idle && age >= max_age)) {
+            victim = c;
+            victim_idle = idle;
+            max_age = age;
+        }
+    }
+
+    // 新会话：随机初始序号，避免本机重启后与对端残留的接收窗口重叠
+    victim->valid = true;
+    victim->peer_id = peer_id;
+    victim->next_seq = (uint16_t)LoRa_Port_GetEntropy32();
+    victim->last_used = now;
+    victim->has_rtt = false;
+    victim->ack_delay = LORA_ACK_DELAY_MS;
+    return victim;
+}
+
+// --- 自适应重传超时 (RFC 6298) ---
+
+#define ARQ_RTO_MARGIN_MS       50      // 对端处理与调度余量
+#define ARQ_ACK_BITMAP_LEN      ((LORA_ARQ_WINDOW_SIZE + 7) / 8)        // 块确认位图字节数 (覆盖整个窗口)
+#define ARQ_ACK_FRAME_LEN       (12 + (LORA_ENABLE_CRC ? 2 : 0) + 1 + ARQ_ACK_BITMAP_LEN)   // V1 块确认 (含能力字节)，V2 更短
+
+// 串口传输时间 (8N1，每字节 10 bit)
+static uint32_t _FSM_UartMs(uint16_t len) {
+    return ((uint32_t)len * 10000u + LORA_TARGET_BAUDRATE - 1) / LORA_TARGET_BAUDRATE;
 }
 
-static void _FSM_SetState(LoRa_FSM_State_t new_state, uint32_t timeout_ms) {
-    s_FSM.state = new_state;
-    if (timeout_ms == LORA_TIMEOUT_INFINITE) {
-        s_FSM.timeout_deadline = LORA_TIMEOUT_INFINITE;
+// 空中时间 (定点模式的 3 字节前缀由模组消耗，不上空口)
+static uint32_t _FSM_AirMs(uint16_t frame_len) {
+    if (s_FSM_Config->tmode == 1 && frame_len > 3) frame_len -= 3;
+    return (LoRa_Manager_Protocol_AirTimeUs(s_FSM_Config->air_rate, frame_len) + 999) / 1000;
+}
+
+// 帧交给模组后更新发射队列清空时刻 (模组收完整帧后开始发射，多帧依次排队)
+static void _FSM_OnFrameTransmitted(uint16_t frame_len) {
+    uint32_t start = OSAL_GetTick() + _FSM_UartMs(frame_len);
+    s_FSM.uart_done_tick = start;
+    if (!_IsExpired(s_FSM.air_free_tick, start)) start = s_FSM.air_free_tick;
+    s_FSM.air_free_tick = start + _FSM_AirMs(frame_len);
+}
+
+/**
+ * @brief [新增] 用 AUX 下降沿校正发射结束时刻
+ * @note  空中时间按标称速率估算，通常偏保守。串口已发完、模组已空闲时，
+ *        所有已发出的帧都已发射完毕：以实际的下降沿时刻为准，对端的 ACK 时段随之提前。
+ */
+static void _FSM_SyncAirFree(uint32_t now) {
+    if (_IsExpired(s_FSM.air_free_tick, now)) return;
+    if (LoRa_Port_IsTxBusy() || LoRa_Port_GetAUX()) return;
+
+    uint32_t idle = LoRa_Port_GetAuxIdleTick();
+    if ((int32_t)(idle - s_FSM.uart_done_tick) <= 0) return; // 模组尚未开始发射最近一帧
+    if (!_IsExpired(idle, now)) idle = now;
+
+    uint32_t early = s_FSM.air_free_tick - idle;
+    s_FSM.air_free_tick = idle;
+    if (s_FSM.ack_due) {
+        s_FSM.ack_due_tick -= early;
+        s_FSM.ack_due_end -= early;
+    }
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_WAIT_ACK && (int32_t)(slot->air_end - idle) > 0) slot->air_end = idle;
+    }
+}
+
+/**
+ * @brief 数据帧是否会与对端即将回复的 ACK 在空中相撞 (半双工)
+ * @note  [新增] 块确认每批只有一帧，被撞掉就要整批重传。对端在最后一帧到达
+ *        LORA_ACK_DELAY_MS 后回复：能在此之前发完的帧照常跟发 (对端会顺延)，
+ *        否则等 ACK 收到或其空中时段过去再发。
+ * @param wake: 输出需要等待到的时刻 (返回 true 时有效)
+ */
+static bool _FSM_AckWindowBlocked(uint16_t frame_len, uint32_t now, uint32_t *wake) {
+    if (!s_FSM.ack_due) return false;
+
+    uint32_t ack_end = s_FSM.ack_due_end;
+    if (_IsExpired(ack_end, now)) {
+        s_FSM.ack_due = false;
+        return false;
+    }
+
+    uint32_t start = now + _FSM_UartMs(frame_len);
+    if (!_IsExpired(s_FSM.air_free_tick, start)) start = s_FSM.air_free_tick;
+    if (!_IsExpired(s_FSM.ack_due_tick, start + _FSM_AirMs(frame_len))) return false;
+
+    if (wake) *wake = ack_end;
+    return true;
+}
+
+/**
+ * @brief 计算确认帧的重传超时
+ * @note  RTO = SRTT + 4 x RTTVAR (无样本时为 LORA_ACK_TIMEOUT_MS)，夹在 [MIN, MAX] 之间；
+ *        每次重传翻倍并加随机抖动 (错开冲突双方)，最后不低于物理下限：
+ *        本机发射队列清空 + 对端串口接收 + ACK 延时 + ACK 空中往返。
+ */
+static uint32_t _FSM_Rto(const TxSession_t *sess, uint8_t retry_count, uint16_t frame_len) {
+    uint32_t rto = LORA_ACK_TIMEOUT_MS;
+
+    if (sess && sess->has_rtt) {
+        rto = sess->srtt + 4 * sess->rttvar;
+        if (rto < LORA_RTO_MIN_MS) rto = LORA_RTO_MIN_MS;
+    }
+    for (uint8_t i = 0; i < retry_count && rto < LORA_RTO_MAX_MS; i++) rto <<= 1;
+    if (retry_count > 0) rto += LoRa_Port_GetEntropy32() % (rto / 4 + 1);
+    if (rto > LORA_RTO_MAX_MS) rto = LORA_RTO_MAX_MS;
+
+    uint32_t now = OSAL_GetTick();
+    uint32_t floor = (_IsExpired(s_FSM.air_free_tick, now) ? 0 : (s_FSM.air_free_tick - now))
+                   + _FSM_UartMs(frame_len)
+                   + (sess ? sess->ack_delay : LORA_ACK_DELAY_MS)
+                   + _FSM_AirMs(ARQ_ACK_FRAME_LEN) + 2 * _FSM_UartMs(ARQ_ACK_FRAME_LEN)
+                   + ARQ_RTO_MARGIN_MS;
+    return (rto > floor) ? rto : floor;
+}
+
+// 更新 RTT 估计 (Karn 规则：调用方只传入未重传帧的样本)
+static void _FSM_RttSample(TxSession_t *sess, uint32_t rtt) {
+    if (!sess->has_rtt) {
+        sess->srtt = rtt;
+        sess->rttvar = rtt / 2;
+        sess->has_rtt = true;
     } else {
-        s_FSM.timeout_deadline = OSAL_GetTick() + timeout_ms;
+        uint32_t err = (sess->srtt > rtt) ? (sess->srtt - rtt) : (rtt - sess->srtt);
+        sess->rttvar = (3 * sess->rttvar + err) / 4;
+        sess->srtt = (7 * sess->srtt + rtt) / 8;
+    }
+}
+
+// [新增] 序号比较：V2 短序号帧只比较低 8 位
+static bool _FSM_SeqMatch(uint16_t full_seq, uint16_t wire_seq, bool is_short) {
+    return is_short ? ((uint8_t)full_seq == (uint8_t)wire_seq) : (full_seq == wire_seq);
+}
+
+static TxSlot_t* _FSM_FindFreeSlot(void) {
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        if (s_FSM.slots[i].state == LORA_FSM_SLOT_FREE) return &s_FSM.slots[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 选择重传窗口约束：新序号与该目标最早未确认序号之差必须小于窗口
+ *        (保证接收方窗口 [base, base+W) 能容纳所有在途帧)
+ */
+static bool _FSM_SeqInWindow(uint16_t target_id, uint16_t next_seq) {
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        const TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_FREE || !_FSM_SlotReliable(slot)) continue;
+        if (slot->target_id != target_id) continue;
+        if ((uint16_t)(next_seq - slot->seq) >= LORA_ARQ_WINDOW_SIZE) return false;
+    }
+    return true;
+}
+
+// --- ACK 合并延时 ---
+
+/**
+ * @brief [新增] 本次接收的结束时刻 (ACK 延时从此起算)
+ * @note  取模组串口输出完毕的 AUX 下降沿；模组仍忙或下降沿已过时 (平台不支持/早于本帧) 时取当前时刻。
+ */
+static uint32_t _FSM_RxEndTick(uint32_t now) {
+    uint32_t idle = LoRa_Port_GetAuxIdleTick();
+    if (LoRa_Port_GetAUX() || (uint32_t)(now - idle) > LORA_ACK_DELAY_MIN_MS) return now;
+    return idle;
+}
+
+// [新增] 对某个源的 ACK 延时 (未建立接收窗口时取上限)
+static uint32_t _FSM_AckDelay(uint16_t src_id) {
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (s_FSM.rx_peers[i].valid && s_FSM.rx_peers[i].src_id == src_id) return s_FSM.rx_peers[i].ack_delay;
+    }
+    return LORA_ACK_DELAY_MS;
+}
+
+// 接收方是否已收到该源的某个序号 (已交付位图或乱序缓存中)
+static bool _FSM_RxHas(const RxPeer_t *peer, uint16_t seq) {
+    uint16_t behind = (uint16_t)(peer->base - seq);
+    if (behind >= 1 && behind <= 16) return (peer->seen >> (behind - 1)) & 1;
+    if ((uint16_t)(seq - peer->base) >= LORA_ARQ_WINDOW_SIZE) return false;
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        const RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state == RX_HOLD_WAIT && h->pkt.SourceID == peer->src_id && h->pkt.Sequence == seq) return true;
+    }
+    return false;
+}
+
+static bool _FSM_AckPending(const AckCtx_t *ctx) {
+    return ctx->count > 0 || ctx->nack;
+}
+
+// 查找某个源的待回复 ACK 条目
+static AckCtx_t* _FSM_AckFind(uint16_t target_id) {
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (_FSM_AckPending(&s_FSM.acks[i]) && s_FSM.acks[i].target_id == target_id) return &s_FSM.acks[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief 按接收窗口生成发往 ctx 目标的块确认
+ * @note  基序号取待确认序号中最新的一个，位图 bit i 表示 "基序号-1-i" 是否已收到
+ *        (取自接收窗口，而非本批序号)，一帧报告整窗接收状态。
+ * @return false=该源没有接收窗口 (只能逐个回普通 ACK)
+ */
+static bool _FSM_BuildBlockAck(const AckCtx_t *ctx, uint16_t *head, uint8_t *bitmap) {
+    const uint16_t *seqs = ctx->seqs;
+    const RxPeer_t *peer = NULL;
+
+    if (ctx->count == 0) return false;
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (s_FSM.rx_peers[i].valid && s_FSM.rx_peers[i].src_id == ctx->target_id) {
+            peer = &s_FSM.rx_peers[i];
+            break;
+        }
     }
+    if (!peer) return false;
+
+    *head = seqs[0];
+    for (uint8_t i = 1; i < ctx->count; i++) {
+        if ((int16_t)(seqs[i] - *head) > 0) *head = seqs[i];
+    }
+    memset(bitmap, 0, ARQ_ACK_BITMAP_LEN);
+    for (uint16_t d = 1; d <= ARQ_ACK_BITMAP_LEN * 8; d++) {
+        if (_FSM_RxHas(peer, (uint16_t)(*head - d))) bitmap[(d - 1) / 8] |= (uint8_t)(1u << ((d - 1) % 8));
+    }
+    return true;
 }
 
-static void _FSM_Reset(void) {
-    _FSM_SetState(LORA_FSM_IDLE, LORA_TIMEOUT_INFINITE);
-    s_FSM.ack_ctx.pending = false;
-    s_FSM.retry_count = 0;
-    s_FSM.pending_len = 0; 
-    s_FSM.current_tx_id = 0; 
+// 块确认已发出：移除其覆盖的待确认序号
+static void _FSM_AckCtxRemove(AckCtx_t *ctx, uint16_t head, const uint8_t *bitmap) {
+    uint16_t *seqs = ctx->seqs;
+    uint8_t left = 0;
+
+    for (uint8_t i = 0; i < ctx->count; i++) {
+        uint16_t d = (uint16_t)(head - seqs[i]);
+        if (d == 0 || (d <= ARQ_ACK_BITMAP_LEN * 8 && (bitmap[(d - 1) / 8] & (1u << ((d - 1) % 8))))) continue;
+        seqs[left++] = seqs[i];
+    }
+    ctx->count = left;
 }
 
-static void _FSM_SendAck(void) {
+/**
+ * @brief 将待确认序号全部推入 ACK 队列 (ACK 队列满时保留剩余序号，下次 Run 再试)
+ * @note  [变更] 先发一帧块确认；位图未覆盖的序号 (如很早以前的重复帧) 逐个回普通 ACK；
+ *        [新增] 最后发出待回复的 NACK。
+ */
+static void _FSM_FlushAck(AckCtx_t *ctx) {
     LoRa_Packet_t pkt;
-    uint8_t ack_stack_buf[64]; 
-    
+    uint8_t ack_stack_buf[64];
+    uint8_t bitmap[ARQ_ACK_BITMAP_LEN];
+    uint16_t head;
+
     memset(&pkt, 0, sizeof(pkt));
     pkt.IsAckPacket = true;
-    pkt.NeedAck = false; 
+    pkt.NeedAck = false;
     pkt.HasCrc = LORA_ENABLE_CRC;
-    pkt.TargetID = s_FSM.ack_ctx.target_id;
+    pkt.TargetID = ctx->target_id;
     pkt.SourceID = s_FSM_Config->net_id;
-    pkt.Sequence = s_FSM.ack_ctx.seq; 
-    pkt.PayloadLen = 0;
-    
-    LoRa_Manager_Buffer_PushAck(&pkt, s_FSM_Config->tmode, s_FSM_Config->channel, ack_stack_buf, sizeof(ack_stack_buf));
-    
-    s_FSM.ack_ctx.pending = false;
+    pkt.Format = LoRa_Manager_Protocol_SelectFormat(pkt.TargetID);
+    pkt.UseFec = LoRa_Manager_Protocol_LinkFec(pkt.TargetID);
+
+    // V1 ACK 负载首字节为能力字节 (位图在其后)，V2 ACK 负载只有位图
+    uint8_t bm_off = (pkt.Format == LORA_FRAME_FMT_V1) ? 1 : 0;
+    uint8_t cap_len = 0;
+    // [新增] V1 ACK 携带能力字节，对端据此改用 V2 发送、启用扩展负载
+    if (pkt.Format == LORA_FRAME_FMT_V1) {
+#if LORA_FRAME_V2_ENABLE
+        pkt.Payload[0] = LORA_PROTOCOL_CAP_V2 | LORA_PROTOCOL_CAP_HCS | LORA_PROTOCOL_CAP_EXT;
+#else
+        pkt.Payload[0] = LORA_PROTOCOL_CAP_EXT;
+#endif
+        cap_len = 1;
+    }
+
+    if (_FSM_BuildBlockAck(ctx, &head, bitmap)) {
+        pkt.IsBlockAck = true;
+        pkt.Sequence = head;
+        memcpy(&pkt.Payload[bm_off], bitmap, ARQ_ACK_BITMAP_LEN);
+        pkt.PayloadLen = bm_off + ARQ_ACK_BITMAP_LEN;
+        if (!LoRa_Manager_Buffer_PushAck(&pkt, s_FSM_Config->tmode, s_FSM_Config->channel, ack_stack_buf, sizeof(ack_stack_buf))) {
+            return;
+        }
+        _FSM_AckCtxRemove(ctx, head, bitmap);
+    }
+
+    pkt.IsBlockAck = false;
+    pkt.PayloadLen = cap_len;
+    while (ctx->count > 0) {
+        pkt.Sequence = ctx->seqs[ctx->count - 1];
+        if (!LoRa_Manager_Buffer_PushAck(&pkt, s_FSM_Config->tmode, s_FSM_Config->channel, ack_stack_buf, sizeof(ack_stack_buf))) {
+            return;
+        }
+        ctx->count--;
+    }
+
+    if (ctx->nack) {
+        pkt.NeedAck = true; // ACK 帧置 NeedAck 即为 NACK
+        pkt.Sequence = ctx->nack_seq;
+        if (!LoRa_Manager_Buffer_PushAck(&pkt, s_FSM_Config->tmode, s_FSM_Config->channel, ack_stack_buf, sizeof(ack_stack_buf))) {
+            return;
+        }
+        LORA_LOG("[MGR] NACK Queued (Seq %d)\r\n", ctx->nack_seq);
+        ctx->nack = false;
+    }
+}
+
+// 为某个源分配 ACK 条目 (条目用尽时提前发出最早到期的一个；仍无法腾出时返回 NULL)
+static AckCtx_t* _FSM_AckAlloc(uint16_t target_id) {
+    AckCtx_t *ctx = _FSM_AckFind(target_id);
+    if (ctx) return ctx;
+
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        AckCtx_t *c = &s_FSM.acks[i];
+        if (!_FSM_AckPending(c)) { ctx = c; break; }
+        if (!ctx || (int32_t)(c->deadline - ctx->deadline) < 0) ctx = c;
+    }
+    if (_FSM_AckPending(ctx)) _FSM_FlushAck(ctx);
+    if (_FSM_AckPending(ctx)) return NULL; // ACK 队列已满
+    ctx->target_id = target_id;
+    return ctx;
+}
+
+/**
+ * @brief 登记一个待回复的 ACK
+ * @note  同一源的连续帧合并为一次延时发送 (每收到一帧重新计时，等对方整窗发完)；
+ *        [变更] 每个源独立计时，其他源的帧到达不再打断；条目用尽时提前发出最早到期的一个。
+ */
+static void _FSM_QueueAck(uint16_t target_id, uint16_t seq) {
+    AckCtx_t *ctx = _FSM_AckAlloc(target_id);
+    if (!ctx) return; // 不确认，等对方重传
+
+    // 损坏的帧已重传成功，不再要求重传
+    if (ctx->nack && ctx->nack_seq == seq) ctx->nack = false;
+
+    bool found = false;
+    for (uint8_t i = 0; i < ctx->count; i++) {
+        if (ctx->seqs[i] == seq) { found = true; break; }
+    }
+    if (!found) {
+        if (ctx->count >= LORA_ARQ_WINDOW_SIZE) _FSM_FlushAck(ctx);
+        if (ctx->count < LORA_ARQ_WINDOW_SIZE) {
+            ctx->target_id = target_id;
+            ctx->seqs[ctx->count++] = seq;
+        }
+    }
+    ctx->deadline = _FSM_RxEndTick(OSAL_GetTick()) + _FSM_AckDelay(target_id);
+}
+
+/**
+ * @brief [新增] 处理帧头可信但 CRC 失败的帧：请求对方立即重传
+ * @note  与 ACK 同样延时发出 (对方发完后才能收)。只针对已建立接收窗口的源 (短序号可扩展)；
+ *        该序号其实已收到过时 (重传帧损坏，上一个 ACK 可能丢了)，改为补发 ACK。
+ */
+static void _FSM_QueueNack(const LoRa_Packet_t *packet) {
+    const RxPeer_t *peer = NULL;
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (s_FSM.rx_peers[i].valid && s_FSM.rx_peers[i].src_id == packet->SourceID) {
+            peer = &s_FSM.rx_peers[i];
+            break;
+        }
+    }
+    if (!peer) return;
+
+    uint16_t seq = packet->Sequence;
+    if (packet->SeqShort) seq = peer->base + (int8_t)((uint8_t)seq - (uint8_t)peer->base);
+    if (_FSM_RxHas(peer, seq)) {
+        _FSM_QueueAck(packet->SourceID, seq);
+        return;
+    }
+    if ((uint16_t)(seq - peer->base) >= LORA_ARQ_WINDOW_SIZE) return;
+
+    AckCtx_t *ctx = _FSM_AckAlloc(packet->SourceID);
+    if (!ctx) return;
+    if (ctx->nack && ctx->nack_seq != seq) _FSM_FlushAck(ctx); // 只保留一个 NACK：先发出前一个
+    ctx->nack = true;
+    ctx->nack_seq = seq;
+    ctx->deadline = _FSM_RxEndTick(OSAL_GetTick()) + peer->ack_delay;
 }
 
 /**
@@ -117,13 +595,13 @@ static bool _FSM_CheckDuplicate(uint16_t src_id, uint16_t seq) {
     int lru_idx = 0;
     uint32_t min_time = 0xFFFFFFFF;
     bool found_empty_slot = false;
-    
+
     for (int i = 0; i < LORA_DEDUP_MAX_COUNT; i++) {
         // 1. 检查条目有效性与 TTL
         if (s_FSM.dedup_table[i].valid) {
             // 计算时间差 (处理溢出)
             uint32_t elapsed = now - s_FSM.dedup_table[i].last_seen;
-            
+
             if (elapsed > LORA_DEDUP_TTL_MS) {
                 // 条目超时，标记失效
                 s_FSM.dedup_table[i].valid = false;
@@ -132,7 +610,7 @@ static bool _FSM_CheckDuplicate(uint16_t src_id, uint16_t seq) {
                     lru_idx = i;
                     found_empty_slot = true;
                 }
-                continue; 
+                continue;
             }
 
             // 2. 匹配 SrcID
@@ -141,7 +619,7 @@ static bool _FSM_CheckDuplicate(uint16_t src_id, uint16_t seq) {
                 if (s_FSM.dedup_table[i].seq == seq) {
                     // 完全匹配 -> 重复包
                     s_FSM.dedup_table[i].last_seen = now; // 刷新时间
-                    return true; 
+                    return true;
                 } else {
                     // 同源新 Seq -> 更新记录
                     s_FSM.dedup_table[i].seq = seq;
@@ -149,7 +627,7 @@ static bool _FSM_CheckDuplicate(uint16_t src_id, uint16_t seq) {
                     return false; // 新包
                 }
             }
-            
+
             // 3. 寻找 LRU (最久未使用的有效条目)
             if (!found_empty_slot && s_FSM.dedup_table[i].last_seen < min_time) {
                 min_time = s_FSM.dedup_table[i].last_seen;
@@ -163,358 +641,846 @@ static bool _FSM_CheckDuplicate(uint16_t src_id, uint16_t seq) {
             }
         }
     }
-    
+
     // 4. 插入新记录 (覆盖 LRU 或 填充空槽)
     s_FSM.dedup_table[lru_idx].valid = true;
     s_FSM.dedup_table[lru_idx].src_id = src_id;
     s_FSM.dedup_table[lru_idx].seq = seq;
     s_FSM.dedup_table[lru_idx].last_seen = now;
-    
+
     return false; // 新包
 }
 
+// ============================================================
+//                    3. 接收窗口 (Selective Repeat RX)
+// ============================================================
+
+/**
+ * @brief 查找/分配接收对端条目
+ * @note  新条目以当前帧序号为起点。对端重启等序号跳变由 _FSM_RxReliable 处理。
+ */
+static RxPeer_t* _FSM_RxPeerGet(uint16_t src_id, uint16_t seq) {
+    uint32_t now = OSAL_GetTick();
+    RxPeer_t *victim = NULL;
+    uint32_t max_age = 0;
+
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        RxPeer_t *p = &s_FSM.rx_peers[i];
+        if (p->valid && p->src_id == src_id) {
+            // [变更] 不再按 TTL 重新同步：链路中断较久时，发送方仍可能重传窗口内的旧帧，
+            //        重新同步会把它们误判为重复帧 (已确认却未交付)
+            p->last_seen = now;
+            return p;
+        }
+        // 有缓存帧的条目不参与淘汰
+        if (p->valid && p->held > 0) continue;
+        uint32_t age = p->valid ? (now - p->last_seen) : 0xFFFFFFFF;
+        if (!victim || age >= max_age) {
+            max_age = age;
+            victim = p;
+        }
+    }
+
+    if (!victim) return NULL;
+    victim->valid = true;
+    victim->src_id = src_id;
+    victim->base = seq;
+    victim->seen = 0;
+    victim->held = 0;
+    victim->ack_delay = LORA_ACK_DELAY_MS;
+    victim->last_seen = now;
+    return victim;
+}
+
+/**
+ * @brief [新增] 调整对该源的 ACK 延时 (AIMD)
+ * @param missed: true=对端重发了已确认的帧 (ACK 没收到，可能回得过早，与对端发射相撞)，延时加倍；
+ *                false=对端按序推进，延时向下限缓慢收敛
+ */
+static void _FSM_RxTuneAckDelay(RxPeer_t *peer, bool missed) {
+    if (missed) {
+        uint32_t d = (uint32_t)peer->ack_delay * 2;
+        peer->ack_delay = (uint16_t)((d < LORA_ACK_DELAY_MS) ? d : LORA_ACK_DELAY_MS);
+    } else if (peer->ack_delay > LORA_ACK_DELAY_MIN_MS) {
+        peer->ack_delay -= (uint16_t)((peer->ack_delay - LORA_ACK_DELAY_MIN_MS + 7) / 8);
+    }
+}
+
+// base 前移 n 个序号 (delivered: 新 base 的前一个序号已交付)，同步移动接收位图
+static void _FSM_RxAdvance(RxPeer_t *peer, uint16_t n, bool delivered) {
+    peer->seen = (n >= 16) ? 0 : (uint16_t)(peer->seen << n);
+    if (delivered) peer->seen |= 1;
+    peer->base += n;
+}
+
+// 把该源从 base 开始连续的缓存帧转为就绪，并推进 base
+static void _FSM_RxRelease(RxPeer_t *peer) {
+    bool progressed = true;
 
+    while (progressed && peer->held > 0) {
+        progressed = false;
+        for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+            RxHold_t *h = &s_FSM.rx_hold[i];
+            if (h->state == RX_HOLD_WAIT && h->pkt.SourceID == peer->src_id && h->pkt.Sequence == peer->base) {
+                h->state = RX_HOLD_READY;
+                h->stamp = s_FSM.rx_stamp++;
+                peer->held--;
+                _FSM_RxAdvance(peer, 1, true);
+                progressed = true;
+                break;
+            }
+        }
+    }
+
+    if (peer->held > 0) {
+        peer->hole_deadline = OSAL_GetTick() + LORA_ARQ_REORDER_TIMEOUT_MS;
+    }
+}
+
+// 跳过缺口：base 直接推进到最早的缓存帧 (缺口帧已被发送方放弃)
+static void _FSM_RxSkipHole(RxPeer_t *peer) {
+    uint16_t min_dist = 0xFFFF;
+
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        const RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state == RX_HOLD_WAIT && h->pkt.SourceID == peer->src_id) {
+            uint16_t dist = (uint16_t)(h->pkt.Sequence - peer->base);
+            if (dist < min_dist) min_dist = dist;
+        }
+    }
+    if (min_dist != 0xFFFF) {
+        LORA_LOG("[MGR] Reorder Skip %d (Src %d)\r\n", min_dist, peer->src_id);
+        _FSM_RxAdvance(peer, min_dist, false);
+        _FSM_RxRelease(peer);
+    }
+}
+
+/**
+ * @brief 缓存一个提前到达的帧
+ * @return true=已缓存 (或此前已缓存)，可以回 ACK; false=缓存池满，不回 ACK 让对方重传
+ */
+static bool _FSM_RxHold(RxPeer_t *peer, const LoRa_Packet_t *packet) {
+    RxHold_t *free_slot = NULL;
+
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state == RX_HOLD_FREE) {
+            if (!free_slot) free_slot = h;
+        } else if (h->state == RX_HOLD_WAIT && h->pkt.SourceID == packet->SourceID &&
+                   h->pkt.Sequence == packet->Sequence) {
+            return true; // 重复到达
+        }
+    }
+    if (!free_slot) return false;
+
+    memcpy(&free_slot->pkt, packet, sizeof(LoRa_Packet_t));
+    free_slot->state = RX_HOLD_WAIT;
+    if (peer->held++ == 0) {
+        peer->hole_deadline = OSAL_GetTick() + LORA_ARQ_REORDER_TIMEOUT_MS;
+    }
+    return true;
+}
+
+/**
+ * @brief 把帧直接放入缓存池作为就绪帧 (排在已就绪帧之后交付)
+ * @return true=已放入, false=缓存池满
+ */
+static bool _FSM_RxQueueReady(const LoRa_Packet_t *packet) {
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state != RX_HOLD_FREE) continue;
+        memcpy(&h->pkt, packet, sizeof(LoRa_Packet_t));
+        h->state = RX_HOLD_READY;
+        h->stamp = s_FSM.rx_stamp++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 处理需要确认的数据帧
+ * @return true=按序到达，立即交付
+ */
+static bool _FSM_RxReliable(LoRa_Packet_t *packet) {
+    RxPeer_t *peer = _FSM_RxPeerGet(packet->SourceID, packet->Sequence);
+
+    // [修复] 未声明扩展能力的对端 (旧版本) 确认帧、非确认帧与广播共用一个序号，确认帧的序号
+    //        天然不连续：不做乱序重排 (否则每个缺口都要扣留到超时)，按旧方式确认、去重后立即交付。
+    //        接收窗口仍随之推进 (ACK 延时调整、去重表过期后仍能识别窗口内的重传；
+    //        对端升级后按完整序号扩展 V2 短序号)
+    if (!LoRa_Manager_Protocol_LinkExt(packet->SourceID)) {
+        bool dup = _FSM_CheckDuplicate(packet->SourceID, packet->Sequence);
+        if (peer && peer->held == 0) {
+            uint16_t ahead  = (uint16_t)(packet->Sequence - peer->base);
+            uint16_t behind = (uint16_t)(peer->base - packet->Sequence);
+            if (ahead < 0x8000) {
+                if (!dup) _FSM_RxAdvance(peer, ahead + 1, true);
+            } else if (behind <= LORA_ARQ_WINDOW_SIZE) {
+                uint16_t bit = (uint16_t)(1u << (behind - 1));
+                if (peer->seen & bit) dup = true;
+                peer->seen |= bit;
+            }
+            _FSM_RxTuneAckDelay(peer, dup);
+        }
+        _FSM_QueueAck(packet->SourceID, packet->Sequence);
+        if (dup) LORA_LOG("[MGR] Drop Duplicate\r\n");
+        return !dup;
+    }
+
+    if (peer && packet->SeqShort) {
+        // [新增] V2 短序号：扩展为距 base 最近的 16 位序号 (只需与发送方低 8 位一致)
+        packet->Sequence = peer->base + (int8_t)((uint8_t)packet->Sequence - (uint8_t)peer->base);
+        packet->SeqShort = false;
+    }
+    if (!peer) {
+        // 所有条目都有缓存帧：无法建立窗口，按停等方式直接交付
+        _FSM_QueueAck(packet->SourceID, packet->Sequence);
+        return !_FSM_CheckDuplicate(packet->SourceID, packet->Sequence);
+    }
+
+    uint16_t ahead  = (uint16_t)(packet->Sequence - peer->base);
+    uint16_t behind = (uint16_t)(peer->base - packet->Sequence);
+
+    if (ahead == 0) {
+        // 按序到达
+        _FSM_RxTuneAckDelay(peer, false);
+        _FSM_QueueAck(packet->SourceID, packet->Sequence);
+        _FSM_RxAdvance(peer, 1, true);
+        _FSM_RxRelease(peer);
+        return true;
+    }
+    if (ahead < LORA_ARQ_WINDOW_SIZE) {
+        // 提前到达：缓存，等待缺口
+        if (_FSM_RxHold(peer, packet)) {
+            _FSM_QueueAck(packet->SourceID, packet->Sequence);
+        }
+        return false;
+    }
+    if (behind <= LORA_ARQ_WINDOW_SIZE) {
+        uint16_t bit = (uint16_t)(1u << (behind - 1));
+        if (peer->seen & bit) _FSM_RxTuneAckDelay(peer, true);
+        _FSM_QueueAck(packet->SourceID, packet->Sequence);
+        if (peer->seen & bit) {
+            // 已交付过 (上一个 ACK 可能丢了)：补发 ACK，丢弃
+            LORA_LOG("[MGR] Drop Duplicate\r\n");
+            return false;
+        }
+        // [修复] 窗口曾被跳过的缺口帧迟到 (发送方仍在重传)：补交付，不能当作重复帧吞掉
+        LORA_LOG("[MGR] Late Frame (Src %d, Seq %d)\r\n", packet->SourceID, packet->Sequence);
+        peer->seen |= bit;
+        return true;
+    }
+
+    // 序号跳变：交付残留缓存，以当前帧重新同步
+    //  - 向前 (对端已越过缺口继续发送，或会话被淘汰)：保留位图，其间的缺口帧迟到仍可补交付
+    //  - 向后 (对端重启)：清空位图
+    LORA_LOG("[MGR] RX Resync (Src %d, Seq %d)\r\n", packet->SourceID, packet->Sequence);
+    bool had_held = (peer->held > 0);
+    while (peer->held > 0) _FSM_RxSkipHole(peer);
+    // [修复] 残留缓存帧已转为就绪，当前帧必须排在它们之后交付；缓存池已满时不确认，
+    //        等对方重传 (届时已无残留缓存)
+    if (had_held && !_FSM_RxQueueReady(packet)) {
+        LORA_LOG("[MGR] Resync Deferred (Src %d, Seq %d)\r\n", packet->SourceID, packet->Sequence);
+        return false;
+    }
+    ahead = (uint16_t)(packet->Sequence - peer->base);
+    if (ahead < 0x8000) {
+        _FSM_RxAdvance(peer, ahead + 1, true);
+    } else {
+        peer->base = packet->Sequence + 1;
+        peer->seen = 1;
+    }
+    _FSM_QueueAck(packet->SourceID, packet->Sequence);
+    return !had_held;
+}
 
 // ============================================================
-//                    3. 状态处理函数 (State Handlers)
+//                    4. 发送调度 (Actions)
 // ============================================================
 
-static bool _FSM_Action_PhyTxScheduler(uint8_t *scratch_buf, uint16_t scratch_len, bool *is_need_ack) {
+// 窗口槽的帧真正发出后，启动计时
+static void _FSM_OnSlotSent(TxSlot_t *slot, uint16_t frame_len) {
+    uint32_t now = OSAL_GetTick();
+
+    if (slot->target_id == LORA_ID_BROADCAST) {
+        // 广播模式：进入盲发间隔
+        slot->state = LORA_FSM_SLOT_BROADCAST;
+        slot->deadline = now + LORA_BROADCAST_INTERVAL;
+    } else if (slot->need_ack) {
+        // 可靠传输模式：按该目标的自适应超时启动 ACK 计时
+        const TxSession_t *sess = _FSM_SessionFind(slot->target_id);
+        uint32_t delay = sess ? sess->ack_delay : LORA_ACK_DELAY_MS;
+        slot->state = LORA_FSM_SLOT_WAIT_ACK;
+        slot->sent_tick = now;
+        slot->air_end = s_FSM.air_free_tick;
+        slot->deadline = now + _FSM_Rto(sess, slot->retry_count, frame_len);
+        // 本帧发射完毕 (air_free_tick)、对端模组经串口输出完本帧后，对端开始计 ACK 延时
+        // ([变更] 按实测的对端延时，对端延时仍在缩短，提前 1/4 开始避让)
+        // [修复] 计入对端串口输出本帧与写入 ACK 的时间，否则大帧 (如 FEC 帧) 的避让时段过早结束
+        uint32_t peer_rx = s_FSM.air_free_tick + _FSM_UartMs(frame_len);
+        s_FSM.ack_due = true;
+        s_FSM.ack_due_slot = slot;
+        s_FSM.ack_due_tick = peer_rx + delay - delay / 4;
+        s_FSM.ack_due_end = peer_rx + delay + _FSM_UartMs(ARQ_ACK_FRAME_LEN) + _FSM_AirMs(ARQ_ACK_FRAME_LEN) + ARQ_RTO_MARGIN_MS;
+        LORA_LOG("[MGR] Wait ACK (Seq %d)...\r\n", slot->seq);
+    } else {
+        // 单播不可靠模式：发送即成功
+        slot->state = LORA_FSM_SLOT_DONE_OK;
+    }
+}
+
+// 发送队列中的数据帧 (首次发送) 发出后，找到对应窗口槽
+static void _FSM_OnDataFrameSent(const LoRa_FrameInfo_t *info) {
+    bool need_ack = (info->Ctrl & LORA_CTRL_MASK_NEED_ACK) != 0;
+
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state != LORA_FSM_SLOT_QUEUED) continue;
+        if (slot->target_id != info->TargetID || !_FSM_SeqMatch(slot->seq, info->Sequence, info->SeqShort)) continue;
+        if (slot->need_ack != need_ack) continue;
+        _FSM_OnSlotSent(slot, info->FrameLen);
+        return;
+    }
+    // 找不到对应槽：该帧在排队期间已被确认，忽略
+}
+
+// [新增] 待重发的槽中最先到期的一个 (重发按超时先后进行)
+static TxSlot_t* _FSM_NextRetx(void) {
+    TxSlot_t *best = NULL;
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state != LORA_FSM_SLOT_RETX) continue;
+        if (!best || (int32_t)(slot->deadline - best->deadline) < 0) best = slot;
+    }
+    return best;
+}
+
+/**
+ * @brief 物理层调度：每次只发出一个完整帧 (ACK 优先，其次重发，最后是发送队列)
+ * @note  发送队列中可能积压多帧，一次只取队首一帧，保证每帧的计时从其真正发出时开始，
+ *        同时避免定点模式下多帧拼接 (模组只认第一个 3 字节前缀)。
+ *        [变更] 队列按帧记录存储，取出的恰好是一帧，不再依赖解析帧头截断。
+ *        [变更] 重发的帧直接取窗口槽缓存的线上字节交给 Port，不经过发送队列。
+ *        [变更] 队列中的帧从 Ring 直接复制进 Port 借出的 DMA 缓冲 (零拷贝：不再经过工作区)。
+ */
+static bool _FSM_Action_PhyTxScheduler(void) {
+    LoRa_FrameInfo_t info;
+    TxSlot_t *retx;
+    uint8_t *txbuf;
+    uint16_t cap;
+
     if (LoRa_Port_IsTxBusy()) return false;
-    
+
     // 优先处理 ACK 队列
     if (LoRa_Manager_Buffer_HasAckData()) {
-        uint16_t len = LoRa_Manager_Buffer_PeekAck(scratch_buf, scratch_len);
-        if (len > 0) {
-            if (LoRa_Port_TransmitData(scratch_buf, len) > 0) {
-                LoRa_Manager_Buffer_PopAck(len);
-                if (is_need_ack) *is_need_ack = false; 
-                return true;
-            }
+        if ((txbuf = LoRa_Port_AcquireTxBuffer(&cap)) == NULL) return false;
+        uint16_t len = LoRa_Manager_Buffer_PeekAck(txbuf, cap);
+        if (len == 0) {
+            LoRa_Port_CommitTx(0);
+            LoRa_Manager_Buffer_PopAck(); // 发送缓冲放不下 (不应发生)：丢弃，避免堵塞队列
+        } else if (LoRa_Port_CommitTx(len) > 0) {
+            LoRa_Manager_Buffer_PopAck();
+            _FSM_OnFrameTransmitted(len);
+            return true;
+        }
+    }
+    // 重发窗口槽缓存的帧
+    else if ((retx = _FSM_NextRetx()) != NULL) {
+        s_FSM.tx_held = _FSM_AckWindowBlocked(retx->frame_len, OSAL_GetTick(), &s_FSM.tx_hold_until);
+        if (s_FSM.tx_held) return false;
+        if (LoRa_Port_TransmitData(retx->frame, retx->frame_len) > 0) {
+            _FSM_OnFrameTransmitted(retx->frame_len);
+            _FSM_OnSlotSent(retx, retx->frame_len);
+            return true;
         }
     }
     // 处理普通数据队列
-    else if (s_FSM.state == LORA_FSM_IDLE && LoRa_Manager_Buffer_HasTxData()) {
-        uint16_t len = LoRa_Manager_Buffer_PeekTx(scratch_buf, scratch_len);
-        if (len > 0) {
-            if (LoRa_Port_TransmitData(scratch_buf, len) > 0) {
-                LoRa_Manager_Buffer_PopTx(len);
-                
-                if (is_need_ack) {
-                    uint8_t offset = (s_FSM_Config->tmode == 1) ? 3 : 0;
-                    if (len > offset + 3) {
-                        *is_need_ack = (scratch_buf[offset + 3] & LORA_CTRL_MASK_NEED_ACK);
-                    } else {
-                        *is_need_ack = false;
-                    }
-                }
-                return true;
-            }
+    else if (LoRa_Manager_Buffer_HasTxData()) {
+        uint16_t len = LoRa_Manager_Buffer_TxFrameLen();
+        s_FSM.tx_held = _FSM_AckWindowBlocked(len, OSAL_GetTick(), &s_FSM.tx_hold_until);
+        if (s_FSM.tx_held) return false;
+        if ((txbuf = LoRa_Port_AcquireTxBuffer(&cap)) == NULL) return false;
+        if (LoRa_Manager_Buffer_PeekTx(txbuf, cap) != len) {
+            LoRa_Port_CommitTx(0);
+            LoRa_Manager_Buffer_PopTx(); // 发送缓冲放不下 (不应发生)：丢弃，避免堵塞队列
+            return false;
+        }
+        // 队列中的帧均由 FSM 封包，帧头信息用于找到对应窗口槽 (启动 DMA 前读取)
+        bool has_info = LoRa_Manager_Protocol_PeekFrame(txbuf, len, s_FSM_Config->tmode, &info) > 0;
+        if (LoRa_Port_CommitTx(len) > 0) {
+            LoRa_Manager_Buffer_PopTx();
+            _FSM_OnFrameTransmitted(len);
+            if (has_info) _FSM_OnDataFrameSent(&info);
+            return true;
         }
     }
     return false;
 }
 
-
 /**
- * @brief 处理 ACK 等待超时逻辑 (重传策略核心)
- * @return true=状态已变更(重传或失败), false=无动作(物理层忙)
+ * @brief 处理窗口槽的超时 (重传策略核心)
+ * @note  [变更] 重发不再重新封包入队，槽转为 RETX 等待物理层调度
  */
-static bool _FSM_HandleAckTimeout(uint8_t *scratch_buf, uint16_t scratch_len, LoRa_FSM_Output_t *output) {
-    // 1. 检查重传次数是否耗尽
-    if (s_FSM.retry_count >= LORA_MAX_RETRY) {
-        LORA_LOG("[MGR] ACK Failed (Max Retry)\r\n");
-        output->Event = FSM_EVT_TX_TIMEOUT;
-        output->MsgID = s_FSM.current_tx_id;
-        _FSM_Reset();
-        return true;
+static void _FSM_HandleSlotTimeout(TxSlot_t *slot) {
+    if (slot->state == LORA_FSM_SLOT_WAIT_ACK) {
+        // 1. 检查重传次数是否耗尽
+        if (slot->retry_count >= LORA_MAX_RETRY) {
+            LORA_LOG("[MGR] ACK Failed (Seq %d, Max Retry)\r\n", slot->seq);
+            slot->state = LORA_FSM_SLOT_DONE_FAIL;
+            return;
+        }
+        // 2. 等待重发 (发出时才按新的重传次数计时)
+        slot->retry_count++;
+        slot->state = LORA_FSM_SLOT_RETX;
+        LORA_LOG("[MGR] ACK Timeout, Retry %d/%d (Seq %d)\r\n",
+                 slot->retry_count, LORA_MAX_RETRY, slot->seq);
     }
+    else if (slot->state == LORA_FSM_SLOT_BROADCAST) {
+        if (slot->retry_count < LORA_BROADCAST_REPEAT) {
+            // [重发逻辑]
+            slot->retry_count++;
+            slot->state = LORA_FSM_SLOT_RETX;
+        } else {
+            // [完成逻辑] 广播结束，视为成功
+            slot->state = LORA_FSM_SLOT_DONE_OK;
+        }
+    }
+}
+
+// 取出一个已完成槽的事件并释放该槽
+static LoRa_FSM_Output_t _FSM_PopDoneEvent(void) {
+    LoRa_FSM_Output_t output = { .Event = FSM_EVT_NONE, .MsgID = 0 };
+
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_DONE_OK || slot->state == LORA_FSM_SLOT_DONE_FAIL) {
+            output.Event = (slot->state == LORA_FSM_SLOT_DONE_OK) ? FSM_EVT_TX_DONE : FSM_EVT_TX_TIMEOUT;
+            output.MsgID = slot->msg_id;
+            slot->state = LORA_FSM_SLOT_FREE;
+            break;
+        }
+    }
+    return output;
+}
 
-    // 2. 执行重传准备
-    s_FSM.retry_count++;
-
-    // [策略] 线性退避 + 随机抖动
-    // Base: 1500ms, Step: 500ms, Jitter: 0~500ms
-    // Retry 1: 2000~2500ms
-    // Retry 2: 2500~3000ms
-    // Retry 3: 3000~3500ms
-    uint32_t step_add = s_FSM.retry_count * 500;
-    
-    // [关键] 这里暂时调用 Port 层，稍后讨论架构问题
-    uint32_t jitter = LoRa_Port_GetEntropy32() % 501; 
-    
-    uint32_t next_timeout = LORA_RETRY_INTERVAL_MS + step_add + jitter;
-
-    LORA_LOG("[MGR] ACK Timeout, Retry %d/%d (Next: %dms)\r\n", 
-             s_FSM.retry_count, LORA_MAX_RETRY, next_timeout);
-
-    // 3. 重新入队
-    if (s_FSM.pending_len > 0) {
-        LoRa_Packet_t *pending = (LoRa_Packet_t*)s_FSM.pending_buf;
-        LoRa_Manager_Buffer_PushTx(pending, s_FSM_Config->tmode, s_FSM_Config->channel, scratch_buf, scratch_len);
-        
-        // 4. 尝试立即调度
-        // 临时切换状态以允许调度器工作
-        LoRa_FSM_State_t backup_state = s_FSM.state;
-        s_FSM.state = LORA_FSM_IDLE;
-        
-        if (_FSM_Action_PhyTxScheduler(scratch_buf, scratch_len, NULL)) {
-            // 发送成功，设置下一次超时
-            _FSM_SetState(LORA_FSM_WAIT_ACK, next_timeout);
+static bool _FSM_HasDoneEvent(void) {
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        if (s_FSM.slots[i].state == LORA_FSM_SLOT_DONE_OK || s_FSM.slots[i].state == LORA_FSM_SLOT_DONE_FAIL) {
             return true;
-        } else {
-            // 物理层忙，恢复状态，下个循环再试
-            s_FSM.state = backup_state; 
-            return false;
         }
-    } else {
-        // 异常：Pending Buffer 为空
-        _FSM_Reset();
-        return true;
     }
+    return false;
+}
+
+static bool _FSM_HasRxReady(void) {
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        if (s_FSM.rx_hold[i].state == RX_HOLD_READY) return true;
+    }
+    return false;
 }
 
 // ============================================================
-//                    4. 核心接口实现
+//                    5. 核心接口实现
 // ============================================================
 
 void LoRa_Manager_FSM_Init(const LoRa_Config_t *cfg) {
     LORA_CHECK_VOID(cfg);
-    s_FSM_Config = cfg; 
-    _FSM_Reset();
-    s_FSM.tx_seq = 0;
-    memset(s_FSM.dedup_table, 0, sizeof(s_FSM.dedup_table));
-    s_PendingOutput.Event = FSM_EVT_NONE;
+    s_FSM_Config = cfg;
+    memset(&s_FSM, 0, sizeof(s_FSM));
 }
 
 uint32_t LoRa_Manager_FSM_GetNextTimeout(void) {
-    if (s_FSM.timeout_deadline == LORA_TIMEOUT_INFINITE) {
-        return LORA_TIMEOUT_INFINITE;
-    }
+    // 有待输出事件或待交付帧，不可休眠
+    if (_FSM_HasDoneEvent() || _FSM_HasRxReady()) return 0;
+
+    // 有待发帧且物理层可发，不可休眠
+    // 物理层忙时由发送完成中断 (硬件事件) 唤醒
+    // 数据帧正在避让对端 ACK 时，等到避让结束
+    bool has_tx = LoRa_Manager_Buffer_HasAckData() ||
+                  ((LoRa_Manager_Buffer_HasTxData() || _FSM_NextRetx() != NULL) && !s_FSM.tx_held);
+    if (has_tx && !LoRa_Port_IsTxBusy()) return 0;
+
+    // 取所有计时器中最早的截止时刻
     uint32_t now = OSAL_GetTick();
-    if ((int32_t)(s_FSM.timeout_deadline - now) <= 0) {
-        return 0; 
-    } else {
-        return s_FSM.timeout_deadline - now; 
+    uint32_t min_wait = LORA_TIMEOUT_INFINITE;
+
+    #define _FSM_TRACK_DEADLINE(dl) do { \
+        int32_t _w = (int32_t)((dl) - now); \
+        if (_w <= 0) return 0; \
+        if ((uint32_t)_w < min_wait) min_wait = (uint32_t)_w; \
+    } while (0)
+
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (_FSM_AckPending(&s_FSM.acks[i])) _FSM_TRACK_DEADLINE(s_FSM.acks[i].deadline);
+    }
+    if (s_FSM.tx_held) _FSM_TRACK_DEADLINE(s_FSM.tx_hold_until);
+
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        const TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_WAIT_ACK || slot->state == LORA_FSM_SLOT_BROADCAST) {
+            _FSM_TRACK_DEADLINE(slot->deadline);
+        }
+    }
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        const RxPeer_t *p = &s_FSM.rx_peers[i];
+        if (p->valid && p->held > 0) _FSM_TRACK_DEADLINE(p->hole_deadline);
     }
+
+    #undef _FSM_TRACK_DEADLINE
+    return min_wait;
 }
 
-// [修复] 实现了 IsBusy
 bool LoRa_Manager_FSM_IsBusy(void) {
-    // 只要状态不是 IDLE，或者有挂起的事件未处理，都视为忙
-    return (s_FSM.state != LORA_FSM_IDLE) || (s_PendingOutput.Event != FSM_EVT_NONE);
+    // 有在途帧、待回复的 ACK 或未输出的事件，都视为忙
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        if (s_FSM.slots[i].state != LORA_FSM_SLOT_FREE) return true;
+    }
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        if (_FSM_AckPending(&s_FSM.acks[i])) return true;
+    }
+    return LoRa_Manager_Buffer_HasAckData();
+}
+
+bool LoRa_Manager_FSM_CanSend(uint16_t target_id, LoRa_SendOpt_t opt) {
+    if (!_FSM_FindFreeSlot()) return false;
+    if (target_id == LORA_ID_BROADCAST || !opt.NeedAck) return true;
+
+    // 目标处于重传退避中：不再追加新帧，把窗口槽让给其他目标
+    uint8_t inflight = 0;
+    if (_FSM_SessionLoad(target_id, &inflight)) return false;
+    if (inflight >= LORA_ARQ_WINDOW_SIZE) return false;
+
+    // 只查询，不分配会话
+    const TxSession_t *p = _FSM_SessionFind(target_id);
+    return p ? _FSM_SeqInWindow(target_id, p->next_seq) : true;
+}
+
+uint8_t LoRa_Manager_FSM_GetInflight(uint16_t target_id) {
+    uint8_t n = 0;
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        const TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state == LORA_FSM_SLOT_FREE || slot->target_id != target_id) continue;
+        if (slot->state == LORA_FSM_SLOT_DONE_OK || slot->state == LORA_FSM_SLOT_DONE_FAIL) continue;
+        n++;
+    }
+    return n;
 }
 
 bool LoRa_Manager_FSM_Send(const uint8_t *payload, uint16_t len, uint16_t target_id, LoRa_SendOpt_t opt,
-                           LoRa_MsgID_t msg_id,
+                           LoRa_MsgID_t msg_id, uint8_t frame_flags,
                            uint8_t *scratch_buf, uint16_t scratch_len) {
-    
-    if (s_FSM.state != LORA_FSM_IDLE) {
-        LORA_LOG("[MGR] Send Reject: Busy\r\n");
-        return false; 
-    }
-
-    static LoRa_Packet_t s_TempPkt; 
-    memset(&s_TempPkt, 0, sizeof(s_TempPkt));
-    
-    s_TempPkt.IsAckPacket = false;
-    s_TempPkt.NeedAck = (target_id == 0xFFFF) ? false : opt.NeedAck;
-    s_TempPkt.HasCrc = LORA_ENABLE_CRC;
-    s_TempPkt.TargetID = target_id;
-    s_TempPkt.SourceID = s_FSM_Config->net_id;
-    s_TempPkt.Sequence = ++s_FSM.tx_seq;
-    s_TempPkt.PayloadLen = len;
+
+    if (!LoRa_Manager_FSM_CanSend(target_id, opt)) {
+        LORA_LOG("[MGR] Send Reject: Window Full\r\n");
+        return false;
+    }
+
+    TxSlot_t *slot = _FSM_FindFreeSlot();
+    LoRa_Packet_t packet;
+    LoRa_Packet_t *pkt = &packet;
+    memset(pkt, 0, sizeof(LoRa_Packet_t));
+
     if (len > LORA_MAX_PAYLOAD_LEN) len = LORA_MAX_PAYLOAD_LEN;
-    memcpy(s_TempPkt.Payload, payload, len);
-    
-    uint16_t packed_len = LoRa_Manager_Protocol_Pack(&s_TempPkt, s_FSM.pending_buf, sizeof(s_FSM.pending_buf), s_FSM_Config->tmode, s_FSM_Config->channel);
-    if (packed_len == 0) return false;
-    
-    memcpy(s_FSM.pending_buf, &s_TempPkt, sizeof(LoRa_Packet_t));
-    s_FSM.pending_len = 1; 
-    
-    // 保存当前 ID
-    s_FSM.current_tx_id = msg_id;
+    pkt->IsAckPacket = false;
+    pkt->NeedAck = (target_id == LORA_ID_BROADCAST) ? false : opt.NeedAck;
+    pkt->HasCrc = LORA_ENABLE_CRC;
+    pkt->IsFragment = (frame_flags & LORA_CTRL_MASK_FRAG) != 0;
+    pkt->IsAggregate = (frame_flags & LORA_CTRL_MASK_AGG) != 0;
+    pkt->IsCompressed = (frame_flags & LORA_CTRL_MASK_COMP) != 0;
+    pkt->Format = LoRa_Manager_Protocol_SelectFormat(target_id);
+    pkt->UseFec = (opt.UseFec && LORA_FEC_ENABLE) || LoRa_Manager_Protocol_LinkFec(target_id);
+    pkt->HdrCheck = pkt->NeedAck && LoRa_Manager_Protocol_LinkHdrCheck(target_id);
+    pkt->TargetID = target_id;
+    pkt->SourceID = s_FSM_Config->net_id;
+    pkt->PayloadLen = len;
+    memcpy(pkt->Payload, payload, len);
 
-    return LoRa_Manager_Buffer_PushTx(&s_TempPkt, s_FSM_Config->tmode, s_FSM_Config->channel, scratch_buf, scratch_len);
+    // 确认帧使用目标独立的序号空间 (接收方据此维护窗口)，其余帧使用全局序号
+    TxSession_t *sess = NULL;
+    if (_IsReliable(pkt)) {
+        sess = _FSM_SessionGet(target_id);
+        pkt->Sequence = sess->next_seq;
+    } else {
+        pkt->Sequence = ++s_FSM.tx_seq;
+    }
+
+    // [新增] 捎带确认：对该目标有待发的 ACK 且负载放得下时，随本帧发出 (省去一帧 ACK)
+    // [修复] 仅对已声明支持扩展负载的对端捎带；旧版节点仍由 ACK 定时器单独发送确认
+    AckCtx_t *ack = LoRa_Manager_Protocol_LinkExt(target_id) ? _FSM_AckFind(target_id) : NULL;
+    uint16_t ack_head = 0;
+    uint8_t  ack_map[ARQ_ACK_BITMAP_LEN];
+    if (ack && len + LORA_PROTOCOL_PIGGY_HDR_LEN + ARQ_ACK_BITMAP_LEN <= LORA_MAX_PAYLOAD_LEN &&
+        _FSM_BuildBlockAck(ack, &ack_head, ack_map)) {
+        pkt->HasPiggyAck = true;
+        pkt->PiggyAckSeq = ack_head;
+        pkt->PiggyAckLen = ARQ_ACK_BITMAP_LEN;
+        memcpy(pkt->PiggyAckMap, ack_map, ARQ_ACK_BITMAP_LEN);
+    }
+
+    // [变更] 首次发送的帧入发送队列；同时缓存一份不带捎带确认的线上字节供重传直接使用
+    //        (重传时不再捎带，届时的确认状态由 ACK 定时器另行发送)
+    //        [变更] 无捎带时两者相同：直接封包到槽缓存并由此入队，不经过工作区
+    const uint8_t *frame = slot->frame;
+    uint16_t frame_len;
+    bool piggy = pkt->HasPiggyAck;
+    if (piggy) {
+        frame = scratch_buf;
+        frame_len = LoRa_Manager_Protocol_Pack(pkt, scratch_buf, scratch_len, s_FSM_Config->tmode, s_FSM_Config->channel);
+        if (frame_len == 0) return false;
+        pkt->HasPiggyAck = false;
+    }
+    slot->frame_len = LoRa_Manager_Protocol_Pack(pkt, slot->frame, sizeof(slot->frame), s_FSM_Config->tmode, s_FSM_Config->channel);
+    if (slot->frame_len == 0) return false;
+    if (!piggy) frame_len = slot->frame_len;
+    if (!LoRa_Manager_Buffer_PushTx(frame, frame_len)) {
+        return false;
+    }
+
+    if (piggy) {
+        LORA_LOG("[MGR] ACK Piggybacked (Seq %d)\r\n", ack_head);
+        _FSM_AckCtxRemove(ack, ack_head, ack_map);
+    }
+    if (sess) sess->next_seq++;
+    slot->target_id = pkt->TargetID;
+    slot->seq = pkt->Sequence;
+    slot->need_ack = pkt->NeedAck;
+    slot->msg_id = msg_id;
+    slot->retry_count = 0;
+    slot->deadline = LORA_TIMEOUT_INFINITE;
+    slot->state = LORA_FSM_SLOT_QUEUED;
+    return true;
 }
 
-bool LoRa_Manager_FSM_ProcessRxPacket(const LoRa_Packet_t *packet) {
-    if (packet->IsAckPacket) {
-        if (s_FSM.state == LORA_FSM_WAIT_ACK) {
-            LoRa_Packet_t *pending = (LoRa_Packet_t*)s_FSM.pending_buf;
-            if (packet->Sequence == pending->Sequence) {
-                LORA_LOG("[MGR] ACK Recv (Seq %d)\r\n", packet->Sequence);
-                
-                // [修复] 收到 ACK，设置挂起事件，通知 Manager 发送成功
-                // 注意：必须在 Reset 之前保存 ID，因为 Reset 会清空 ID
-                _SetPendingEvent(FSM_EVT_TX_DONE, s_FSM.current_tx_id);
-                
-                _FSM_Reset();
-            }
+// 确认一个在途槽 (Karn 规则：重传过的帧无法区分 ACK 对应哪次发送，不采样)
+static void _FSM_AckSlot(TxSlot_t *slot) {
+    TxSession_t *sess = _FSM_SessionFind(slot->target_id);
+    if (sess && slot->state == LORA_FSM_SLOT_WAIT_ACK && slot->retry_count == 0) {
+        _FSM_RttSample(sess, OSAL_GetTick() - slot->sent_tick);
+    }
+    // 收到 ACK，由下一次 Run 输出 TX_DONE
+    slot->state = LORA_FSM_SLOT_DONE_OK;
+}
+
+/**
+ * @brief [新增] 由 ACK 的到达时刻测量对端的 ACK 延时
+ * @note  帧发射结束 -> ACK 完整收到 = 对端延时 + ACK 空中时间 + 串口时间。
+ *        只采样未重传的帧 (Karn)，平滑后供 ACK 避让与重传超时使用。
+ */
+static void _FSM_AckDelaySample(const TxSlot_t *slot, uint32_t now) {
+    TxSession_t *sess = _FSM_SessionFind(slot->target_id);
+    if (!sess || (int32_t)(now - slot->air_end) <= 0) return;
+
+    // [修复] 扣除对端串口输出本帧的时间 (与 _FSM_Rto 的物理下限一致)，只保留对端的 ACK 延时
+    uint32_t fixed  = _FSM_UartMs(slot->frame_len) + _FSM_AirMs(ARQ_ACK_FRAME_LEN) + 2 * _FSM_UartMs(ARQ_ACK_FRAME_LEN);
+    uint32_t sample = now - slot->air_end;
+    sample = (sample > fixed) ? (sample - fixed) : 0;
+    if (sample > LORA_ACK_DELAY_MS) sample = LORA_ACK_DELAY_MS;
+    sess->ack_delay = (3 * sess->ack_delay + sample + 3) / 4;
+}
+
+/**
+ * @brief [新增] 收到确认后更新 ACK 避让
+ * @note  对端已确认最近发出的帧，不必再为它的 ACK 避让；确认的只是更早的帧时，
+ *        最近一帧的 ACK 仍将到来，保持避让。
+ */
+static void _FSM_AckDueUpdate(void) {
+    if (s_FSM.ack_due && s_FSM.ack_due_slot->state != LORA_FSM_SLOT_WAIT_ACK) s_FSM.ack_due = false;
+}
+
+/**
+ * @brief 处理确认 (ACK 帧或数据帧捎带的确认)
+ * @param src: 确认发送方
+ * @param seq: 基序号 (seq_short 时只有低 8 位有效)
+ * @param bitmap: 块确认位图 (NULL=普通 ACK)
+ * @param timed: [新增] 独立的 ACK 帧 (到达时刻可用于测量对端 ACK 延时；捎带确认不可)
+ * @note  [新增] 块确认：位图中已收到的序号一并确认；位图中未收到、且早于基序号帧发出的帧
+ *        (同一信道上不会乱序到达) 已经丢失，立即重传这些缺口而不必等待超时。
+ *        基序号帧重传过时无法确定对端收到的是哪一次发送，不做缺口判断。
+ */
+static void _FSM_OnAck(uint16_t src, uint16_t seq, bool seq_short, const uint8_t *bitmap, uint8_t bm_len, bool timed) {
+    _FSM_SyncAirFree(OSAL_GetTick());
+
+    // 在途帧中查找基序号 (优先匹配目标与 ACK 源一致的槽)
+    // [修复] 多个对端的会话同时在途时序号会重复 (V2 ACK 只带低 8 位)，只接受发给 ACK 源的槽；
+    //        发给本机所在组的确认帧由任一组员确认，不会被其他单播对端的 ACK 误确认
+    TxSlot_t *match = NULL;
+    uint16_t group_id = s_FSM_Config->group_id;
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state != LORA_FSM_SLOT_WAIT_ACK && slot->state != LORA_FSM_SLOT_QUEUED &&
+            slot->state != LORA_FSM_SLOT_RETX) continue;
+        if (!_FSM_SlotReliable(slot) || !_FSM_SeqMatch(slot->seq, seq, seq_short)) continue;
+        if (slot->target_id == src) { match = slot; break; }
+        if (group_id != 0 && slot->target_id == group_id && !match) match = slot;
+    }
+
+    bool     probe = false;
+    uint32_t head_tick = 0;
+    if (match) {
+        LORA_LOG("[MGR] ACK Recv (Seq %d)\r\n", seq);
+        if (match->state == LORA_FSM_SLOT_WAIT_ACK && match->retry_count == 0 && match->target_id == src) {
+            probe = true;
+            head_tick = match->sent_tick;
+            if (timed) _FSM_AckDelaySample(match, OSAL_GetTick());
         }
-        return false; 
-    } else {
-        // 数据包去重检查
-        if (_FSM_CheckDuplicate(packet->SourceID, packet->Sequence)) {
-            LORA_LOG("[MGR] Drop Duplicate\r\n");
-            // 即使是重复包，如果是需要 ACK 的，也得回 ACK (可能上一个 ACK 丢了)
-            if (packet->NeedAck && packet->TargetID != 0xFFFF) {
-                s_FSM.ack_ctx.target_id = packet->SourceID;
-                s_FSM.ack_ctx.seq = packet->Sequence;
-                s_FSM.ack_ctx.pending = true;
-                _FSM_SetState(LORA_FSM_ACK_DELAY, LORA_ACK_DELAY_MS);
-            }
-            return false; 
+        _FSM_AckSlot(match);
+    }
+    if (!bitmap) {
+        _FSM_AckDueUpdate();
+        return;
+    }
+
+    uint32_t now = OSAL_GetTick();
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state != LORA_FSM_SLOT_WAIT_ACK && slot->state != LORA_FSM_SLOT_QUEUED &&
+            slot->state != LORA_FSM_SLOT_RETX) continue;
+        if (!_FSM_SlotReliable(slot) || slot->target_id != src) continue;
+
+        uint16_t d = (uint16_t)(seq - slot->seq);
+        if (seq_short) d &= 0xFF;
+        if (d == 0 || d > (uint16_t)bm_len * 8) continue;
+
+        if (bitmap[(d - 1) / 8] & (1u << ((d - 1) % 8))) {
+            LORA_LOG("[MGR] Block ACK Recv (Seq %d)\r\n", slot->seq);
+            _FSM_AckSlot(slot);
+        } else if (probe && slot->state == LORA_FSM_SLOT_WAIT_ACK &&
+                   (int32_t)(head_tick - slot->sent_tick) > 0 && !_IsExpired(slot->deadline, now)) {
+            // 缺口：下次 Run 立即重传
+            LORA_LOG("[MGR] Hole Detected (Seq %d)\r\n", slot->seq);
+            slot->deadline = now;
+        }
+    }
+    _FSM_AckDueUpdate();
+}
+
+/**
+ * @brief [新增] 处理 NACK：对端收到的该帧已损坏，立即重传 (计入重传次数)
+ */
+static void _FSM_OnNack(uint16_t src, uint16_t seq, bool seq_short) {
+    s_FSM.ack_due = false;
+
+    uint32_t now = OSAL_GetTick();
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if (slot->state != LORA_FSM_SLOT_WAIT_ACK || slot->target_id != src) continue;
+        if (!_FSM_SlotReliable(slot) || !_FSM_SeqMatch(slot->seq, seq, seq_short)) continue;
+        if (!_IsExpired(slot->deadline, now)) {
+            LORA_LOG("[MGR] NACK Recv (Seq %d)\r\n", slot->seq);
+            slot->deadline = now;
         }
-        
-        // 新包
-        if (packet->NeedAck && packet->TargetID != 0xFFFF) {
-            s_FSM.ack_ctx.target_id = packet->SourceID;
-            s_FSM.ack_ctx.seq = packet->Sequence;
-            s_FSM.ack_ctx.pending = true;
-            _FSM_SetState(LORA_FSM_ACK_DELAY, LORA_ACK_DELAY_MS);
+        break;
+    }
+}
+
+bool LoRa_Manager_FSM_ProcessRxPacket(LoRa_Packet_t *packet) {
+    // [新增] CRC 失败的帧只有帧头可信：不学习对端能力，按需回 NACK
+    if (packet->CrcError) {
+#if LORA_NACK_ENABLE
+        if (_IsReliable(packet)) _FSM_QueueNack(packet);
+#endif
+        return false;
+    }
+
+    LoRa_Manager_Protocol_LearnPeer(packet);
+
+    if (packet->IsAckPacket && packet->NeedAck) {
+        _FSM_OnNack(packet->SourceID, packet->Sequence, packet->SeqShort);
+        return false;
+    }
+
+    if (packet->IsAckPacket) {
+        const uint8_t *bitmap = NULL;
+        uint8_t bm_len = 0;
+        if (packet->IsBlockAck) {
+            // V1 ACK 负载首字节为能力字节，位图在其后
+            uint8_t bm_off = (packet->Format == LORA_FRAME_FMT_V1) ? 1 : 0;
+            bm_len = (packet->PayloadLen > bm_off) ? (uint8_t)(packet->PayloadLen - bm_off) : 0;
+            bitmap = &packet->Payload[bm_off];
         }
-        return true; 
+        _FSM_OnAck(packet->SourceID, packet->Sequence, packet->SeqShort, bitmap, bm_len, true);
+        return false;
+    }
+
+    // [新增] 捎带确认：先按 ACK 处理，再按普通数据帧处理
+    // [修复] 只按低 8 位匹配：对端的接收窗口若由 V2 短序号建立，确认的高 8 位不可信
+    //        (与 V2 ACK 相同；同一目标的在途帧远少于 256，不会混淆)
+    if (packet->HasPiggyAck) {
+        _FSM_OnAck(packet->SourceID, packet->PiggyAckSeq, true, packet->PiggyAckMap, packet->PiggyAckLen, false);
+    }
+
+    if (_IsReliable(packet)) {
+        return _FSM_RxReliable(packet);
+    }
+
+    // 非确认帧/广播帧：去重检查 (广播会重复盲发)
+    if (_FSM_CheckDuplicate(packet->SourceID, packet->Sequence)) {
+        LORA_LOG("[MGR] Drop Duplicate\r\n");
+        return false;
+    }
+    return true;
+}
+
+bool LoRa_Manager_FSM_PopRxPacket(LoRa_Packet_t *packet) {
+    RxHold_t *oldest = NULL;
+
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state != RX_HOLD_READY) continue;
+        if (!oldest || (int16_t)(h->stamp - oldest->stamp) < 0) oldest = h;
+    }
+    if (!oldest) return false;
+
+    if (packet) memcpy(packet, &oldest->pkt, sizeof(LoRa_Packet_t));
+    oldest->state = RX_HOLD_FREE;
+    return true;
+}
+
+bool LoRa_Manager_FSM_RxHoldsFragment(uint16_t src_id) {
+    for (int i = 0; i < ARQ_REORDER_POOL_SIZE; i++) {
+        const RxHold_t *h = &s_FSM.rx_hold[i];
+        if (h->state != RX_HOLD_FREE && h->pkt.SourceID == src_id && h->pkt.IsFragment) return true;
     }
+    return false;
 }
 
 /**
  * @brief  运行状态机 (周期调用)
- * @param  scratch_buf: 共享工作区 (用于 TX 预览)
- * @param  scratch_len: 工作区大小
  * @return FSM 输出事件 (上层需根据此返回值触发回调)
  */
-LoRa_FSM_Output_t LoRa_Manager_FSM_Run(uint8_t *scratch_buf, uint16_t scratch_len) {
-    // ============================================================
-    // 1. 输入采集 (Input Collection)
-    // ============================================================
-    LoRa_FSM_Output_t output = { .Event = FSM_EVT_NONE, .MsgID = 0 };
+LoRa_FSM_Output_t LoRa_Manager_FSM_Run(void) {
     uint32_t now = OSAL_GetTick();
-    
-    // 计算是否超时
-    bool is_timeout = false;
-    if (s_FSM.timeout_deadline != LORA_TIMEOUT_INFINITE) {
-        // 使用 int32_t 强转处理 tick 溢出回绕问题
-        if ((int32_t)(s_FSM.timeout_deadline - now) <= 0) {
-            is_timeout = true;
-        }
-    }
-
-    // ============================================================
-    // 2. 异步事件分发 (Async Event Dispatch)
-    // ============================================================
-    // 优先处理来自 ProcessRxPacket 的挂起事件 (例如收到 ACK 导致的 TX_DONE)
-    if (s_PendingOutput.Event != FSM_EVT_NONE) {
-        output = s_PendingOutput;
-        s_PendingOutput.Event = FSM_EVT_NONE; // 清除挂起标志
-        return output; // 立即返回，优先响应
-    }
-
-    // ============================================================
-    // 3. 状态机核心逻辑 (State Machine Core)
-    // ============================================================
-    switch (s_FSM.state) {
-        
-        // --------------------------------------------------------
-        // 状态: 空闲 (IDLE)
-        // 任务: 检查发送队列，调度新任务
-        // --------------------------------------------------------
-        case LORA_FSM_IDLE: {
-            bool need_ack = false;
-            
-            // 尝试从队列中提取并发送数据
-            if (_FSM_Action_PhyTxScheduler(scratch_buf, scratch_len, &need_ack)) {
-                // 获取刚刚发送的包信息（用于判断下一步状态）
-                LoRa_Packet_t *pending = (LoRa_Packet_t*)s_FSM.pending_buf;
-                
-                if (pending->TargetID == LORA_ID_BROADCAST) {
-                    // [分支1] 广播模式：进入盲发状态
-                    s_FSM.retry_count = 0;
-                    _FSM_SetState(LORA_FSM_BROADCAST_RUN, LORA_BROADCAST_INTERVAL);
-                    LORA_LOG("[MGR] Broadcast Start\r\n");
-                }
-                else if (need_ack) {
-                    // [分支2] 可靠传输模式：进入等待 ACK 状态
-                    s_FSM.retry_count = 0;
-                    _FSM_SetState(LORA_FSM_WAIT_ACK, LORA_ACK_TIMEOUT_MS);
-                    LORA_LOG("[MGR] Wait ACK...\r\n");
-                }
-                else {
-                    // [分支3] 单播不可靠模式：发送即成功
-                    output.Event = FSM_EVT_TX_DONE;
-                    output.MsgID = s_FSM.current_tx_id;
-                    _FSM_Reset(); // 任务完成，重置状态
-                }
-            }
-            break;
-        }
+    _FSM_SyncAirFree(now);
 
-        // --------------------------------------------------------
-        // 状态: ACK 延时 (ACK_DELAY)
-        // 任务: 等待延时结束，发送 ACK 包
-        // --------------------------------------------------------
-        case LORA_FSM_ACK_DELAY: {
-            if (is_timeout) {
-                if (s_FSM.ack_ctx.pending) {
-                    _FSM_SendAck(); 
-                    LORA_LOG("[MGR] ACK Queued\r\n");
-                }
-                // 发送完 ACK 后回到空闲状态
-                _FSM_SetState(LORA_FSM_IDLE, LORA_TIMEOUT_INFINITE);
-            }
-            break;
+    // 1. ACK 延时到期：推入 ACK 队列 (各源独立)
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        AckCtx_t *ctx = &s_FSM.acks[i];
+        if (_FSM_AckPending(ctx) && _IsExpired(ctx->deadline, now)) {
+            _FSM_FlushAck(ctx);
+            LORA_LOG("[MGR] ACK Queued\r\n");
         }
+    }
 
-        // --------------------------------------------------------
-        // 状态: 等待 ACK (WAIT_ACK)
-        // 任务: 检查超时，执行重传或报错
-        // --------------------------------------------------------
-        case LORA_FSM_WAIT_ACK: {
-            if (is_timeout) {
-                _FSM_HandleAckTimeout(scratch_buf, scratch_len, &output);
-            }
-            break;
+    // 2. 乱序等待超时：跳过缺口
+    for (int i = 0; i < LORA_ARQ_PEER_MAX; i++) {
+        RxPeer_t *p = &s_FSM.rx_peers[i];
+        if (p->valid && p->held > 0 && _IsExpired(p->hole_deadline, now)) {
+            _FSM_RxSkipHole(p);
         }
+    }
 
-        // --------------------------------------------------------
-        // 状态: 广播盲发 (BROADCAST_RUN)
-        // 任务: 循环发送多次，提高送达率
-        // --------------------------------------------------------
-        case LORA_FSM_BROADCAST_RUN: {
-            if (is_timeout) {
-                if (s_FSM.retry_count < LORA_BROADCAST_REPEAT) {
-                    // [重发逻辑]
-                    s_FSM.retry_count++;
-                    if (s_FSM.pending_len > 0) {
-                        LoRa_Packet_t *pending = (LoRa_Packet_t*)s_FSM.pending_buf;
-                        LoRa_Manager_Buffer_PushTx(pending, s_FSM_Config->tmode, s_FSM_Config->channel, scratch_buf, scratch_len);
-                        
-                        // 尝试立即调度
-                        LoRa_FSM_State_t backup_state = s_FSM.state;
-                        s_FSM.state = LORA_FSM_IDLE;
-                        
-                        if (_FSM_Action_PhyTxScheduler(scratch_buf, scratch_len, NULL)) {
-                            // 发送成功，设置下一次间隔
-                            _FSM_SetState(LORA_FSM_BROADCAST_RUN, LORA_BROADCAST_INTERVAL);
-                        } else {
-                            s_FSM.state = backup_state;
-                        }
-                    }
-                } else {
-                    // [完成逻辑] 广播结束，视为成功
-                    output.Event = FSM_EVT_TX_DONE;
-                    output.MsgID = s_FSM.current_tx_id;
-                    _FSM_Reset();
-                }
-            }
-            break;
+    // 3. 窗口槽计时：重传 / 广播盲发 / 失败
+    for (int i = 0; i < LORA_ARQ_TX_SLOTS; i++) {
+        TxSlot_t *slot = &s_FSM.slots[i];
+        if ((slot->state == LORA_FSM_SLOT_WAIT_ACK || slot->state == LORA_FSM_SLOT_BROADCAST) &&
+            _IsExpired(slot->deadline, now)) {
+            _FSM_HandleSlotTimeout(slot);
         }
-
-        default:
-            break;
     }
-    
-    return output;
-}
 
+    // 4. 物理层调度
+    _FSM_Action_PhyTxScheduler();
+
+    // 5. 输出一个完成事件 (其余的由后续 Run 输出，GetNextTimeout 会保持唤醒)
+    return _FSM_PopDoneEvent();
+}
@@ -2,7 +2,7 @@
   ******************************************************************************
   * @file    lora_manager_fsm.h
   * @author  LoRaPlat Team
-  * @brief   LoRa 协议状态机定义 (V3.4.0 Decoupled)
+  * @brief   LoRa 协议状态机定义 (V3.5.0 Selective Repeat)
   *          纯逻辑层，不依赖上层业务，通过返回值输出事件。
   ******************************************************************************
   */
@@ -20,14 +20,17 @@
 // ============================================================
 
 /**
- * @brief FSM 内部状态枚举
+ * @brief 发送窗口槽状态 (选择重传：每个在途帧一个槽，独立计时)
  */
 typedef enum {
-    LORA_FSM_IDLE = 0,      // 空闲
-    LORA_FSM_WAIT_ACK,      // 等待 ACK (重传计时中)
-    LORA_FSM_ACK_DELAY,     // 发送 ACK 前的延时
-    LORA_FSM_BROADCAST_RUN  // 广播盲发运行中
-} LoRa_FSM_State_t;
+    LORA_FSM_SLOT_FREE = 0,     // 空闲
+    LORA_FSM_SLOT_QUEUED,       // 已入发送队列，等待物理层发出
+    LORA_FSM_SLOT_WAIT_ACK,     // 已发出，等待 ACK (重传计时中)
+    LORA_FSM_SLOT_BROADCAST,    // 广播盲发间隔计时中
+    LORA_FSM_SLOT_RETX,         // [新增] 等待重发 (缓存帧待物理层空闲时直接发出)
+    LORA_FSM_SLOT_DONE_OK,      // 已完成 (成功)，等待 Run 输出事件
+    LORA_FSM_SLOT_DONE_FAIL     // 已完成 (失败)，等待 Run 输出事件
+} LoRa_FSM_SlotState_t;
 
 /**
  * @brief FSM 输出事件类型
@@ -60,18 +63,44 @@ void LoRa_Manager_FSM_Init(const LoRa_Config_t *cfg);
 
 /**
  * @brief  运行状态机 (周期调用)
- * @param  scratch_buf: 共享工作区 (用于 TX 预览)
- * @param  scratch_len: 工作区大小
  * @return FSM 输出事件 (上层需根据此返回值触发回调)
+ * @note   [变更] 发送直接写入 Port 借出的 DMA 缓冲，不再需要共享工作区
  */
-LoRa_FSM_Output_t LoRa_Manager_FSM_Run(uint8_t *scratch_buf, uint16_t scratch_len);
+LoRa_FSM_Output_t LoRa_Manager_FSM_Run(void);
 
 /**
  * @brief  处理接收到的数据包
  * @param  packet: 接收到的包
- * @return true=有效新包(需回调), false=重复包或ACK包(不回调)
+ * @return true=有效新包(需立即回调), false=重复包、ACK包或乱序缓存(不回调)
+ * @note   乱序缓存的帧在缺口补齐后变为就绪，需通过 LoRa_Manager_FSM_PopRxPacket 取出。
+ *         [变更] V2 短序号在此原地扩展为 16 位。
  */
-bool LoRa_Manager_FSM_ProcessRxPacket(const LoRa_Packet_t *packet);
+bool LoRa_Manager_FSM_ProcessRxPacket(LoRa_Packet_t *packet);
+
+/**
+ * @brief  [新增] 取出一个按序就绪的缓存帧
+ * @param  packet: 输出
+ * @return true=取到, false=无就绪帧
+ */
+bool LoRa_Manager_FSM_PopRxPacket(LoRa_Packet_t *packet);
+
+/**
+ * @brief  [新增] 乱序缓存中是否有该源的分片帧 (已确认、等待按序交付)
+ * @note   此时该源的重组缓冲区预留必须保留，否则交付时可能已被其他源占用，已确认的分片被丢弃。
+ */
+bool LoRa_Manager_FSM_RxHoldsFragment(uint16_t src_id);
+
+/**
+ * @brief  [新增] 查询发送窗口能否接纳一个新帧
+ * @param  target_id: 目标ID
+ * @param  opt: 发送选项
+ */
+bool LoRa_Manager_FSM_CanSend(uint16_t target_id, LoRa_SendOpt_t opt);
+
+/**
+ * @brief  [新增] 统计发往某目标、尚未结束的帧数 (排队中、等待 ACK 或广播间隔中)
+ */
+uint8_t LoRa_Manager_FSM_GetInflight(uint16_t target_id);
 
 /**
  * @brief  请求发送数据
@@ -80,16 +109,17 @@ bool LoRa_Manager_FSM_ProcessRxPacket(const LoRa_Packet_t *packet);
  * @param  target_id: 目标ID
  * @param  opt: 发送选项
  * @param  msg_id: 消息 ID
- * @param  scratch_buf: 栈缓冲区
+ * @param  frame_flags: [新增] 附加控制位 (LORA_CTRL_MASK_FRAG 等，0=普通帧)
+ * @param  scratch_buf: 栈缓冲区 ([变更] 仅在捎带确认时用于封装首发帧)
  * @param  scratch_len: 缓冲区大小
- * @return true=成功入队
+ * @return true=成功入队, false=窗口已满或发送队列满
  */
 bool LoRa_Manager_FSM_Send(const uint8_t *payload, uint16_t len, uint16_t target_id, LoRa_SendOpt_t opt,
-                           LoRa_MsgID_t msg_id,
+                           LoRa_MsgID_t msg_id, uint8_t frame_flags,
                            uint8_t *scratch_buf, uint16_t scratch_len);
 
 /**
- * @brief  查询是否忙碌
+ * @brief  查询是否忙碌 (有在途帧、待发 ACK 或待输出事件)
  */
 bool LoRa_Manager_FSM_IsBusy(void);
 
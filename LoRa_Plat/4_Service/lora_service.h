@@ -29,6 +29,7 @@
  */
 #define LORA_OPT_CONFIRMED      (LoRa_SendOpt_t){ .NeedAck = true }  /*!< 需要 ACK 确认 (可靠传输) */
 #define LORA_OPT_UNCONFIRMED    (LoRa_SendOpt_t){ .NeedAck = false } /*!< 不需要 ACK (发后即忘) */
+#define LORA_OPT_CONFIRMED_FEC  (LoRa_SendOpt_t){ .NeedAck = true, .UseFec = true } /*!< [新增] 可靠传输 + 前向纠错 */
 
 /**
  * @brief 接收数据元信息
@@ -171,6 +172,14 @@ bool LoRa_Service_IsBusy(void);
  */
 void LoRa_Service_RegisterCipher(const LoRa_Cipher_t *cipher);
 
+/**
+ * @brief  [新增] 指定某条链路是否使用前向纠错 (透传给 Manager 层)
+ * @param  peer_id: 对端 ID
+ * @param  enable: true=发往该对端的帧都以 FEC 帧发送 (对端回复时会自动对称使用)
+ * @note   软重启后需重新设置。
+ */
+void LoRa_Service_SetLinkFec(uint16_t peer_id, bool enable);
+
 
 /**
  * @brief  [主循环调用] 检查系统是否可以进入休眠